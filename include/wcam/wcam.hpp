@@ -1,14 +1,22 @@
 #pragma once
+#include <filesystem>
 #include <optional>
 #include <vector>
 #include "../../src/DeviceId.hpp"
+#include "../../src/DroppedFrames.hpp"
 #include "../../src/FirstRowIs.hpp"
 #include "../../src/Image.hpp"
 #include "../../src/Info.hpp"
 #include "../../src/MaybeImage.hpp"
+#include "../../src/MjpegDecoding.hpp"
+#include "../../src/Orientation.hpp"
+#include "../../src/RegionOfInterest.hpp"
+#include "../../src/ResizeFilter.hpp"
 #include "../../src/Resolution.hpp"
 #include "../../src/ResolutionsMap.hpp"
 #include "../../src/SharedWebcam.hpp"
+#include "../../src/TensorFormat.hpp"
+#include "../../src/YUVEncoding.hpp"
 #include "../../src/internal/ImageFactory.hpp"
 #include "../../src/overloaded.hpp"
 
@@ -26,15 +34,26 @@ void set_selected_resolution(DeviceId const&, Resolution);
 /// Might return nullopt if the webcam is not plugged in
 auto get_name(DeviceId const&) -> std::optional<std::string>;
 
+/// If `recycle_images` is true, the Images that you don't use anymore (once you have released all the shared_ptr to them) are not destroyed, but reused for the next images of the same webcam.
+/// This is worth it if your Image type is expensive to create (e.g. it owns big buffers or GPU handles). Override Image::reset() to release the data it holds and clear its state while it waits to be reused.
 template<typename ImageT>
-void set_image_type()
+void set_image_type(bool recycle_images = false)
 {
     assert(!internal::image_factory_pointer() && "You already called set_image_type. You must only call it once."); // NB: actually this isn't a problem to call it several times, but is it really what you want? If yes, then you can comment out this assert and everything will work O:)
-    internal::image_factory_pointer() = std::make_unique<internal::ImageFactory<ImageT>>();
+    internal::image_factory_pointer() = std::make_unique<internal::ImageFactory<ImageT>>(recycle_images);
 }
 
 auto get_resolutions_map() -> ResolutionsMap&;
 
+/// Stores the capabilities of the webcams (name and resolutions) in that file, so that the next runs of your application don't have to query them again (which can be slow with some cameras).
+/// Optional. If you use it, call it at the beginning of your application, before you use anything else from the library. Only used on Linux for now.
+void set_capabilities_cache_file(std::filesystem::path const&);
+
+/// Number of threads used to convert the big images (e.g. 4K) between pixel formats, including the capture thread. Defaults to the number of cores of the CPU. 1 disables the multi-threading.
+/// On Linux, they also decode the slices of the MJPEG images that have restart markers (which most webcams put in them), in parallel. With MjpegDecoding::Quality, only when their chroma isn't subsampled vertically (e.g. 4:2:2, but not 4:2:0), because its smooth upsampling needs the chroma of the neighbouring slices.
+/// Small images are always converted on the capture thread, because splitting them would cost more than it saves.
+void set_conversion_threads_count(size_t threads_count);
+
 /// Must be called once every frame
 void update();
 
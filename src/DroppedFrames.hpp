@@ -0,0 +1,18 @@
+#pragma once
+#include <cstdint>
+
+namespace wcam {
+
+/// How many of the images captured by a webcam never reached your Images, and where they were lost (see SharedWebcam::dropped_frames()).
+/// They are counted since the webcam started capturing at its current resolution. Only counted on Linux for now.
+struct DroppedFrames {
+    /// The driver had no free buffer to write them into, because the previous images were not given back to it in time.
+    /// Only known for the drivers that number the images they capture.
+    uint64_t by_driver{0};
+    /// A newer image arrived while they were still waiting to be decoded / converted, because that is slower than the webcam. We always keep the latest images.
+    uint64_t before_decoding{0};
+
+    friend auto operator==(DroppedFrames const&, DroppedFrames const&) -> bool = default;
+};
+
+} // namespace wcam
\ No newline at end of file
@@ -1,127 +1,132 @@
 #include "Image.hpp"
-#include <cstddef>
 #include <memory>
+#include "internal/BufferPool.hpp"
+#include "internal/conversions.hpp"
 
 namespace wcam {
 
-static auto clamp(int x) -> int
+template<typename PixelFormatT>
+static auto to_RGB24(ImageDataView<PixelFormatT> const& data) -> ImageDataView<RGB24>
 {
-    return x < 0 ? 0 : (x > 255 ? 255 : x);
+    auto rgb_data = internal::buffer_pool().get(RGB24::data_length(data.resolution()));
+    internal::convert(data, RGB24{}, internal::Destination{rgb_data.get(), RGB24::bytes_per_pixel, data.resolution(), data.row_order()});
+    return ImageDataView<RGB24>{std::move(rgb_data), RGB24::data_length(data.resolution()), data.resolution(), data.row_order()};
 }
 
-static auto BGR24_to_RGB24(uint8_t const* bgr_data, Resolution resolution) -> std::shared_ptr<uint8_t const>
+void Image::set_data(ImageDataView<BGR24> const& bgrData)
 {
-    auto       rgb_data = std::shared_ptr<uint8_t>{new uint8_t[resolution.pixels_count() * 3], std::default_delete<uint8_t[]>()}; // NOLINT(*c-arrays)
-    auto const width    = resolution.width();
-    auto const height   = resolution.height();
-
-    for (Resolution::DataType y = 0; y < height; y++)
+    if (uint8_t* const data = bgrData.writable_data())
     {
-        for (Resolution::DataType x = 0; x < width; x++)
-        {
-            rgb_data.get()[(x + y * width) * 3 + 0] = bgr_data[(x + y * width) * 3 + 2]; // NOLINT(*pointer-arithmetic)
-            rgb_data.get()[(x + y * width) * 3 + 1] = bgr_data[(x + y * width) * 3 + 1]; // NOLINT(*pointer-arithmetic)
-            rgb_data.get()[(x + y * width) * 3 + 2] = bgr_data[(x + y * width) * 3 + 0]; // NOLINT(*pointer-arithmetic)
-        }
+        // Swap the channels in place, to avoid allocating and copying a whole frame
+        auto const& plane = bgrData.planes()[0];
+        internal::convert(bgrData, RGB24{}, internal::Destination{data + plane.offset, RGB24::bytes_per_pixel, bgrData.resolution(), bgrData.row_order(), {}, plane.stride}); // NOLINT(*pointer-arithmetic)
+        set_data(ImageDataView<RGB24>{
+            WritableBuffer{data},
+            BGR24::data_length(bgrData.resolution(), bgrData.planes()),
+            bgrData.resolution(),
+            bgrData.row_order(),
+            bgrData.planes(),
+        });
+        return;
     }
+    set_data(to_RGB24(bgrData));
+}
 
-    return rgb_data;
+void Image::set_data(ImageDataView<RGBA32> const& rgba_data)
+{
+    set_data(to_RGB24(rgba_data));
 }
 
-static auto NV12_to_RGB24(uint8_t const* nv12Data, Resolution resolution) -> std::shared_ptr<uint8_t const>
+void Image::set_data(ImageDataView<BGRA32> const& bgra_data)
 {
-    auto       rgb_data   = std::shared_ptr<uint8_t>{new uint8_t[resolution.pixels_count() * 3], std::default_delete<uint8_t[]>()}; // NOLINT(*c-arrays)
-    auto const frame_size = resolution.pixels_count();
-    auto const width      = resolution.width();
-    auto const height     = resolution.height();
+    set_data(to_RGB24(bgra_data));
+}
 
-    uint8_t const* const y_plane  = nv12Data;
-    uint8_t const* const uv_plane = nv12Data + frame_size; // NOLINT(*pointer-arithmetic)
+void Image::set_data(ImageDataView<NV12> const& nv12_data)
+{
+    set_data(to_RGB24(nv12_data));
+}
 
-    for (Resolution::DataType y = 0; y < height; y++)
-    {
-        for (Resolution::DataType x = 0; x < width; x++)
-        {
-            auto const y_index  = y * width + x;
-            auto const uv_index = (y / 2) * (width / 2) + (x / 2);
-
-            uint8_t const Y = y_plane[y_index];                            // NOLINT(*pointer-arithmetic)
-            uint8_t const U = uv_plane[static_cast<size_t>(uv_index * 2)]; // NOLINT(*pointer-arithmetic)
-            uint8_t const V = uv_plane[uv_index * 2 + 1];                  // NOLINT(*pointer-arithmetic)
-
-            int const C = Y - 16;
-            int const D = U - 128;
-            int const E = V - 128;
-
-            int const R = clamp((298 * C + 409 * E + 128) >> 8);
-            int const G = clamp((298 * C - 100 * D - 208 * E + 128) >> 8);
-            int const B = clamp((298 * C + 516 * D + 128) >> 8);
-
-            rgb_data.get()[(x + y * width) * 3 + 0] = static_cast<uint8_t>(R); // NOLINT(*pointer-arithmetic)
-            rgb_data.get()[(x + y * width) * 3 + 1] = static_cast<uint8_t>(G); // NOLINT(*pointer-arithmetic)
-            rgb_data.get()[(x + y * width) * 3 + 2] = static_cast<uint8_t>(B); // NOLINT(*pointer-arithmetic)
-        }
-    }
+void Image::set_data(ImageDataView<I420> const& i420_data)
+{
+    set_data(to_RGB24(i420_data));
+}
+
+void Image::set_data(ImageDataView<I422> const& i422_data)
+{
+    set_data(to_RGB24(i422_data));
+}
 
-    return rgb_data;
+void Image::set_data(ImageDataView<YUYV> const& yuyv_data)
+{
+    set_data(to_RGB24(yuyv_data));
 }
 
-static auto YUYV_to_RGB24(uint8_t const* yuyv, Resolution resolution) -> std::shared_ptr<uint8_t const>
+void Image::set_data(ImageDataView<GREY8> const& grey_data)
 {
-    auto rgb_data = std::shared_ptr<uint8_t>{new uint8_t[resolution.pixels_count() * 3], std::default_delete<uint8_t[]>()}; // NOLINT(*c-arrays)
-    for (uint64_t i = 0; i < resolution.pixels_count() * 2; i += 4)
-    {
-        auto const y0 = static_cast<int>(yuyv[i + 0] << 8);  // NOLINT(*pointer-arithmetic)
-        auto const u  = static_cast<int>(yuyv[i + 1] - 128); // NOLINT(*pointer-arithmetic)
-        auto const y1 = static_cast<int>(yuyv[i + 2] << 8);  // NOLINT(*pointer-arithmetic)
-        auto const v  = static_cast<int>(yuyv[i + 3] - 128); // NOLINT(*pointer-arithmetic)
-
-        int const r0 = (y0 + 359 * v) >> 8;
-        int const g0 = (y0 - 88 * u - 183 * v) >> 8;
-        int const b0 = (y0 + 454 * u) >> 8;
-        int const r1 = (y1 + 359 * v) >> 8;
-        int const g1 = (y1 - 88 * u - 183 * v) >> 8;
-        int const b1 = (y1 + 454 * u) >> 8;
-
-        rgb_data.get()[i * 3 / 2 + 0] = static_cast<uint8_t>(std::clamp(r0, 0, 255)); // NOLINT(*pointer-arithmetic)
-        rgb_data.get()[i * 3 / 2 + 1] = static_cast<uint8_t>(std::clamp(g0, 0, 255)); // NOLINT(*pointer-arithmetic)
-        rgb_data.get()[i * 3 / 2 + 2] = static_cast<uint8_t>(std::clamp(b0, 0, 255)); // NOLINT(*pointer-arithmetic)
-        rgb_data.get()[i * 3 / 2 + 3] = static_cast<uint8_t>(std::clamp(r1, 0, 255)); // NOLINT(*pointer-arithmetic)
-        rgb_data.get()[i * 3 / 2 + 4] = static_cast<uint8_t>(std::clamp(g1, 0, 255)); // NOLINT(*pointer-arithmetic)
-        rgb_data.get()[i * 3 / 2 + 5] = static_cast<uint8_t>(std::clamp(b1, 0, 255)); // NOLINT(*pointer-arithmetic)
-    }
+    set_data(to_RGB24(grey_data));
+}
 
-    return rgb_data;
+void Image::set_data(ImageDataView<PlanarRGBF32> const&)
+{
 }
 
-void Image::set_data(ImageDataView<BGR24> const& bgrData)
+void Image::set_data(ImageDataView<PlanarRGBF16> const&)
 {
-    set_data(ImageDataView<RGB24>{
-        BGR24_to_RGB24(bgrData.data(), bgrData.resolution()),
-        RGB24::data_length(bgrData.resolution()),
-        bgrData.resolution(),
-        bgrData.row_order()
-    });
 }
 
-void Image::set_data(ImageDataView<NV12> const& nv12_data)
+void Image::reset()
 {
-    set_data(ImageDataView<RGB24>{
-        NV12_to_RGB24(nv12_data.data(), nv12_data.resolution()),
-        RGB24::data_length(nv12_data.resolution()),
-        nv12_data.resolution(),
-        nv12_data.row_order()
-    });
 }
 
-void Image::set_data(ImageDataView<YUYV> const& yuyv_data)
+auto Image::destination_buffer(RGB24, Resolution) -> std::optional<DestinationBuffer<RGB24>>
+{
+    return std::nullopt;
+}
+
+auto Image::destination_buffer(BGR24, Resolution) -> std::optional<DestinationBuffer<BGR24>>
+{
+    return std::nullopt;
+}
+
+auto Image::destination_buffer(RGBA32, Resolution) -> std::optional<DestinationBuffer<RGBA32>>
+{
+    return std::nullopt;
+}
+
+auto Image::destination_buffer(BGRA32, Resolution) -> std::optional<DestinationBuffer<BGRA32>>
+{
+    return std::nullopt;
+}
+
+auto Image::destination_buffer(NV12, Resolution) -> std::optional<DestinationBuffer<NV12>>
+{
+    return std::nullopt;
+}
+
+auto Image::destination_buffer(I420, Resolution) -> std::optional<DestinationBuffer<I420>>
+{
+    return std::nullopt;
+}
+
+auto Image::destination_buffer(I422, Resolution) -> std::optional<DestinationBuffer<I422>>
+{
+    return std::nullopt;
+}
+
+auto Image::destination_buffer(GREY8, Resolution) -> std::optional<DestinationBuffer<GREY8>>
+{
+    return std::nullopt;
+}
+
+auto Image::destination_buffer(PlanarRGBF32, Resolution) -> std::optional<DestinationBuffer<PlanarRGBF32>>
+{
+    return std::nullopt;
+}
+
+auto Image::destination_buffer(PlanarRGBF16, Resolution) -> std::optional<DestinationBuffer<PlanarRGBF16>>
 {
-    set_data(ImageDataView<RGB24>{
-        YUYV_to_RGB24(yuyv_data.data(), yuyv_data.resolution()),
-        RGB24::data_length(yuyv_data.resolution()),
-        yuyv_data.resolution(),
-        yuyv_data.row_order()
-    });
+    return std::nullopt;
 }
 
 } // namespace wcam
\ No newline at end of file
@@ -1,70 +1,243 @@
 #pragma once
+#include <algorithm>
+#include <array>
 #include <cassert>
 #include <cstdint>
+#include <cstring>
 #include <memory>
+#include <optional>
 #include <utility>
 #include <variant>
 #include "FirstRowIs.hpp"
 #include "Resolution.hpp"
+#include "YUVEncoding.hpp"
 #include "overloaded.hpp"
 
 namespace wcam {
 
-struct RGB24 {
+/// Where a plane of an image starts in its data, and the number of bytes between the starts of two consecutive rows of that plane.
+/// The stride can be bigger than the size of a row when the rows are padded (e.g. some drivers align them on 4 or 64 bytes).
+struct Plane {
+    size_t offset{};
+    size_t stride{};
+
+    friend auto operator==(Plane const&, Plane const&) -> bool = default;
+};
+
+/// A format whose pixels are all stored in a single plane, one after the other
+template<size_t BytesPerPixel>
+struct PackedPixelFormat {
+    static constexpr size_t bytes_per_pixel = BytesPerPixel;
+    using Planes                            = std::array<Plane, 1>;
+
+    /// The planes of an image whose rows are not padded
+    static auto packed_planes(Resolution resolution) -> Planes
+    {
+        return {Plane{0, resolution.width() * bytes_per_pixel}};
+    }
+
+    /// The minimum length of the data of an image with those planes
+    static auto data_length(Resolution resolution, Planes const& planes) -> size_t
+    {
+        return planes[0].offset + planes[0].stride * resolution.height();
+    }
+
     static auto data_length(Resolution resolution) -> size_t
     {
-        return resolution.pixels_count() * 3;
+        return data_length(resolution, packed_planes(resolution));
     }
 };
 
-struct BGR24 {
+struct RGB24 : PackedPixelFormat<3> {};
+struct BGR24 : PackedPixelFormat<3> {};
+struct RGBA32 : PackedPixelFormat<4> {}; // The alpha is always 255. The rows are always aligned on 4 bytes, which is what most texture uploads and SIMD filters expect.
+struct BGRA32 : PackedPixelFormat<4> {};
+struct YUYV : PackedPixelFormat<2> {}; // 4 bytes for 2 pixels
+struct GREY8 : PackedPixelFormat<1> {}; // Only the luminance
+
+/// A plane of Y, and then a plane of interleaved (u, v) pairs, one for each 2x2 block of pixels
+struct NV12 {
+    using Planes = std::array<Plane, 2>;
+
+    static auto packed_planes(Resolution resolution) -> Planes
+    {
+        return {
+            Plane{0, resolution.width()},
+            Plane{resolution.pixels_count(), (resolution.width() + size_t{1}) / 2 * 2}, // When the width is odd, the last pair only covers one column
+        };
+    }
+
+    static auto data_length(Resolution resolution, Planes const& planes) -> size_t
+    {
+        return std::max(
+            planes[0].offset + planes[0].stride * resolution.height(),
+            planes[1].offset + planes[1].stride * ((resolution.height() + 1) / 2)
+        );
+    }
+
     static auto data_length(Resolution resolution) -> size_t
     {
-        return resolution.pixels_count() * 3;
+        return data_length(resolution, packed_planes(resolution));
     }
 };
 
-struct NV12 {
+/// A plane of Y, then a plane of U and a plane of V, with one sample for each 2x2 block of pixels. It is what most video encoders expect.
+struct I420 {
+    using Planes = std::array<Plane, 3>;
+
+    static auto packed_planes(Resolution resolution) -> Planes
+    {
+        auto const chroma_width  = (resolution.width() + size_t{1}) / 2;
+        auto const chroma_height = (resolution.height() + size_t{1}) / 2;
+        return {
+            Plane{0, resolution.width()},
+            Plane{resolution.pixels_count(), chroma_width},
+            Plane{resolution.pixels_count() + chroma_width * chroma_height, chroma_width},
+        };
+    }
+
+    static auto data_length(Resolution resolution, Planes const& planes) -> size_t
+    {
+        auto const chroma_height = (resolution.height() + size_t{1}) / 2;
+        return std::max({
+            planes[0].offset + planes[0].stride * resolution.height(),
+            planes[1].offset + planes[1].stride * chroma_height,
+            planes[2].offset + planes[2].stride * chroma_height,
+        });
+    }
+
+    static auto data_length(Resolution resolution) -> size_t
+    {
+        return data_length(resolution, packed_planes(resolution));
+    }
+};
+
+/// A plane of Y, then a plane of U and a plane of V, with one sample for each pair of horizontally adjacent pixels. It is how most MJPEG webcams store their chroma.
+struct I422 {
+    using Planes = std::array<Plane, 3>;
+
+    static auto packed_planes(Resolution resolution) -> Planes
+    {
+        auto const chroma_width = (resolution.width() + size_t{1}) / 2;
+        return {
+            Plane{0, resolution.width()},
+            Plane{resolution.pixels_count(), chroma_width},
+            Plane{resolution.pixels_count() + chroma_width * resolution.height(), chroma_width},
+        };
+    }
+
+    static auto data_length(Resolution resolution, Planes const& planes) -> size_t
+    {
+        return std::max({
+            planes[0].offset + planes[0].stride * resolution.height(),
+            planes[1].offset + planes[1].stride * resolution.height(),
+            planes[2].offset + planes[2].stride * resolution.height(),
+        });
+    }
+
     static auto data_length(Resolution resolution) -> size_t
     {
-        return resolution.pixels_count() * 3 / 2;
+        return data_length(resolution, packed_planes(resolution));
     }
 };
 
-struct YUYV {
+/// Three planes (R, then G, then B) of `height` rows of `width` floats: the CHW layout that inference runtimes expect.
+/// See TensorFormat for how the values are computed.
+template<size_t BytesPerValue>
+struct PlanarRGBFormat {
+    static constexpr size_t bytes_per_value = BytesPerValue;
+    using Planes                            = std::array<Plane, 3>;
+
+    static auto packed_planes(Resolution resolution) -> Planes
+    {
+        auto const plane_length = resolution.pixels_count() * bytes_per_value;
+        auto const stride       = resolution.width() * bytes_per_value;
+        return {Plane{0, stride}, Plane{plane_length, stride}, Plane{2 * plane_length, stride}};
+    }
+
+    static auto data_length(Resolution resolution, Planes const& planes) -> size_t
+    {
+        size_t length = 0;
+        for (auto const& plane : planes)
+            length = std::max(length, plane.offset + plane.stride * resolution.height());
+        return length;
+    }
+
     static auto data_length(Resolution resolution) -> size_t
     {
-        return resolution.pixels_count() * 2;
+        return data_length(resolution, packed_planes(resolution));
     }
 };
 
+struct PlanarRGBF32 : PlanarRGBFormat<4> {}; // 32-bits floats
+struct PlanarRGBF16 : PlanarRGBFormat<2> {}; // IEEE 754 half-precision floats, stored as uint16_t
+
 template<typename PixelFormatT>
 class ImageData {
 public:
+    using Planes = typename PixelFormatT::Planes;
+
     ImageData(std::shared_ptr<uint8_t const> data, Resolution resolution, wcam::FirstRowIs row_order)
+        : ImageData{std::move(data), resolution, row_order, PixelFormatT::packed_planes(resolution)}
+    {}
+    ImageData(std::shared_ptr<uint8_t const> data, Resolution resolution, wcam::FirstRowIs row_order, Planes const& planes, YUVEncoding yuv_encoding = {})
         : _data{std::move(data)}
         , _resolution{resolution}
         , _row_order{row_order}
+        , _planes{planes}
+        , _yuv_encoding{yuv_encoding}
     {}
     auto data() const -> uint8_t const* { return _data.get(); }
     auto resolution() const -> Resolution { return _resolution; }
     auto row_order() const -> wcam::FirstRowIs { return _row_order; }
 
+    auto planes() const -> Planes const& { return _planes; }
+    /// Where the first row of that plane starts
+    auto plane(size_t index) const -> uint8_t const* { return data() + _planes[index].offset; } // NOLINT(*pointer-arithmetic, *constant-array-index)
+    auto stride(size_t index) const -> size_t { return _planes[index].stride; }                // NOLINT(*constant-array-index)
+    /// Returns true iff the rows are not padded, and the planes are contiguous
+    auto is_packed() const -> bool { return _planes == PixelFormatT::packed_planes(_resolution); }
+    /// Only meaningful for the YUV formats
+    auto yuv_encoding() const -> YUVEncoding { return _yuv_encoding; }
+
 private:
     std::shared_ptr<uint8_t const> _data{};
     Resolution                     _resolution{};
     wcam::FirstRowIs               _row_order{};
+    Planes                         _planes{};
+    YUVEncoding                    _yuv_encoding{};
+};
+
+/// A buffer that the Image is allowed to modify during the call to set_data() (e.g. to convert it in place, without allocating a new buffer).
+/// It must not be used after set_data() returns.
+class WritableBuffer {
+public:
+    explicit WritableBuffer(uint8_t* data)
+        : _data{data}
+    {}
+    auto data() const -> uint8_t* { return _data; }
+
+private:
+    uint8_t* _data{};
 };
 
 template<typename PixelFormatT>
 class ImageDataView {
 public:
-    ImageDataView(std::variant<uint8_t const*, std::shared_ptr<uint8_t const>> data, size_t data_length, Resolution resolution, wcam::FirstRowIs row_order)
+    using Planes = typename PixelFormatT::Planes;
+
+    ImageDataView(std::variant<uint8_t const*, WritableBuffer, std::shared_ptr<uint8_t const>> data, size_t data_length, Resolution resolution, wcam::FirstRowIs row_order)
+        : ImageDataView{std::move(data), data_length, resolution, row_order, PixelFormatT::packed_planes(resolution)}
+    {}
+    /// For data whose rows are padded, or whose planes are not contiguous, or that uses a specific YUV encoding
+    ImageDataView(std::variant<uint8_t const*, WritableBuffer, std::shared_ptr<uint8_t const>> data, size_t data_length, Resolution resolution, wcam::FirstRowIs row_order, Planes const& planes, YUVEncoding yuv_encoding = {})
         : _data{std::move(data)}
         , _resolution{resolution}
         , _row_order{row_order}
+        , _planes{planes}
+        , _yuv_encoding{yuv_encoding}
     {
-        assert(PixelFormatT::data_length(_resolution) == data_length);
+        assert(PixelFormatT::data_length(_resolution, _planes) <= data_length);
         std::ignore = data_length; // Disable warning in release
     }
 
@@ -73,12 +246,13 @@ public:
         return std::visit(
             overloaded{
                 [&](uint8_t const* data) {
-                    auto res = std::shared_ptr<uint8_t>{new uint8_t[PixelFormatT::data_length(_resolution)], std::default_delete<uint8_t[]>()}; // NOLINT(*c-arrays)
-                    memcpy(res.get(), data, PixelFormatT::data_length(_resolution));
-                    return ImageData<PixelFormatT>{std::move(res), _resolution, _row_order};
+                    return copy(data);
+                },
+                [&](WritableBuffer const& buffer) {
+                    return copy(buffer.data());
                 },
                 [&](std::shared_ptr<uint8_t const> const& data) {
-                    return ImageData<PixelFormatT>{data, _resolution, _row_order};
+                    return ImageData<PixelFormatT>{data, _resolution, _row_order, _planes, _yuv_encoding};
                 },
             },
             _data
@@ -92,6 +266,9 @@ public:
                 [](uint8_t const* data) {
                     return data;
                 },
+                [](WritableBuffer const& buffer) -> uint8_t const* {
+                    return buffer.data();
+                },
                 [](std::shared_ptr<uint8_t const> const& data) {
                     return data.get();
                 },
@@ -100,13 +277,54 @@ public:
         );
     }
 
+    /// Returns nullptr if we are not allowed to modify the data
+    auto writable_data() const -> uint8_t*
+    {
+        auto const* const buffer = std::get_if<WritableBuffer>(&_data);
+        return buffer ? buffer->data() : nullptr;
+    }
+
     auto resolution() const -> Resolution { return _resolution; }
     auto row_order() const -> wcam::FirstRowIs { return _row_order; }
 
+    auto planes() const -> Planes const& { return _planes; }
+    /// Where the first row of that plane starts
+    auto plane(size_t index) const -> uint8_t const* { return data() + _planes[index].offset; } // NOLINT(*pointer-arithmetic, *constant-array-index)
+    auto stride(size_t index) const -> size_t { return _planes[index].stride; }                // NOLINT(*constant-array-index)
+    /// Returns true iff the rows are not padded, and the planes are contiguous
+    auto is_packed() const -> bool { return _planes == PixelFormatT::packed_planes(_resolution); }
+    /// Only meaningful for the YUV formats
+    auto yuv_encoding() const -> YUVEncoding { return _yuv_encoding; }
+
+    /// A view of the same data, that only sees the part of it described by `resolution` and `planes` (e.g. a rectangle of the image, without copying it)
+    auto with_planes(Resolution resolution, Planes const& planes) const -> ImageDataView
+    {
+        return ImageDataView{_data, PixelFormatT::data_length(resolution, planes), resolution, _row_order, planes, _yuv_encoding};
+    }
+
 private:
-    std::variant<uint8_t const*, std::shared_ptr<uint8_t const>> _data{};
-    Resolution                                                   _resolution{};
-    wcam::FirstRowIs                                             _row_order{};
+    auto copy(uint8_t const* data) const -> ImageData<PixelFormatT>
+    {
+        auto const length = PixelFormatT::data_length(_resolution, _planes);
+        auto       res    = std::shared_ptr<uint8_t>{new uint8_t[length], std::default_delete<uint8_t[]>()}; // NOLINT(*c-arrays)
+        memcpy(res.get(), data, length);
+        return ImageData<PixelFormatT>{std::move(res), _resolution, _row_order, _planes, _yuv_encoding};
+    }
+
+private:
+    std::variant<uint8_t const*, WritableBuffer, std::shared_ptr<uint8_t const>> _data{};
+    Resolution                                                                   _resolution{};
+    wcam::FirstRowIs                                                             _row_order{};
+    Planes                                                                       _planes{};
+    YUVEncoding                                                                  _yuv_encoding{};
+};
+
+/// A buffer of your Image, where wcam can write an image directly (see Image::destination_buffer())
+template<typename PixelFormatT>
+struct DestinationBuffer {
+    uint8_t* data{};
+    /// Where each plane starts in `data`, and the stride of its rows (e.g. to pad them as your GPU wants)
+    typename PixelFormatT::Planes planes{};
 };
 
 class Image {
@@ -120,8 +338,42 @@ public:
 
     virtual void set_data(ImageDataView<RGB24> const&) = 0;
     virtual void set_data(ImageDataView<BGR24> const&);
+    virtual void set_data(ImageDataView<RGBA32> const&);
+    virtual void set_data(ImageDataView<BGRA32> const&);
+    /// Implement them if you feed the images to a video encoder: YUYV and MJPEG are converted to them without going through RGB, and they keep the YUVEncoding of the webcam.
     virtual void set_data(ImageDataView<NV12> const&);
+    virtual void set_data(ImageDataView<I420> const&);
+    /// Only received from MJPEG webcams (on Linux), whose chroma is decoded as it is stored (without upsampling nor converting it), when the images are not resized, cropped nor rotated by 90°. Otherwise, your Image receives one of the other formats it implements.
+    /// If it also implements NV12 or I420, it receives I422 only for the JPEGs that have a chroma sample for each pair of pixels of each row (e.g. 4:2:2, which most webcams use), because I420 would lose half of it.
+    virtual void set_data(ImageDataView<I422> const&);
     virtual void set_data(ImageDataView<YUYV> const&);
+    /// Only implement it if you don't need the colors: it is the cheapest format to get from YUYV, NV12 and MJPEG (we just take their Y samples), so your Image will receive it instead of the other formats it implements.
+    virtual void set_data(ImageDataView<GREY8> const&);
+
+    /// If your Image overrides one of those, it will only receive tensors, computed according to the TensorFormat of the webcam (see SharedWebcam::set_tensor_format()).
+    /// If it overrides both, it receives PlanarRGBF32. The default implementations do nothing, because they are never called.
+    virtual void set_data(ImageDataView<PlanarRGBF32> const&);
+    virtual void set_data(ImageDataView<PlanarRGBF16> const&);
+
+    /// Override the ones of the formats you implement if you want the images to be written directly to your own storage (e.g. a mapped texture, or a buffer that you reuse),
+    /// instead of a buffer that wcam allocates and that you then copy in set_data(). `resolution` is the one of the image that is about to be written.
+    /// The buffer must be at least PixelFormatT::data_length(resolution, planes) bytes long. set_data() is then called with a view of it, whose data() is the `data` you returned.
+    /// The default implementations return std::nullopt, which means that wcam allocates the buffer.
+    virtual auto destination_buffer(RGB24, Resolution) -> std::optional<DestinationBuffer<RGB24>>;
+    virtual auto destination_buffer(BGR24, Resolution) -> std::optional<DestinationBuffer<BGR24>>;
+    virtual auto destination_buffer(RGBA32, Resolution) -> std::optional<DestinationBuffer<RGBA32>>;
+    virtual auto destination_buffer(BGRA32, Resolution) -> std::optional<DestinationBuffer<BGRA32>>;
+    virtual auto destination_buffer(NV12, Resolution) -> std::optional<DestinationBuffer<NV12>>;
+    virtual auto destination_buffer(I420, Resolution) -> std::optional<DestinationBuffer<I420>>;
+    virtual auto destination_buffer(I422, Resolution) -> std::optional<DestinationBuffer<I422>>;
+    virtual auto destination_buffer(GREY8, Resolution) -> std::optional<DestinationBuffer<GREY8>>;
+    virtual auto destination_buffer(PlanarRGBF32, Resolution) -> std::optional<DestinationBuffer<PlanarRGBF32>>;
+    virtual auto destination_buffer(PlanarRGBF16, Resolution) -> std::optional<DestinationBuffer<PlanarRGBF16>>;
+
+    /// Only called if you asked for the Images to be recycled (see set_image_type()), when an Image is released (i.e. its last shared_ptr is destroyed), before it waits to be reused.
+    /// Override it to clear the state that the previous image has left, and above all to release the data it holds (e.g. the ImageDataView it received): it might be a buffer of the driver, that it can't capture into while your Image keeps it.
+    /// It is called on the thread that releases the Image, which is not the one that calls set_data().
+    virtual void reset();
 };
 
 } // namespace wcam
\ No newline at end of file
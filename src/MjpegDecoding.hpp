@@ -0,0 +1,14 @@
+#pragma once
+
+namespace wcam {
+
+/// How the images of the webcams that send MJPEG are decoded (see SharedWebcam::set_mjpeg_decoding())
+enum class MjpegDecoding {
+    /// Uses the accurate integer DCT, and interpolates the chroma smoothly when upsampling it. This is what most decoders do.
+    Quality,
+    /// Uses the fast integer DCT, and duplicates the chroma samples instead of interpolating them. It is noticeably cheaper, especially for large images, but the edges of colored objects are a bit blockier.
+    /// On Linux, it also lets the big 4:2:0 images be decoded in parallel slices (see set_conversion_threads_count()).
+    Speed,
+};
+
+} // namespace wcam
\ No newline at end of file
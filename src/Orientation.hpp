@@ -0,0 +1,25 @@
+#pragma once
+
+namespace wcam {
+
+enum class Rotation {
+    None,
+    Clockwise90,
+    Clockwise180,
+    Clockwise270,
+};
+
+/// How the images of a webcam should be transformed before they are given to you.
+/// The transformation is applied while converting the images, so it doesn't cost an additional pass over the pixels.
+struct Orientation {
+    /// Makes sure the images are always given with FirstRowIs::Top (some webcams give them with FirstRowIs::Bottom, especially on Windows)
+    bool normalize_row_order{false};
+    /// Flips the images horizontally, e.g. for a selfie view
+    bool mirror{false};
+    /// Rotates the images clockwise, e.g. for a camera that is mounted in portrait mode. Anything other than None implies normalize_row_order.
+    Rotation rotation{Rotation::None};
+
+    friend auto operator==(Orientation const&, Orientation const&) -> bool = default;
+};
+
+} // namespace wcam
\ No newline at end of file
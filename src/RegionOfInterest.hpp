@@ -0,0 +1,17 @@
+#pragma once
+#include <cstdint>
+#include "Resolution.hpp"
+
+namespace wcam {
+
+/// A rectangle of the captured images (see SharedWebcam::set_region_of_interest()).
+/// It is expressed in pixels of the images as the webcam captures them, before the Orientation is applied: (x, y) is its top-left corner, with y going down from the top row.
+struct RegionOfInterest {
+    uint32_t   x{0};
+    uint32_t   y{0};
+    Resolution size{};
+
+    friend auto operator==(RegionOfInterest const&, RegionOfInterest const&) -> bool = default;
+};
+
+} // namespace wcam
\ No newline at end of file
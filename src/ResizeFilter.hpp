@@ -0,0 +1,13 @@
+#pragma once
+
+namespace wcam {
+
+/// How the images are resized when you ask for an output resolution (see SharedWebcam::set_output_resolution())
+enum class ResizeFilter {
+    /// Averages all the pixels of the source that each pixel covers. This is the best choice for downscaling (e.g. for a preview), because it doesn't alias. When upscaling it picks the nearest pixel.
+    Box,
+    /// Interpolates between the 4 nearest pixels of the source. It is smooth when upscaling, but aliases when downscaling by more than 2.
+    Bilinear,
+};
+
+} // namespace wcam
\ No newline at end of file
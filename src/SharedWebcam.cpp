@@ -13,4 +13,74 @@ auto SharedWebcam::id() const -> DeviceId
     return _request->id();
 }
 
+auto SharedWebcam::dropped_frames() const -> DroppedFrames
+{
+    return _request->dropped_frames();
+}
+
+void SharedWebcam::set_orientation(Orientation orientation)
+{
+    _request->settings()->set_orientation(orientation);
+}
+
+auto SharedWebcam::orientation() const -> Orientation
+{
+    return _request->settings()->orientation();
+}
+
+void SharedWebcam::set_tensor_format(TensorFormat const& tensor_format)
+{
+    _request->settings()->set_tensor_format(tensor_format);
+}
+
+auto SharedWebcam::tensor_format() const -> TensorFormat
+{
+    return _request->settings()->tensor_format();
+}
+
+void SharedWebcam::set_output_resolution(std::optional<Resolution> resolution, ResizeFilter filter)
+{
+    _request->settings()->set_output_resolution(resolution, filter);
+}
+
+auto SharedWebcam::output_resolution() const -> std::optional<Resolution>
+{
+    return _request->settings()->output_resolution();
+}
+
+auto SharedWebcam::resize_filter() const -> ResizeFilter
+{
+    return _request->settings()->resize_filter();
+}
+
+void SharedWebcam::set_max_resolution(std::optional<Resolution> resolution)
+{
+    _request->settings()->set_max_resolution(resolution);
+}
+
+auto SharedWebcam::max_resolution() const -> std::optional<Resolution>
+{
+    return _request->settings()->max_resolution();
+}
+
+void SharedWebcam::set_region_of_interest(std::optional<RegionOfInterest> region)
+{
+    _request->settings()->set_region_of_interest(region);
+}
+
+auto SharedWebcam::region_of_interest() const -> std::optional<RegionOfInterest>
+{
+    return _request->settings()->region_of_interest();
+}
+
+void SharedWebcam::set_mjpeg_decoding(MjpegDecoding decoding)
+{
+    _request->settings()->set_mjpeg_decoding(decoding);
+}
+
+auto SharedWebcam::mjpeg_decoding() const -> MjpegDecoding
+{
+    return _request->settings()->mjpeg_decoding();
+}
+
 } // namespace wcam
\ No newline at end of file
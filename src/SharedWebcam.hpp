@@ -1,6 +1,14 @@
 #pragma once
+#include <optional>
 #include "DeviceId.hpp"
+#include "DroppedFrames.hpp"
 #include "MaybeImage.hpp"
+#include "MjpegDecoding.hpp"
+#include "Orientation.hpp"
+#include "RegionOfInterest.hpp"
+#include "ResizeFilter.hpp"
+#include "Resolution.hpp"
+#include "TensorFormat.hpp"
 
 namespace wcam {
 
@@ -15,6 +23,42 @@ public:
     /// Returns a new image that has just been captured, or an info telling you what to do (see the definition of MaybeImage for more details)
     [[nodiscard]] auto image() const -> MaybeImage;
     [[nodiscard]] auto id() const -> DeviceId;
+    /// How many captured images never reached your Images, e.g. because converting them is slower than the webcam (see DroppedFrames)
+    [[nodiscard]] auto dropped_frames() const -> DroppedFrames;
+
+    /// Applies to all the SharedWebcams of the same device, and to the images captured from now on
+    void               set_orientation(Orientation);
+    [[nodiscard]] auto orientation() const -> Orientation;
+
+    /// Only used if your Image implements the tensor formats (PlanarRGBF32 or PlanarRGBF16). Applies to all the SharedWebcams of the same device, and to the images captured from now on
+    void               set_tensor_format(TensorFormat const&);
+    [[nodiscard]] auto tensor_format() const -> TensorFormat;
+
+    /// The size of the images that your Image receives (after the Orientation has been applied), independently of the resolution at which the webcam captures (see set_selected_resolution()).
+    /// The resize is done in the same pass as the color conversion, so that only the pixels of the output are computed: it is a lot cheaper than converting the full images and resizing them yourself.
+    /// nullopt gives the images at the capture resolution. Applies to all the SharedWebcams of the same device, and to the images captured from now on
+    void               set_output_resolution(std::optional<Resolution>, ResizeFilter = ResizeFilter::Box);
+    [[nodiscard]] auto output_resolution() const -> std::optional<Resolution>;
+    [[nodiscard]] auto resize_filter() const -> ResizeFilter;
+
+    /// The images are scaled down by n/8, with the largest n (from 1 to 8) that makes them fit in that size (after the Orientation has been applied), e.g. for thumbnails.
+    /// MJPEG images are decoded at that scale directly (on Linux), which is 4 to 16 times cheaper than decoding them fully. The other formats are resized like with set_output_resolution().
+    /// Only used when no output resolution is set (which also uses that trick: the JPEGs are decoded at the smallest of those scales that is still bigger than the output resolution, and then resized).
+    /// nullopt doesn't limit the size of the images. Applies to all the SharedWebcams of the same device, and to the images captured from now on
+    void               set_max_resolution(std::optional<Resolution>);
+    [[nodiscard]] auto max_resolution() const -> std::optional<Resolution>;
+
+    /// Only that rectangle of the captured images is converted and given to your Image, which then receives it as if it was the full image (it is oriented and resized the same way).
+    /// When the Image implements the format of the webcam (e.g. YUYV or NV12), it receives a view of the captured data, without any copy. With MJPEG, the rows and columns outside of the rectangle are not even decoded (or as few of them as the JPEG allows).
+    /// The rectangle is clamped to the captured images, and moved by one pixel when the format needs it to start on an even pixel (e.g. YUYV, whose pairs of pixels share their chroma).
+    /// nullopt gives the full images. Applies to all the SharedWebcams of the same device, and to the images captured from now on
+    void               set_region_of_interest(std::optional<RegionOfInterest>);
+    [[nodiscard]] auto region_of_interest() const -> std::optional<RegionOfInterest>;
+
+    /// Only used by the webcams that send MJPEG, on Linux (on the other platforms, the OS decodes the images for us).
+    /// MjpegDecoding::Speed makes the decoding, which is the main cost of each image, noticeably cheaper, at the cost of slightly blockier colors. Applies to all the SharedWebcams of the same device, and to the images captured from now on
+    void               set_mjpeg_decoding(MjpegDecoding);
+    [[nodiscard]] auto mjpeg_decoding() const -> MjpegDecoding;
 
 private:
     friend class internal::Manager;
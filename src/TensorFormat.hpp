@@ -0,0 +1,21 @@
+#pragma once
+#include <array>
+#include <optional>
+#include "Resolution.hpp"
+
+namespace wcam {
+
+/// How the images are turned into tensors, for the Images that implement set_data(ImageDataView<PlanarRGBF32>) or set_data(ImageDataView<PlanarRGBF16>).
+/// The resize, the conversion to floats and the normalization are all done in the same pass as the color conversion.
+struct TensorFormat {
+    /// The size of the tensors. If not set, it is the size of the images (after their Orientation has been applied).
+    /// The images are resized with a bilinear filter.
+    std::optional<Resolution> resolution{};
+    /// Each channel c (in R, G, B order) is computed as (value / 255 - mean[c]) / standard_deviation[c], where value is in [0, 255].
+    std::array<float, 3> mean{0.f, 0.f, 0.f};
+    std::array<float, 3> standard_deviation{1.f, 1.f, 1.f};
+
+    friend auto operator==(TensorFormat const&, TensorFormat const&) -> bool = default;
+};
+
+} // namespace wcam
\ No newline at end of file
@@ -0,0 +1,24 @@
+#pragma once
+
+namespace wcam {
+
+/// The matrix that was used to compute Y, U and V from R, G and B
+enum class YUVMatrix {
+    BT601, // Standard definition, and most webcams
+    BT709, // High definition
+};
+
+enum class YUVRange {
+    Limited, // Y is in [16, 235], and U and V in [16, 240]
+    Full,    // Y, U and V use all of [0, 255]
+};
+
+/// How the values of a YUV image (YUYV, NV12) must be interpreted to get the right colors
+struct YUVEncoding {
+    YUVMatrix matrix{YUVMatrix::BT601};
+    YUVRange  range{YUVRange::Limited};
+
+    friend auto operator==(YUVEncoding const&, YUVEncoding const&) -> bool = default;
+};
+
+} // namespace wcam
\ No newline at end of file
@@ -0,0 +1,109 @@
+#include "BufferPool.hpp"
+#include <new>
+#if defined(__linux__)
+#include <sys/mman.h>
+#endif
+
+namespace wcam::internal {
+
+/// Enough for the widest SIMD loads, and for a cache line
+static constexpr size_t alignment = 64;
+/// The buffers that are at least that big are aligned on it, and rounded up to a multiple of it, so that the OS can back them with huge pages (which saves most of their page faults and TLB misses)
+static constexpr size_t huge_page_size = 2 * 1024 * 1024;
+static constexpr size_t page_size      = 4096;
+/// A size class that hasn't been requested during that many requests of other sizes is freed. It is a few seconds of a stream, even with several webcams.
+static constexpr uint64_t requests_before_freeing_unused_size_class = 256;
+/// The buffers that go back to a full size class are freed: the Images that keep more images than that alive don't need us to keep even more in reserve
+static constexpr size_t max_free_buffers_per_size_class = 8;
+
+/// The length that we allocate for a buffer of at least `length` bytes. All the buffers of a size class have that length.
+static auto size_class_length(size_t length) -> size_t
+{
+    auto const granularity = length >= huge_page_size ? huge_page_size : page_size;
+    return (length + granularity - 1) / granularity * granularity;
+}
+
+static auto buffer_alignment(size_t length) -> std::align_val_t
+{
+    return std::align_val_t{length >= huge_page_size ? huge_page_size : alignment};
+}
+
+static auto allocate(size_t length) -> uint8_t*
+{
+    auto* const buffer = static_cast<uint8_t*>(::operator new(length, buffer_alignment(length)));
+#if defined(MADV_HUGEPAGE)
+    if (length >= huge_page_size)
+        madvise(buffer, length, MADV_HUGEPAGE); // Only a hint: it fails harmlessly if transparent huge pages are disabled
+#endif
+    return buffer;
+}
+
+static void deallocate(uint8_t* buffer, size_t length)
+{
+    ::operator delete(buffer, buffer_alignment(length));
+}
+
+auto BufferPool::get(size_t length) -> std::shared_ptr<uint8_t>
+{
+    length = size_class_length(length);
+
+    auto const deleter = [this, length](uint8_t* buffer) {
+        give_back(buffer, length);
+    };
+    {
+        std::scoped_lock lock{_mutex};
+        ++_requests_count;
+        auto& size_class        = _size_classes[length];
+        size_class.last_request = _requests_count;
+        free_unused_size_classes();
+        if (!size_class.free_buffers.empty())
+        {
+            uint8_t* const buffer = size_class.free_buffers.back();
+            size_class.free_buffers.pop_back();
+            return std::shared_ptr<uint8_t>{buffer, deleter};
+        }
+    }
+    return std::shared_ptr<uint8_t>{allocate(length), deleter}; // Outside of the lock, because it can take a while for big buffers
+}
+
+void BufferPool::give_back(uint8_t* buffer, size_t length)
+{
+    {
+        std::scoped_lock lock{_mutex};
+        auto const       it = _size_classes.find(length);
+        if (it != _size_classes.end() && it->second.free_buffers.size() < max_free_buffers_per_size_class)
+        {
+            it->second.free_buffers.push_back(buffer);
+            return;
+        }
+    }
+    deallocate(buffer, length); // Its size class has been freed in the meantime, or is full
+}
+
+void BufferPool::free_unused_size_classes()
+{
+    for (auto it = _size_classes.begin(); it != _size_classes.end();)
+    {
+        if (_requests_count - it->second.last_request < requests_before_freeing_unused_size_class)
+        {
+            ++it;
+            continue;
+        }
+        for (uint8_t* const buffer : it->second.free_buffers)
+            deallocate(buffer, it->first);
+        it = _size_classes.erase(it);
+    }
+}
+
+void BufferPool::trim()
+{
+    std::scoped_lock lock{_mutex};
+    for (auto& [length, size_class] : _size_classes)
+    {
+        for (uint8_t* const buffer : size_class.free_buffers)
+            deallocate(buffer, length);
+        size_class.free_buffers.clear();
+    }
+}
+
+} // namespace wcam::internal
\ No newline at end of file
@@ -0,0 +1,51 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace wcam::internal {
+
+/// Recycles the buffers of the images that we give to the Images, so that capturing a stream of images of the same size doesn't allocate (and page-fault) a new buffer for each of them.
+/// The buffers are grouped by size class, and a size class that hasn't been requested for a while (e.g. because the resolution has changed) is freed.
+class BufferPool {
+public:
+    BufferPool()                                         = default;
+    ~BufferPool()                                        = default;
+    BufferPool(BufferPool const&)                        = delete;
+    auto operator=(BufferPool const&) -> BufferPool&     = delete;
+    BufferPool(BufferPool&&) noexcept                    = delete;
+    auto operator=(BufferPool&&) noexcept -> BufferPool& = delete;
+
+    /// Returns a buffer of at least `length` bytes, aligned on 64 bytes (and backed by huge pages when it is big enough and the OS allows it).
+    /// When the last copy of the shared_ptr is destroyed, the buffer goes back to the pool instead of being freed.
+    auto get(size_t length) -> std::shared_ptr<uint8_t>;
+
+    /// Frees all the buffers that are not in use
+    void trim();
+
+private:
+    void give_back(uint8_t* buffer, size_t length);
+    void free_unused_size_classes();
+
+private:
+    struct SizeClass {
+        std::vector<uint8_t*> free_buffers{};
+        uint64_t              last_request{}; // The value of _requests_count when a buffer of that size was last requested
+    };
+
+    std::mutex                  _mutex{};
+    std::map<size_t, SizeClass> _size_classes{}; // By allocated length
+    uint64_t                    _requests_count{};
+};
+
+/// It is never destroyed, because the buffers that the Images still hold when the application exits go back to it
+inline auto buffer_pool() -> BufferPool&
+{
+    static auto* const instance = new BufferPool{}; // NOLINT(*owning-memory)
+    return *instance;
+}
+
+} // namespace wcam::internal
\ No newline at end of file
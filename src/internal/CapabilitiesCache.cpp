@@ -0,0 +1,129 @@
+#include "CapabilitiesCache.hpp"
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <system_error>
+
+namespace wcam::internal {
+
+// File format: a header line, then one line per device:
+// device_path \t inode \t change_time \t serial_number \t name \t pixel_format:widthxheight pixel_format:widthxheight ...
+static constexpr auto file_header = "wcam capabilities cache v1";
+
+/// Makes sure the string won't break our tab- and line-separated file format
+static auto sanitized(std::string str) -> std::string
+{
+    std::replace_if(str.begin(), str.end(), [](char c) { return c == '\t' || c == '\n' || c == '\r'; }, ' ');
+    return str;
+}
+
+void CapabilitiesCache::set_file(std::filesystem::path file_path)
+{
+    std::scoped_lock lock{_mutex};
+    _file_path = std::move(file_path);
+    load_file();
+}
+
+auto CapabilitiesCache::get(std::string const& device_path, DeviceIdentity const& identity) const -> std::optional<DeviceCapabilities>
+{
+    std::scoped_lock lock{_mutex};
+    auto const       it = _entries.find(device_path);
+    if (it == _entries.end() || it->second.identity != identity)
+        return std::nullopt;
+    return it->second.capabilities;
+}
+
+void CapabilitiesCache::set(std::string const& device_path, DeviceIdentity identity, DeviceCapabilities capabilities)
+{
+    std::scoped_lock lock{_mutex};
+    _entries[device_path] = Entry{std::move(identity), std::move(capabilities)};
+    _has_unsaved_entries  = true;
+}
+
+void CapabilitiesCache::save()
+{
+    std::scoped_lock file_lock{_file_mutex};
+    auto             file_path = std::filesystem::path{};
+    auto             entries   = std::unordered_map<std::string, Entry>{};
+    {
+        std::scoped_lock lock{_mutex};
+        if (!_has_unsaved_entries || !_file_path.has_value())
+            return;
+        _has_unsaved_entries = false;
+        file_path            = *_file_path;
+        entries              = _entries; // Copied, so that we write the file without holding the lock
+    }
+    save_file(file_path, entries);
+}
+
+void CapabilitiesCache::load_file()
+{
+    auto file = std::ifstream{*_file_path};
+    auto line = std::string{};
+    if (!std::getline(file, line) || line != file_header)
+        return; // The file doesn't exist yet, or has been written by an incompatible version
+
+    while (std::getline(file, line))
+    {
+        auto fields = std::vector<std::string>{};
+        auto stream = std::istringstream{line};
+        for (auto field = std::string{}; std::getline(stream, field, '\t');)
+            fields.push_back(std::move(field));
+        if (fields.size() < 5)
+            continue;
+
+        auto entry = Entry{};
+        try
+        {
+            entry.identity.inode       = std::stoull(fields[1]);
+            entry.identity.change_time = std::stoll(fields[2]);
+        }
+        catch (std::exception const&)
+        {
+            continue;
+        }
+        entry.identity.serial_number = fields[3];
+        entry.capabilities.name      = fields[4];
+
+        auto formats = std::istringstream{fields.size() > 5 ? fields[5] : ""};
+        for (auto format = std::string{}; formats >> format;)
+        {
+            uint32_t             pixel_format{};
+            Resolution::DataType width{};
+            Resolution::DataType height{};
+            char                 colon{};
+            char                 x{};
+            if (std::istringstream{format} >> pixel_format >> colon >> width >> x >> height)
+                entry.capabilities.formats.push_back({pixel_format, Resolution{width, height}});
+        }
+
+        _entries.insert_or_assign(fields[0], std::move(entry));
+    }
+}
+
+void CapabilitiesCache::save_file(std::filesystem::path const& file_path, std::unordered_map<std::string, Entry> const& entries)
+{
+    // Write to a temporary file first, so that we never leave a half-written cache behind us if the application gets killed
+    auto const temporary_path = std::filesystem::path{file_path}.concat(".tmp");
+    {
+        auto file = std::ofstream{temporary_path};
+        if (!file)
+            return;
+        file << file_header << '\n';
+        for (auto const& [device_path, entry] : entries)
+        {
+            file << sanitized(device_path) << '\t'
+                 << entry.identity.inode << '\t'
+                 << entry.identity.change_time << '\t'
+                 << sanitized(entry.identity.serial_number) << '\t'
+                 << sanitized(entry.capabilities.name) << '\t';
+            for (auto const& format : entry.capabilities.formats)
+                file << format.pixel_format << ':' << format.resolution.width() << 'x' << format.resolution.height() << ' ';
+            file << '\n';
+        }
+    }
+    auto error_code = std::error_code{};
+    std::filesystem::rename(temporary_path, file_path, error_code); // We don't care if it fails, the cache will just be rebuilt during the next run
+}
+
+} // namespace wcam::internal
\ No newline at end of file
@@ -0,0 +1,69 @@
+#pragma once
+#include <cstdint>
+#include <filesystem>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "../Resolution.hpp"
+
+namespace wcam::internal {
+
+/// Identifies a device as it is currently plugged in. If any of these changes, the device has been replugged or replaced, and we need to query its capabilities again.
+struct DeviceIdentity {
+    uint64_t    inode{};
+    int64_t     change_time{}; /// In nanoseconds
+    std::string serial_number{};
+
+    friend auto operator==(DeviceIdentity const&, DeviceIdentity const&) -> bool = default;
+};
+
+struct PixelFormatAndResolution {
+    uint32_t   pixel_format{}; /// Backend-specific code (e.g. a V4L2 fourcc on Linux)
+    Resolution resolution{};
+};
+
+struct DeviceCapabilities {
+    std::string                           name{};
+    std::vector<PixelFormatAndResolution> formats{}; /// In the order the device reported them
+};
+
+/// Remembers the capabilities of each device, because querying them can take hundreds of milliseconds with some cameras.
+/// Lives in memory, and can optionally be persisted to a file to speed up the next runs of the application.
+class CapabilitiesCache {
+public:
+    /// Loads the entries stored in that file, and saves all the new entries to it from now on (see save())
+    void set_file(std::filesystem::path file_path);
+
+    [[nodiscard]] auto get(std::string const& device_path, DeviceIdentity const&) const -> std::optional<DeviceCapabilities>;
+    /// Only changes the entries in memory: they are written to the file by the next call to save()
+    void set(std::string const& device_path, DeviceIdentity identity, DeviceCapabilities capabilities);
+    /// Writes the entries to the file, if set() has changed them since the last save.
+    /// It is called once after each enumeration of the devices, instead of for each device, and writes a copy of the entries so that get() doesn't wait for the file.
+    void save();
+
+private:
+    struct Entry;
+    void        load_file();
+    static void save_file(std::filesystem::path const& file_path, std::unordered_map<std::string, Entry> const& entries);
+
+private:
+    struct Entry {
+        DeviceIdentity     identity{};
+        DeviceCapabilities capabilities{};
+    };
+    std::unordered_map<std::string, Entry> _entries{}; // Keyed by device path
+    std::optional<std::filesystem::path>   _file_path{};
+    bool                                   _has_unsaved_entries{};
+    mutable std::mutex                     _mutex{};
+    std::mutex                             _file_mutex{}; // So that two calls to save() never write the temporary file at the same time
+};
+
+inline auto capabilities_cache() -> CapabilitiesCache&
+{
+    static auto instance = CapabilitiesCache{};
+    return instance;
+}
+
+} // namespace wcam::internal
\ No newline at end of file
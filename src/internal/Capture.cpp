@@ -5,8 +5,8 @@
 
 namespace wcam::internal {
 
-Capture::Capture(DeviceId const& id, Resolution const& resolution)
-    : _pimpl{std::make_unique<internal::CaptureImpl>(id, resolution)}
+Capture::Capture(DeviceId const& id, Resolution const& resolution, std::shared_ptr<CaptureSettings const> settings)
+    : _pimpl{std::make_unique<internal::CaptureImpl>(id, resolution, std::move(settings))}
 {
 }
 
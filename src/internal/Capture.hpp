@@ -2,15 +2,17 @@
 #include <memory>
 #include "../DeviceId.hpp"
 #include "../MaybeImage.hpp"
+#include "CaptureSettings.hpp"
 #include "ICaptureImpl.hpp"
 
 namespace wcam::internal {
 
 class Capture {
 public:
-    Capture(DeviceId const& id, Resolution const& resolution);
+    Capture(DeviceId const& id, Resolution const& resolution, std::shared_ptr<CaptureSettings const> settings);
 
     [[nodiscard]] auto image() -> MaybeImage { return _pimpl->image(); }
+    [[nodiscard]] auto dropped_frames() const -> DroppedFrames { return _pimpl->dropped_frames(); }
 
 private:
     std::unique_ptr<internal::ICaptureImpl> _pimpl;
@@ -0,0 +1,94 @@
+#pragma once
+#include <mutex>
+#include <optional>
+#include "../MjpegDecoding.hpp"
+#include "../Orientation.hpp"
+#include "../RegionOfInterest.hpp"
+#include "../ResizeFilter.hpp"
+#include "../Resolution.hpp"
+#include "../TensorFormat.hpp"
+
+namespace wcam::internal {
+
+/// The settings of a webcam that the user can change at any time. They are read by the capture thread for each new image.
+class CaptureSettings {
+public:
+    [[nodiscard]] auto orientation() const -> Orientation
+    {
+        std::scoped_lock lock{_mutex};
+        return _orientation;
+    }
+    void set_orientation(Orientation orientation)
+    {
+        std::scoped_lock lock{_mutex};
+        _orientation = orientation;
+    }
+    [[nodiscard]] auto tensor_format() const -> TensorFormat
+    {
+        std::scoped_lock lock{_mutex};
+        return _tensor_format;
+    }
+    void set_tensor_format(TensorFormat const& tensor_format)
+    {
+        std::scoped_lock lock{_mutex};
+        _tensor_format = tensor_format;
+    }
+    [[nodiscard]] auto output_resolution() const -> std::optional<Resolution>
+    {
+        std::scoped_lock lock{_mutex};
+        return _output_resolution;
+    }
+    [[nodiscard]] auto resize_filter() const -> ResizeFilter
+    {
+        std::scoped_lock lock{_mutex};
+        return _resize_filter;
+    }
+    void set_output_resolution(std::optional<Resolution> resolution, ResizeFilter filter)
+    {
+        std::scoped_lock lock{_mutex};
+        _output_resolution = resolution;
+        _resize_filter     = filter;
+    }
+    [[nodiscard]] auto region_of_interest() const -> std::optional<RegionOfInterest>
+    {
+        std::scoped_lock lock{_mutex};
+        return _region_of_interest;
+    }
+    void set_region_of_interest(std::optional<RegionOfInterest> region)
+    {
+        std::scoped_lock lock{_mutex};
+        _region_of_interest = region;
+    }
+    [[nodiscard]] auto mjpeg_decoding() const -> MjpegDecoding
+    {
+        std::scoped_lock lock{_mutex};
+        return _mjpeg_decoding;
+    }
+    void set_mjpeg_decoding(MjpegDecoding decoding)
+    {
+        std::scoped_lock lock{_mutex};
+        _mjpeg_decoding = decoding;
+    }
+    [[nodiscard]] auto max_resolution() const -> std::optional<Resolution>
+    {
+        std::scoped_lock lock{_mutex};
+        return _max_resolution;
+    }
+    void set_max_resolution(std::optional<Resolution> resolution)
+    {
+        std::scoped_lock lock{_mutex};
+        _max_resolution = resolution;
+    }
+
+private:
+    Orientation                     _orientation{};
+    TensorFormat                    _tensor_format{};
+    std::optional<Resolution>       _output_resolution{};
+    ResizeFilter                    _resize_filter{};
+    std::optional<RegionOfInterest> _region_of_interest{};
+    MjpegDecoding                   _mjpeg_decoding{};
+    std::optional<Resolution>       _max_resolution{};
+    mutable std::mutex              _mutex{};
+};
+
+} // namespace wcam::internal
\ No newline at end of file
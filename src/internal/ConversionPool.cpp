@@ -0,0 +1,137 @@
+#include "ConversionPool.hpp"
+#include <algorithm>
+
+namespace wcam::internal {
+
+/// Below that, waking up the workers costs more than what they would save us (e.g. a 640x480 RGB image is 0.9 MB)
+static constexpr size_t min_bytes_to_use_threads = 2 * 1024 * 1024;
+/// Small enough that the input and output of a stripe fit in the L2 cache of most CPUs, and big enough to keep the synchronization negligible
+static constexpr size_t stripe_bytes = 128 * 1024;
+
+/// True while the current thread converts some rows. The conversions that it requests from there (e.g. of a single row that has just been resized) are done inline,
+/// because the workers are busy with the outer conversion (and the thread that requested it might already own the _conversion_mutex).
+static thread_local bool is_converting_rows = false; // NOLINT(*avoid-non-const-global-variables)
+
+static void convert_rows_here(uint32_t begin, uint32_t end, std::function<void(uint32_t begin, uint32_t end)> const& convert_rows)
+{
+    bool const was_converting_rows = is_converting_rows;
+    is_converting_rows             = true;
+    convert_rows(begin, end);
+    is_converting_rows = was_converting_rows;
+}
+
+ConversionPool::ConversionPool()
+{
+    start_workers(std::max(std::thread::hardware_concurrency(), 1u) - 1);
+}
+
+ConversionPool::~ConversionPool()
+{
+    stop_workers();
+}
+
+void ConversionPool::set_threads_count(size_t threads_count)
+{
+    std::scoped_lock conversion_lock{_conversion_mutex};
+    stop_workers();
+    start_workers(std::max(threads_count, size_t{1}) - 1);
+}
+
+void ConversionPool::start_workers(size_t workers_count)
+{
+    _wants_to_stop = false;
+    for (size_t i = 0; i < workers_count; ++i)
+        _workers.emplace_back([this]() { worker_job(); });
+}
+
+void ConversionPool::stop_workers()
+{
+    {
+        std::scoped_lock lock{_mutex};
+        _wants_to_stop = true;
+    }
+    _job_available.notify_all();
+    for (auto& worker : _workers)
+        worker.join();
+    _workers.clear();
+}
+
+void ConversionPool::convert(uint32_t rows_count, size_t bytes_per_row, uint32_t rows_alignment, std::function<void(uint32_t begin, uint32_t end)> const& convert_rows)
+{
+    if (is_converting_rows)
+    {
+        convert_rows_here(0, rows_count, convert_rows);
+        return;
+    }
+
+    auto conversion_lock = std::unique_lock{_conversion_mutex, std::try_to_lock};
+    if (!conversion_lock.owns_lock() // The workers are busy with an image from another webcam, so we are better off converting this one ourselves than waiting for them
+        || _workers.empty()
+        || rows_count * bytes_per_row < min_bytes_to_use_threads)
+    {
+        convert_rows_here(0, rows_count, convert_rows);
+        return;
+    }
+
+    auto rows_per_stripe = static_cast<uint32_t>(std::max(stripe_bytes / std::max(bytes_per_row, size_t{1}), size_t{1}));
+    rows_per_stripe      = (rows_per_stripe + rows_alignment - 1) / rows_alignment * rows_alignment;
+    {
+        std::scoped_lock lock{_mutex};
+        _convert_rows    = &convert_rows;
+        _rows_count      = rows_count;
+        _rows_per_stripe = rows_per_stripe;
+        _stripes_count   = (rows_count + rows_per_stripe - 1) / rows_per_stripe;
+        _next_stripe     = 0;
+        _stripes_done    = 0;
+        _job_id++;
+    }
+    _job_available.notify_all();
+
+    convert_stripes();
+
+    auto lock = std::unique_lock{_mutex};
+    _job_done.wait(lock, [&]() { return _stripes_done == _stripes_count && _busy_workers == 0; });
+    _convert_rows = nullptr; // Workers that wake up late must not start working on a job that is already finished
+}
+
+void ConversionPool::convert_stripes()
+{
+    auto lock = std::unique_lock{_mutex};
+    while (_next_stripe < _stripes_count)
+    {
+        uint32_t const begin = _next_stripe * _rows_per_stripe;
+        uint32_t const end   = std::min(begin + _rows_per_stripe, _rows_count);
+        _next_stripe++;
+
+        lock.unlock();
+        convert_rows_here(begin, end, *_convert_rows);
+        lock.lock();
+
+        _stripes_done++;
+    }
+    if (_stripes_done == _stripes_count)
+        _job_done.notify_one();
+}
+
+void ConversionPool::worker_job()
+{
+    uint64_t last_job_id = 0;
+    auto     lock        = std::unique_lock{_mutex};
+    while (true)
+    {
+        _job_available.wait(lock, [&]() { return _wants_to_stop || (_job_id != last_job_id && _convert_rows); });
+        if (_wants_to_stop)
+            return;
+        last_job_id = _job_id;
+
+        _busy_workers++;
+        lock.unlock();
+        convert_stripes();
+        lock.lock();
+        _busy_workers--;
+        if (_busy_workers == 0)
+            _job_done.notify_one();
+    }
+}
+
+} // namespace wcam::internal
\ No newline at end of file
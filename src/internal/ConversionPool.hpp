@@ -0,0 +1,65 @@
+#pragma once
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace wcam::internal {
+
+/// A persistent pool of threads that converts big images in parallel, by splitting them into horizontal stripes that fit in the cache.
+/// The thread that requests a conversion also works on it, instead of waiting idly.
+class ConversionPool {
+public:
+    ConversionPool();
+    ~ConversionPool();
+    ConversionPool(ConversionPool const&)                        = delete;
+    auto operator=(ConversionPool const&) -> ConversionPool&     = delete;
+    ConversionPool(ConversionPool&&) noexcept                    = delete;
+    auto operator=(ConversionPool&&) noexcept -> ConversionPool& = delete;
+
+    /// Number of threads that work on a conversion, including the one that requests it. 1 (or 0) disables the multi-threading.
+    void set_threads_count(size_t threads_count);
+
+    /// Calls `convert_rows(begin, end)` on stripes of rows that cover [0, rows_count), possibly in parallel.
+    /// `bytes_per_row` (of the output) is used to size the stripes, and to decide if the image is big enough to be worth splitting.
+    /// The first row of each stripe is a multiple of `rows_alignment` (e.g. 2 for NV12, where two rows share the same chroma samples).
+    /// `convert_rows` can itself request conversions: they are done inline.
+    void convert(uint32_t rows_count, size_t bytes_per_row, uint32_t rows_alignment, std::function<void(uint32_t begin, uint32_t end)> const& convert_rows);
+
+private:
+    void start_workers(size_t workers_count);
+    void stop_workers();
+    void convert_stripes();
+    void worker_job();
+
+private:
+    /// Only one conversion can use the workers at a time
+    std::mutex _conversion_mutex{};
+
+    std::vector<std::thread> _workers{};
+    std::mutex               _mutex{};
+    std::condition_variable  _job_available{};
+    std::condition_variable  _job_done{};
+    bool                     _wants_to_stop{false};
+
+    // Current job. Protected by _mutex.
+    std::function<void(uint32_t, uint32_t)> const* _convert_rows{nullptr};
+    uint64_t                                       _job_id{0};
+    uint32_t                                       _rows_count{};
+    uint32_t                                       _rows_per_stripe{};
+    uint32_t                                       _stripes_count{};
+    uint32_t                                       _next_stripe{};
+    uint32_t                                       _stripes_done{};
+    size_t                                         _busy_workers{};
+};
+
+inline auto conversion_pool() -> ConversionPool&
+{
+    static auto instance = ConversionPool{};
+    return instance;
+}
+
+} // namespace wcam::internal
\ No newline at end of file
@@ -0,0 +1,103 @@
+#include "Destination.hpp"
+#include <cstring>
+
+namespace wcam::internal {
+
+Destination::Destination(uint8_t* data, size_t bytes_per_pixel, Resolution source_resolution, FirstRowIs source_row_order, Orientation const& orientation, size_t row_stride)
+    : _bytes_per_pixel{bytes_per_pixel}
+    , _source_width{source_resolution.width()}
+{
+    auto const width            = static_cast<std::ptrdiff_t>(source_resolution.width());
+    auto const height           = static_cast<std::ptrdiff_t>(source_resolution.height());
+    auto const pixel_size       = static_cast<std::ptrdiff_t>(bytes_per_pixel);
+    bool const rotates_by_90    = orientation.rotation == Rotation::Clockwise90 || orientation.rotation == Rotation::Clockwise270;
+    bool const normalizes_order = orientation.normalize_row_order || orientation.rotation != Rotation::None;
+    bool const flips            = normalizes_order && source_row_order == FirstRowIs::Bottom;
+
+    _resolution = rotates_by_90 ? Resolution{source_resolution.height(), source_resolution.width()} : source_resolution;
+    _row_order  = flips ? FirstRowIs::Top : source_row_order;
+
+    auto const stride = row_stride != 0
+                            ? static_cast<std::ptrdiff_t>(row_stride)
+                            : pixel_size * static_cast<std::ptrdiff_t>(_resolution.width());
+
+    // Position, in the destination image, of the pixel (x, y) of the source image. It is an affine function of x and y.
+    auto const offset = [&](std::ptrdiff_t x, std::ptrdiff_t y) -> std::ptrdiff_t {
+        y = flips ? height - 1 - y : y;
+        x = orientation.mirror ? width - 1 - x : x;
+        auto const at = [&](std::ptrdiff_t destination_x, std::ptrdiff_t destination_y) {
+            return destination_y * stride + destination_x * pixel_size;
+        };
+        switch (orientation.rotation)
+        {
+        case Rotation::None:
+            return at(x, y);
+        case Rotation::Clockwise90:
+            return at(height - 1 - y, x);
+        case Rotation::Clockwise180:
+            return at(width - 1 - x, height - 1 - y);
+        case Rotation::Clockwise270:
+            return at(y, width - 1 - x);
+        }
+        return 0;
+    };
+    _origin = data + offset(0, 0); // NOLINT(*pointer-arithmetic)
+    _x_step = offset(1, 0) - offset(0, 0);
+    _y_step = offset(0, 1) - offset(0, 0);
+}
+
+auto Destination::direct_row(uint32_t y) const -> uint8_t*
+{
+    if (_x_step != static_cast<std::ptrdiff_t>(_bytes_per_pixel))
+        return nullptr;
+    return _origin + static_cast<std::ptrdiff_t>(y) * _y_step; // NOLINT(*pointer-arithmetic)
+}
+
+void Destination::write_row(uint32_t y, uint8_t const* row) const
+{
+    uint8_t* pixel = _origin + static_cast<std::ptrdiff_t>(y) * _y_step; // NOLINT(*pointer-arithmetic)
+    for (uint32_t x = 0; x < _source_width; ++x)
+    {
+        std::memcpy(pixel, row + static_cast<size_t>(x) * _bytes_per_pixel, _bytes_per_pixel); // NOLINT(*pointer-arithmetic)
+        pixel += _x_step;                                                                      // NOLINT(*pointer-arithmetic)
+    }
+}
+
+/// The resolution of the chroma planes of NV12 and I420
+static auto chroma_resolution(Resolution resolution) -> Resolution
+{
+    return Resolution{(resolution.width() + 1) / 2, (resolution.height() + 1) / 2};
+}
+
+YUV420Destination::YUV420Destination(Destination const& luma, std::array<Destination, 2> const& chroma, bool interleaved_chroma)
+    : _luma{luma}
+    , _chroma{chroma}
+    , _interleaved_chroma{interleaved_chroma}
+{
+}
+
+YUV420Destination::YUV420Destination(uint8_t* data, NV12::Planes const& planes, Resolution source_resolution, FirstRowIs source_row_order, Orientation const& orientation)
+    : YUV420Destination{
+          Destination{data + planes[0].offset, 1, source_resolution, source_row_order, orientation, planes[0].stride}, // NOLINT(*pointer-arithmetic)
+          {
+              Destination{data + planes[1].offset, 2, chroma_resolution(source_resolution), source_row_order, orientation, planes[1].stride}, // NOLINT(*pointer-arithmetic)
+              Destination{data + planes[1].offset, 2, chroma_resolution(source_resolution), source_row_order, orientation, planes[1].stride}, // NOLINT(*pointer-arithmetic)
+          },
+          true,
+      }
+{
+}
+
+YUV420Destination::YUV420Destination(uint8_t* data, I420::Planes const& planes, Resolution source_resolution, FirstRowIs source_row_order, Orientation const& orientation)
+    : YUV420Destination{
+          Destination{data + planes[0].offset, 1, source_resolution, source_row_order, orientation, planes[0].stride}, // NOLINT(*pointer-arithmetic)
+          {
+              Destination{data + planes[1].offset, 1, chroma_resolution(source_resolution), source_row_order, orientation, planes[1].stride}, // NOLINT(*pointer-arithmetic)
+              Destination{data + planes[2].offset, 1, chroma_resolution(source_resolution), source_row_order, orientation, planes[2].stride}, // NOLINT(*pointer-arithmetic)
+          },
+          false,
+      }
+{
+}
+
+} // namespace wcam::internal
\ No newline at end of file
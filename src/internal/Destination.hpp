@@ -0,0 +1,69 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include "../FirstRowIs.hpp"
+#include "../Image.hpp"
+#include "../Orientation.hpp"
+#include "../Resolution.hpp"
+
+namespace wcam::internal {
+
+/// Where the rows of an image that is being converted to a packed format (RGB24, BGR24, RGBA32, BGRA32, GREY8) are written.
+/// It applies an Orientation on the fly: a row that only needs to be moved vertically is converted directly to its place,
+/// and one whose pixels need to be reordered is converted in a small scratch row that stays in the cache, and then scattered to its place.
+class Destination {
+public:
+    /// `source_resolution` and `source_row_order` are the ones of the image that is being converted.
+    /// `row_stride` is the number of bytes between the starts of two consecutive rows of the destination image, or 0 if its rows are not padded.
+    Destination(uint8_t* data, size_t bytes_per_pixel, Resolution source_resolution, FirstRowIs source_row_order, Orientation const& orientation = {}, size_t row_stride = 0);
+
+    /// The resolution of the converted image, which is rotated compared to the source image for 90° and 270° rotations
+    [[nodiscard]] auto resolution() const -> Resolution { return _resolution; }
+    [[nodiscard]] auto row_order() const -> FirstRowIs { return _row_order; }
+    /// Width of the rows of the source image
+    [[nodiscard]] auto source_width() const -> uint32_t { return _source_width; }
+    [[nodiscard]] auto bytes_per_pixel() const -> size_t { return _bytes_per_pixel; }
+
+    /// Returns where the row `y` of the source image can be written directly, or nullptr if its pixels need to be reordered (in which case you must use write_row())
+    [[nodiscard]] auto direct_row(uint32_t y) const -> uint8_t*;
+    /// Writes the row `y` of the source image, that has been converted somewhere else
+    void write_row(uint32_t y, uint8_t const* row) const;
+
+private:
+    uint8_t*       _origin{}; // Where the first pixel of the source image goes
+    std::ptrdiff_t _x_step{}; // Offset between two consecutive pixels of a row of the source image
+    std::ptrdiff_t _y_step{}; // Offset between two consecutive rows of the source image
+    size_t         _bytes_per_pixel{};
+    uint32_t       _source_width{};
+    Resolution     _resolution{};
+    FirstRowIs     _row_order{};
+};
+
+/// Where the planes of an image that is being converted to NV12 or I420 are written.
+/// Each plane is a Destination of its own, so it applies the Orientation on the fly too: the "pixels" of the chroma planes are the samples of each 2x2 block of pixels.
+class YUV420Destination {
+public:
+    /// `planes` are the ones of the converted image (a plane of (u, v) pairs for NV12, or a plane of u and a plane of v for I420)
+    YUV420Destination(uint8_t* data, NV12::Planes const& planes, Resolution source_resolution, FirstRowIs source_row_order, Orientation const& orientation);
+    YUV420Destination(uint8_t* data, I420::Planes const& planes, Resolution source_resolution, FirstRowIs source_row_order, Orientation const& orientation);
+
+    /// The resolution of the converted image, which is rotated compared to the source image for 90° and 270° rotations
+    [[nodiscard]] auto resolution() const -> Resolution { return _luma.resolution(); }
+    [[nodiscard]] auto row_order() const -> FirstRowIs { return _luma.row_order(); }
+
+    [[nodiscard]] auto luma() const -> Destination const& { return _luma; }
+    /// The plane of (u, v) pairs for NV12, or the plane of u (index 0) or of v (index 1) for I420
+    [[nodiscard]] auto chroma(size_t index) const -> Destination const& { return _chroma[index]; } // NOLINT(*constant-array-index)
+    [[nodiscard]] auto has_interleaved_chroma() const -> bool { return _interleaved_chroma; }
+
+private:
+    YUV420Destination(Destination const& luma, std::array<Destination, 2> const& chroma, bool interleaved_chroma);
+
+private:
+    Destination                _luma;
+    std::array<Destination, 2> _chroma; // Both are the (u, v) plane for NV12
+    bool                       _interleaved_chroma{};
+};
+
+} // namespace wcam::internal
\ No newline at end of file
@@ -0,0 +1,232 @@
+#include "DevicesWatcher.hpp"
+#if defined(__linux__)
+#include <linux/netlink.h>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <algorithm>
+#include <array>
+#include <string_view>
+#include "make_device_id.hpp"
+#endif
+
+namespace wcam::internal {
+
+/// Used when we don't get notified of the changes, and need to poll the devices at a regular interval instead
+static constexpr auto polling_interval = std::chrono::milliseconds{250};
+
+#if defined(__linux__)
+
+static constexpr auto v4l_folder   = std::string_view{"/dev/v4l"};
+static constexpr auto by_id_folder = std::string_view{"/dev/v4l/by-id"};
+static constexpr auto watch_mask   = IN_CREATE | IN_DELETE | IN_MOVED_TO | IN_MOVED_FROM | IN_ONLYDIR;
+
+#if defined(WCAM_USE_UDEV_NETLINK)
+static auto open_udev_socket() -> int
+{
+    int const socket_handle = socket(AF_NETLINK, SOCK_RAW | SOCK_CLOEXEC | SOCK_NONBLOCK, NETLINK_KOBJECT_UEVENT);
+    if (socket_handle == -1)
+        return -1;
+
+    auto address      = sockaddr_nl{};
+    address.nl_family = AF_NETLINK;
+    address.nl_groups = 2; // The multicast group used by udev to broadcast the events once it has processed them (i.e. once the /dev/v4l/by-id links exist). Group 1 is for the raw kernel events.
+    if (bind(socket_handle, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == -1) // NOLINT(*reinterpret-cast)
+    {
+        close(socket_handle);
+        return -1;
+    }
+    return socket_handle;
+}
+#endif
+
+DevicesWatcher::DevicesWatcher()
+    : _wake_up_event{eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK)}
+{
+#if defined(WCAM_USE_UDEV_NETLINK)
+    _udev_socket = open_udev_socket();
+    if (_udev_socket != -1)
+        return;
+#endif
+    _inotify = inotify_init1(IN_CLOEXEC | IN_NONBLOCK);
+    if (_inotify == -1)
+        return; // We will fallback to polling
+    _dev_watch = inotify_add_watch(_inotify, "/dev", IN_CREATE | IN_DELETE | IN_ONLYDIR); // /dev/v4l only exists while at least one webcam is plugged in, so we also need to know when it gets (re)created
+    add_v4l_watches_ifn();
+}
+
+DevicesWatcher::~DevicesWatcher()
+{
+    for (int const file_handle : {_wake_up_event, _udev_socket, _inotify})
+    {
+        if (file_handle != -1)
+            close(file_handle);
+    }
+}
+
+/// Returns true iff a new watch has been added, in which case some devices might have been plugged in before we started watching, and we need to enumerate them all again
+auto DevicesWatcher::add_v4l_watches_ifn() -> bool
+{
+    bool added_a_watch{false};
+    if (_v4l_watch == -1)
+    {
+        _v4l_watch    = inotify_add_watch(_inotify, v4l_folder.data(), watch_mask);
+        added_a_watch = added_a_watch || _v4l_watch != -1;
+    }
+    if (_by_id_watch == -1)
+    {
+        _by_id_watch  = inotify_add_watch(_inotify, by_id_folder.data(), watch_mask);
+        added_a_watch = added_a_watch || _by_id_watch != -1;
+    }
+    return added_a_watch;
+}
+
+auto DevicesWatcher::read_inotify_events() -> DevicesChanges
+{
+    auto changes = DevicesChanges{};
+
+    alignas(inotify_event) auto buffer = std::array<char, 4096>{};
+    while (true)
+    {
+        auto const length = read(_inotify, buffer.data(), buffer.size());
+        if (length <= 0)
+            break; // EAGAIN, there are no more events to read
+
+        for (size_t offset = 0; offset < static_cast<size_t>(length);)
+        {
+            auto const* event = reinterpret_cast<inotify_event const*>(buffer.data() + offset); // NOLINT(*reinterpret-cast, *pointer-arithmetic)
+            offset += sizeof(inotify_event) + event->len;
+
+            if (event->mask & IN_Q_OVERFLOW)
+            {
+                changes.all_devices_might_have_changed = true;
+                continue;
+            }
+            if (event->mask & IN_IGNORED) // The folder has been deleted, it will be watched again once it is recreated
+            {
+                if (event->wd == _v4l_watch)
+                    _v4l_watch = -1;
+                if (event->wd == _by_id_watch)
+                    _by_id_watch = -1;
+                if (event->wd != _dev_watch)
+                    changes.all_devices_might_have_changed = true;
+                continue;
+            }
+            if (event->wd == _by_id_watch && event->len > 0)
+                changes.devices_that_changed.push_back(make_device_id(event->name)); // The name of the link is the id of the device
+        }
+    }
+
+    if (add_v4l_watches_ifn())
+        changes.all_devices_might_have_changed = true;
+    return changes;
+}
+
+auto DevicesWatcher::read_udev_events() -> DevicesChanges
+{
+    using namespace std::literals;
+    auto changes = DevicesChanges{};
+
+    auto buffer = std::array<char, 8192>{};
+    while (true)
+    {
+        auto const length = recv(_udev_socket, buffer.data(), buffer.size(), 0);
+        if (length <= 0)
+            break; // EAGAIN, there are no more events to read
+
+        // A message is a list of null-terminated "KEY=VALUE" strings (preceded by a binary header that we can safely skip because none of its strings contain '=')
+        bool is_a_webcam{false};
+        auto links = std::string_view{};
+        for (auto message = std::string_view{buffer.data(), static_cast<size_t>(length)}; !message.empty();)
+        {
+            auto const end      = std::min(message.find('\0'), message.size());
+            auto const property = message.substr(0, end);
+            message.remove_prefix(std::min(end + 1, message.size()));
+
+            if (property == "SUBSYSTEM=video4linux"sv)
+                is_a_webcam = true;
+            else if (property.starts_with("DEVLINKS="sv))
+                links = property.substr("DEVLINKS="sv.size());
+        }
+        if (!is_a_webcam)
+            continue;
+
+        bool found_an_id{false};
+        while (!links.empty()) // DEVLINKS is a space-separated list of paths
+        {
+            auto const end  = std::min(links.find(' '), links.size());
+            auto const link = links.substr(0, end);
+            links.remove_prefix(std::min(end + 1, links.size()));
+
+            if (link.starts_with(by_id_folder) && link.size() > by_id_folder.size() + 1)
+            {
+                changes.devices_that_changed.push_back(make_device_id(std::string{link.substr(by_id_folder.size() + 1)}));
+                found_an_id = true;
+            }
+        }
+        if (!found_an_id)
+            changes.all_devices_might_have_changed = true;
+    }
+
+    return changes;
+}
+
+auto DevicesWatcher::wait_for_changes(std::optional<std::chrono::milliseconds> timeout) -> DevicesChanges
+{
+    int const watcher_handle = _udev_socket != -1 ? _udev_socket : _inotify;
+    if (watcher_handle == -1 && (!timeout.has_value() || *timeout > polling_interval))
+        timeout = polling_interval; // We won't get notified, so we need to poll
+
+    auto fds = std::array<pollfd, 2>{
+        pollfd{.fd = _wake_up_event, .events = POLLIN, .revents = 0},
+        pollfd{.fd = watcher_handle, .events = POLLIN, .revents = 0}, // poll() ignores negative file handles
+    };
+    int const res = poll(fds.data(), fds.size(), timeout.has_value() ? static_cast<int>(timeout->count()) : -1);
+    if (res == -1)
+        return {}; // Probably interrupted by a signal (EINTR), the caller will just call us again
+
+    if (fds[0].revents & POLLIN)
+    {
+        auto counter = eventfd_t{};
+        eventfd_read(_wake_up_event, &counter); // Reset the event
+    }
+
+    if (watcher_handle == -1)
+        return {.all_devices_might_have_changed = res == 0};
+    if (!(fds[1].revents & POLLIN))
+        return {};
+    return _udev_socket != -1 ? read_udev_events() : read_inotify_events();
+}
+
+void DevicesWatcher::wake_up()
+{
+    eventfd_write(_wake_up_event, 1);
+}
+
+#else
+
+DevicesWatcher::DevicesWatcher()  = default;
+DevicesWatcher::~DevicesWatcher() = default;
+
+auto DevicesWatcher::wait_for_changes(std::optional<std::chrono::milliseconds> timeout) -> DevicesChanges
+{
+    std::unique_lock lock{_mutex};
+    bool const has_been_woken_up = _condition.wait_for(lock, timeout.has_value() ? std::min(*timeout, polling_interval) : polling_interval, [&]() { return _has_been_woken_up; });
+    _has_been_woken_up           = false;
+    return {.all_devices_might_have_changed = !has_been_woken_up}; // We have no way to know which devices changed, so every time the polling interval elapses we need to enumerate them all again
+}
+
+void DevicesWatcher::wake_up()
+{
+    {
+        std::scoped_lock lock{_mutex};
+        _has_been_woken_up = true;
+    }
+    _condition.notify_one();
+}
+
+#endif
+
+} // namespace wcam::internal
\ No newline at end of file
@@ -0,0 +1,55 @@
+#pragma once
+#include <chrono>
+#include <optional>
+#include <vector>
+#include "../DeviceId.hpp"
+#if !defined(__linux__)
+#include <condition_variable>
+#include <mutex>
+#endif
+
+namespace wcam::internal {
+
+struct DevicesChanges {
+    bool                  all_devices_might_have_changed{false}; /// When true, we need to enumerate all the devices again, and devices_that_changed is meaningless
+    std::vector<DeviceId> devices_that_changed{};                /// Devices that have been plugged in or unplugged
+};
+
+/// Lets the Manager's thread sleep until some webcams are actually plugged in or unplugged, instead of enumerating all the devices again and again.
+/// On Linux we get notified by inotify (or by udev through a netlink socket if WCAM_USE_UDEV_NETLINK is ON). On the other platforms we just poll at a regular interval.
+class DevicesWatcher {
+public:
+    DevicesWatcher();
+    ~DevicesWatcher();
+    DevicesWatcher(DevicesWatcher const&)                        = delete;
+    auto operator=(DevicesWatcher const&) -> DevicesWatcher&     = delete;
+    DevicesWatcher(DevicesWatcher&&) noexcept                    = delete;
+    auto operator=(DevicesWatcher&&) noexcept -> DevicesWatcher& = delete;
+
+    /// Blocks until some devices are plugged in / unplugged, `wake_up()` is called, or the timeout elapses (nullopt means no timeout).
+    [[nodiscard]] auto wait_for_changes(std::optional<std::chrono::milliseconds> timeout) -> DevicesChanges;
+
+    /// Makes the current (or next) call to `wait_for_changes()` return immediately. Can be called from any thread.
+    void wake_up();
+
+private:
+#if defined(__linux__)
+    auto read_inotify_events() -> DevicesChanges;
+    auto read_udev_events() -> DevicesChanges;
+    auto add_v4l_watches_ifn() -> bool;
+
+private:
+    int _wake_up_event{-1};
+    int _udev_socket{-1};
+    int _inotify{-1};
+    int _dev_watch{-1};
+    int _v4l_watch{-1};
+    int _by_id_watch{-1};
+#else
+    std::mutex              _mutex{};
+    std::condition_variable _condition{};
+    bool                    _has_been_woken_up{false};
+#endif
+};
+
+} // namespace wcam::internal
\ No newline at end of file
@@ -1,7 +1,14 @@
 #pragma once
+#include <atomic>
+#include <cstdint>
 #include <exception>
+#include <memory>
 #include <mutex>
+#include "../DroppedFrames.hpp"
 #include "../MaybeImage.hpp"
+#include "BufferPool.hpp"
+#include "CaptureSettings.hpp"
+#include "ImagePool.hpp"
 
 namespace wcam::internal {
 
@@ -16,7 +23,11 @@ public:
 class ICaptureImpl {
 public:
     /// Throws a CaptureException if the creation of the Capture fails
-    ICaptureImpl()                                           = default;
+    explicit ICaptureImpl(std::shared_ptr<CaptureSettings const> settings)
+        : _settings{std::move(settings)}
+    {
+        buffer_pool().trim(); // A new capture usually comes with a new resolution, so the buffers of the previous images won't be reused
+    }
     virtual ~ICaptureImpl()                                  = default;
     ICaptureImpl(ICaptureImpl const&)                        = delete;
     auto operator=(ICaptureImpl const&) -> ICaptureImpl&     = delete;
@@ -24,13 +35,24 @@ public:
     auto operator=(ICaptureImpl&&) noexcept -> ICaptureImpl& = delete;
 
     auto image() -> MaybeImage;
+    [[nodiscard]] auto dropped_frames() const -> DroppedFrames { return {_dropped_by_driver.load(), _dropped_before_decoding.load()}; }
 
 protected:
     void set_image(MaybeImage);
+    /// See DroppedFrames
+    void count_dropped_by_driver(uint64_t count) { _dropped_by_driver += count; }
+    void count_dropped_before_decoding() { _dropped_before_decoding++; }
+    [[nodiscard]] auto settings() const -> CaptureSettings const& { return *_settings; }
+    /// The Image that will receive the next captured image (which might be a recycled one, see ImagePool)
+    [[nodiscard]] auto make_image() -> std::shared_ptr<Image> { return _image_pool.make_image(); }
 
 private:
+    std::shared_ptr<CaptureSettings const> _settings;
     MaybeImage _image{ImageNotInitYet{}};
     std::mutex _mutex{};
+    ImagePool _image_pool{};
+    std::atomic<uint64_t> _dropped_by_driver{0};
+    std::atomic<uint64_t> _dropped_before_decoding{0};
 };
 
 } // namespace wcam::internal
\ No newline at end of file
@@ -3,6 +3,7 @@
 #include <memory>
 #include "../Image.hpp"
 #include "../Resolution.hpp"
+#include "pixel_formats.hpp"
 
 namespace wcam::internal {
 
@@ -16,15 +17,44 @@ public:
     auto operator=(IImageFactory&&) noexcept -> IImageFactory& = delete;
 
     virtual auto make_image() const -> std::shared_ptr<Image> = 0;
+    /// For the ImagePool, that gives the Images to a shared_ptr of its own
+    virtual auto make_unique_image() const -> std::unique_ptr<Image> = 0;
+    /// The pixel formats for which the Image type overrides set_data()
+    virtual auto implemented_formats() const -> PixelFormatsSet const& = 0;
+    /// True iff the user has asked for the Images to be recycled (see set_image_type())
+    virtual auto recycles_images() const -> bool = 0;
 };
 
 template<typename ImageT>
 class ImageFactory : public IImageFactory {
 public:
+    explicit ImageFactory(bool recycle_images = false)
+        : _recycles_images{recycle_images}
+    {}
+
     auto make_image() const -> std::shared_ptr<Image> override
     {
         return std::make_shared<ImageT>();
     }
+
+    auto make_unique_image() const -> std::unique_ptr<Image> override
+    {
+        return std::make_unique<ImageT>();
+    }
+
+    auto implemented_formats() const -> PixelFormatsSet const& override
+    {
+        return _implemented_formats;
+    }
+
+    auto recycles_images() const -> bool override
+    {
+        return _recycles_images;
+    }
+
+private:
+    PixelFormatsSet _implemented_formats{internal::implemented_formats<ImageT>()};
+    bool            _recycles_images{};
 };
 
 inline auto image_factory_pointer() -> std::unique_ptr<IImageFactory>&
@@ -0,0 +1,55 @@
+#include "ImagePool.hpp"
+#include <utility>
+#include "ImageFactory.hpp"
+
+namespace wcam::internal {
+
+/// The Images that come back when that many are already waiting to be reused are destroyed: the user keeps more Images alive than we need in reserve
+static constexpr size_t max_free_images = 4;
+
+ImagePool::ImagePool() = default;
+
+ImagePool::~ImagePool()
+{
+    auto images = std::vector<std::unique_ptr<Image>>{};
+    {
+        std::scoped_lock lock{_free_list->mutex};
+        _free_list->is_open = false;
+        images              = std::move(_free_list->images);
+    }
+    // The Images are destroyed here, outside of the lock
+}
+
+auto ImagePool::make_image() -> std::shared_ptr<Image>
+{
+    if (!image_factory().recycles_images())
+        return image_factory().make_image();
+
+    auto image = std::unique_ptr<Image>{};
+    {
+        std::scoped_lock lock{_free_list->mutex};
+        if (!_free_list->images.empty())
+        {
+            image = std::move(_free_list->images.back());
+            _free_list->images.pop_back();
+        }
+    }
+    if (!image)
+        image = image_factory().make_unique_image();
+
+    auto const deleter = [free_list = _free_list](Image* released_image) {
+        free_list->give_back(released_image);
+    };
+    return std::shared_ptr<Image>{image.release(), deleter};
+}
+
+void ImagePool::FreeList::give_back(Image* image)
+{
+    auto owned_image = std::unique_ptr<Image>{image}; // Declared before the lock, so that it is destroyed after the lock is released if we don't keep it
+    owned_image->reset();                             // Releases the data it holds (e.g. a buffer leased from the driver) while it waits to be reused. Outside of the lock, because it is user code
+    std::scoped_lock lock{mutex};
+    if (is_open && images.size() < max_free_images)
+        images.push_back(std::move(owned_image));
+}
+
+} // namespace wcam::internal
\ No newline at end of file
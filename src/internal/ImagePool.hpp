@@ -0,0 +1,36 @@
+#pragma once
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include "../Image.hpp"
+
+namespace wcam::internal {
+
+/// Makes the Images of a capture. If the user has asked for it (see set_image_type()), the Images that are not used anymore go back to a free list,
+/// and are reused for the next images of that capture instead of being destroyed.
+class ImagePool {
+public:
+    ImagePool();
+    ~ImagePool();
+    ImagePool(ImagePool const&)                        = delete;
+    auto operator=(ImagePool const&) -> ImagePool&     = delete;
+    ImagePool(ImagePool&&) noexcept                    = delete;
+    auto operator=(ImagePool&&) noexcept -> ImagePool& = delete;
+
+    auto make_image() -> std::shared_ptr<Image>;
+
+private:
+    /// Shared with the deleters of the Images, that can outlive the pool
+    struct FreeList {
+        std::mutex                          mutex{};
+        std::vector<std::unique_ptr<Image>> images{};
+        bool                                is_open{true}; // False once the pool has been destroyed
+
+        void give_back(Image*);
+    };
+
+    std::shared_ptr<FreeList> _free_list{std::make_shared<FreeList>()};
+};
+
+} // namespace wcam::internal
\ No newline at end of file
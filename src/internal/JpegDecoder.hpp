@@ -0,0 +1,234 @@
+#pragma once
+#if defined(__linux__)
+#include <cstdio> // jpeglib.h needs it, and doesn't include it itself
+//
+#include <jpeglib.h>
+#if !defined(JCS_EXTENSIONS)
+#error "wcam needs libjpeg-turbo 1.5 or later (for JCS_EXTENSIONS, jpeg_crop_scanline() and jpeg_skip_scanlines())"
+#endif
+#include <array>
+#include <csetjmp>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include "../MjpegDecoding.hpp"
+#include "../Resolution.hpp"
+
+namespace wcam::internal {
+
+/// Thrown when libjpeg can't decode an image (e.g. a corrupt or truncated frame), instead of its default behaviour, which is to exit() the application
+class JpegError : public std::runtime_error {
+public:
+    using std::runtime_error::runtime_error;
+};
+
+/// The number of rows and columns of the decoded blocks of that component: 8, unless the DCT scales the image.
+/// Only valid once the output dimensions have been computed (e.g. by JpegDecoder::output_resolution()).
+inline auto block_size(jpeg_component_info const& component) -> uint32_t
+{
+#if JPEG_LIB_VERSION >= 70
+    return static_cast<uint32_t>(component.DCT_v_scaled_size);
+#else
+    return static_cast<uint32_t>(component.DCT_scaled_size);
+#endif
+}
+
+/// How many pixels of the decoded image share each decoded sample of the chroma, horizontally and vertically (0 when they don't divide evenly)
+struct ChromaSubsampling {
+    uint32_t horizontal{};
+    uint32_t vertical{};
+};
+
+/// The libjpeg decompressor of a capture. It is kept alive across the images, so that it is only created once, instead of for each image.
+class JpegDecoder {
+public:
+    JpegDecoder()
+    {
+        _info.err       = jpeg_std_error(&_err);
+        _err.error_exit = &JpegDecoder::error_exit;
+        call([&] { jpeg_create_decompress(&_info); });
+    }
+    ~JpegDecoder() { jpeg_destroy_decompress(&_info); }
+    JpegDecoder(JpegDecoder const&)                        = delete;
+    auto operator=(JpegDecoder const&) -> JpegDecoder&     = delete;
+    JpegDecoder(JpegDecoder&&) noexcept                    = delete;
+    auto operator=(JpegDecoder&&) noexcept -> JpegDecoder& = delete;
+
+    /// The JPEG that the next calls to start() will decode, and how. The data must stay alive until then.
+    /// It is decoded scaled by `scale_eighths` / 8, which libjpeg does almost for free by dropping DCT coefficients (see scaled_resolution()).
+    void set_image(void const* data, size_t size, MjpegDecoding decoding, uint32_t scale_eighths = 8)
+    {
+        if (_has_read_header)
+            stop();
+        _data          = static_cast<unsigned char const*>(data);
+        _size          = size;
+        _decoding      = decoding;
+        _scale_eighths = scale_eighths;
+    }
+
+    [[nodiscard]] auto data() const -> unsigned char const* { return _data; }
+    [[nodiscard]] auto size() const -> size_t { return _size; }
+    [[nodiscard]] auto decoding() const -> MjpegDecoding { return _decoding; }
+    [[nodiscard]] auto scale_eighths() const -> uint32_t { return _scale_eighths; }
+
+    /// Reads the header of the JPEG (only once until stop() is called), e.g. to know how its chroma is subsampled before choosing how to decode it
+    auto header() -> jpeg_decompress_struct const&
+    {
+        if (!_has_read_header)
+        {
+            call([&] {
+                jpeg_mem_src(&_info, _data, _size);
+                jpeg_read_header(&_info, TRUE); // Also resets all the decompression parameters to their defaults
+            });
+            _info.scale_num   = _scale_eighths;
+            _info.scale_denom = 8;
+            if (_decoding == MjpegDecoding::Speed)
+            {
+                _info.dct_method          = JDCT_IFAST;
+                _info.do_fancy_upsampling = FALSE; // Also lets libjpeg-turbo upsample and convert the colors of 4:2:0 images in a single pass
+            }
+            _has_read_header = true;
+        }
+        return _info;
+    }
+
+    /// The resolution of the decoded image, which is smaller than the one of the JPEG when it is scaled
+    auto output_resolution() -> Resolution
+    {
+        header();
+        call([&] { jpeg_calc_output_dimensions(&_info); });
+        return Resolution{_info.output_width, _info.output_height};
+    }
+
+    /// Reads the header of the JPEG, and starts decoding it to `color_space`
+    auto start(J_COLOR_SPACE color_space) -> jpeg_decompress_struct&
+    {
+        header();
+        _info.out_color_space = color_space;
+        call([&] { jpeg_start_decompress(&_info); });
+        return _info;
+    }
+
+    /// Reads the header of the JPEG, and starts decoding its Y, Cb and Cr planes as they are stored (see jpeg_read_raw_data()), if has_raw_planes().
+    /// Otherwise, returns nullptr without starting to decode.
+    auto start_raw() -> jpeg_decompress_struct*
+    {
+        if (!has_raw_planes())
+            return nullptr;
+        _info.raw_data_out = TRUE;
+        call([&] { jpeg_start_decompress(&_info); });
+        return &_info;
+    }
+
+    /// True iff the JPEG is made of Y, Cb and Cr planes, whose decoded chroma is subsampled by 1 or 2 in each direction (e.g. 4:4:4, 4:2:2 or 4:2:0, which covers all the webcams we know of)
+    auto has_raw_planes() -> bool
+    {
+        auto const& info = header();
+        if (info.num_components != 3 || info.jpeg_color_space != JCS_YCbCr)
+            return false;
+        for (int i = 1; i < 3; ++i)
+        {
+            auto const& chroma = info.comp_info[i]; // NOLINT(*pointer-arithmetic)
+            if (chroma.h_samp_factor != 1 || chroma.v_samp_factor != 1)
+                return false;
+        }
+        auto const subsampling = chroma_subsampling();
+        return (subsampling.horizontal == 1 || subsampling.horizontal == 2)
+               && (subsampling.vertical == 1 || subsampling.vertical == 2);
+    }
+
+    /// The subsampling of the chroma (of Cb, which is the same as Cr in all the JPEGs that has_raw_planes()) once it is decoded.
+    /// Must be called before start() or start_raw().
+    /// It isn't given by the sampling factors alone, because libjpeg can decode the chroma with bigger blocks than the luma when it scales the image: e.g. a 4:2:0 JPEG decoded at 4/8 has as many samples of chroma as pixels.
+    auto chroma_subsampling() -> ChromaSubsampling
+    {
+        output_resolution(); // Computes the sizes of the decoded blocks
+        if (_info.num_components != 3)
+            return {};
+        auto const& luma          = _info.comp_info[0]; // NOLINT(*pointer-arithmetic)
+        auto const& chroma        = _info.comp_info[1]; // NOLINT(*pointer-arithmetic)
+        auto const  luma_width    = static_cast<uint32_t>(luma.h_samp_factor) * block_size(luma);
+        auto const  luma_height   = static_cast<uint32_t>(luma.v_samp_factor) * block_size(luma);
+        auto const  chroma_width  = static_cast<uint32_t>(chroma.h_samp_factor) * block_size(chroma);
+        auto const  chroma_height = static_cast<uint32_t>(chroma.v_samp_factor) * block_size(chroma);
+        return ChromaSubsampling{
+            .horizontal = luma_width % chroma_width == 0 ? luma_width / chroma_width : 0,
+            .vertical   = luma_height % chroma_height == 0 ? luma_height / chroma_height : 0,
+        };
+    }
+
+    /// Once decoding has started, only decodes the columns from `x` to `x + width` (see jpeg_crop_scanline(), which moves `x` to the start of a block, and widens the rows accordingly)
+    void crop_rows(JDIMENSION& x, JDIMENSION& width)
+    {
+        call([&] { jpeg_crop_scanline(&_info, &x, &width); });
+    }
+    /// Decodes the next rows in `rows`, and returns how many it has decoded, which can be less than `count`
+    auto read_rows(JSAMPARRAY rows, JDIMENSION count) -> JDIMENSION
+    {
+        return call([&] { return jpeg_read_scanlines(&_info, rows, count); });
+    }
+    /// Skips the next `count` rows, without upsampling nor converting their colors
+    void skip_rows(JDIMENSION count)
+    {
+        call([&] { jpeg_skip_scanlines(&_info, count); });
+    }
+    /// Decodes the next `count` rows of the Y, Cb and Cr planes, once start_raw() has been called
+    void read_raw_rows(JSAMPIMAGE planes, JDIMENSION count)
+    {
+        call([&] { jpeg_read_raw_data(&_info, planes, count); });
+    }
+
+    /// Stops decoding the current JPEG, so that start() can be called again.
+    /// It doesn't need all the rows to have been decoded: nobody needs the ones below the region of interest, nor the markers after the last row.
+    void stop()
+    {
+        jpeg_abort_decompress(&_info);
+        _has_read_header = false;
+    }
+
+private:
+    /// libjpeg's error manager, with what error_exit() needs to get back to call()
+    struct ErrorManager : jpeg_error_mgr {
+        std::jmp_buf                       jump_buffer; // NOLINT(*member-init)
+        std::array<char, JMSG_LENGTH_MAX> message{};
+    };
+
+    /// Calls the libjpeg functions of `function`, and throws a JpegError if they fail.
+    /// We can't throw from error_exit(): the exception would have to go through the functions of libjpeg, which is C code that isn't always built with unwind tables (and std::terminate() would be called).
+    /// So error_exit() jumps back here instead, which is fine because neither this function nor `function` have objects with destructors that the jump would skip.
+    template<typename Function>
+    auto call(Function const& function) -> decltype(function())
+    {
+        if (setjmp(_err.jump_buffer) != 0) // NOLINT(*avoid-setjmp-longjmp)
+            throw_error();
+        return function();
+    }
+
+    /// Stops decoding, so that the decoder can be used again for the next images, and throws a JpegError with the message of the error
+    [[noreturn]] void throw_error()
+    {
+        stop();
+        throw JpegError{_err.message.data()};
+    }
+
+    /// Called by libjpeg instead of its default behaviour, which is to exit() the application
+    [[noreturn]] static void error_exit(j_common_ptr info)
+    {
+        auto& error = *static_cast<ErrorManager*>(info->err);
+        (*error.format_message)(info, error.message.data());
+        std::longjmp(error.jump_buffer, 1); // NOLINT(*avoid-setjmp-longjmp)
+    }
+
+private:
+    struct jpeg_decompress_struct _info; // NOLINT(*member-init)
+    ErrorManager                  _err;  // NOLINT(*member-init)
+    unsigned char const*          _data{};
+    size_t                        _size{};
+    MjpegDecoding                 _decoding{};
+    uint32_t                      _scale_eighths{8};
+    bool                          _has_read_header{};
+};
+
+} // namespace wcam::internal
+
+#endif
\ No newline at end of file
@@ -0,0 +1,190 @@
+#include "JpegSlices.hpp"
+#include <algorithm>
+#include <cstring>
+
+namespace wcam::internal {
+
+// The markers that we need to know about (see the JPEG spec, table B.1)
+static constexpr uint8_t marker_prefix{0xFF};
+static constexpr uint8_t baseline_start_of_frame{0xC0};
+static constexpr uint8_t extended_start_of_frame{0xC1};
+static constexpr uint8_t define_huffman_tables{0xC4};
+static constexpr uint8_t define_arithmetic_conditioning{0xCC};
+static constexpr uint8_t last_start_of_frame{0xCF};
+static constexpr uint8_t first_restart{0xD0};
+static constexpr uint8_t last_restart{0xD7};
+static constexpr uint8_t start_of_image{0xD8};
+static constexpr uint8_t end_of_image{0xD9};
+static constexpr uint8_t start_of_scan{0xDA};
+static constexpr uint8_t define_restart_interval{0xDD};
+
+static auto read_u16(uint8_t const* data) -> uint32_t
+{
+    return static_cast<uint32_t>(data[0] << 8 | data[1]); // NOLINT(*pointer-arithmetic)
+}
+
+static auto is_restart(uint8_t marker) -> bool
+{
+    return marker >= first_restart && marker <= last_restart;
+}
+
+JpegSlices::JpegSlices(uint8_t const* data, size_t size, uint32_t min_rows)
+    : _data{data}
+{
+    if (!read_headers(size))
+        return;
+    find_slices(size, min_rows);
+    if (_slices.size() < 2)
+        _slices.clear();
+}
+
+auto JpegSlices::read_headers(size_t size) -> bool
+{
+    if (size < 4 || _data[0] != marker_prefix || _data[1] != start_of_image) // NOLINT(*pointer-arithmetic)
+        return false;
+    uint32_t components_count = 0;
+    for (size_t pos = 2; pos + 4 <= size;)
+    {
+        uint8_t const* const marker = _data + pos; // NOLINT(*pointer-arithmetic)
+        uint8_t const        type   = marker[1];   // NOLINT(*pointer-arithmetic)
+        if (marker[0] != marker_prefix)
+            return false;
+        if (type == marker_prefix) // Fill byte
+        {
+            pos++;
+            continue;
+        }
+        // Those markers have no segment, and don't belong before the scan
+        if (is_restart(type) || type == start_of_image || type == end_of_image)
+            return false;
+        auto const           length  = read_u16(marker + 2); // NOLINT(*pointer-arithmetic)
+        uint8_t const* const segment = marker + 4;           // NOLINT(*pointer-arithmetic)
+        if (length < 2 || pos + 2 + length > size)
+            return false;
+
+        if (type == baseline_start_of_frame || type == extended_start_of_frame)
+        {
+            components_count = length >= 8 ? segment[5] : 0; // NOLINT(*pointer-arithmetic)
+            if (components_count == 0 || length < 8 + 3 * components_count)
+                return false;
+            _height_offset = pos + 5;
+            _height        = read_u16(segment + 1); // NOLINT(*pointer-arithmetic)
+            _width         = read_u16(segment + 3); // NOLINT(*pointer-arithmetic)
+            uint32_t max_h_samp_factor = 1;
+            uint32_t max_v_samp_factor = 1;
+            for (uint32_t i = 0; i < components_count; ++i)
+            {
+                uint8_t const samp_factors = segment[6 + 3 * i + 1]; // NOLINT(*pointer-arithmetic)
+                max_h_samp_factor          = std::max(max_h_samp_factor, static_cast<uint32_t>(samp_factors >> 4));
+                max_v_samp_factor          = std::max(max_v_samp_factor, static_cast<uint32_t>(samp_factors & 0xF));
+            }
+            // A scan with a single component is not interleaved, so its MCUs are single blocks
+            _mcu_width  = components_count == 1 ? 8 : 8 * max_h_samp_factor;
+            _mcu_height = components_count == 1 ? 8 : 8 * max_v_samp_factor;
+        }
+        else if (type > extended_start_of_frame && type <= last_start_of_frame && type != define_huffman_tables && type != define_arithmetic_conditioning)
+        {
+            return false; // Progressive, lossless or arithmetic-coded JPEGs, whose data we don't know how to split
+        }
+        else if (type == define_restart_interval)
+        {
+            _restart_interval = length >= 4 ? read_u16(segment) : 0;
+        }
+        else if (type == start_of_scan)
+        {
+            // When the first scan doesn't have all the components, there are other scans after it
+            if (components_count == 0 || segment[0] != components_count) // NOLINT(*pointer-arithmetic)
+                return false;
+            _headers_size = pos + 2 + length;
+            break;
+        }
+        pos += 2 + length;
+    }
+    // A height of 0 means that it is given after the scan (DNL marker)
+    return _headers_size != 0 && _restart_interval != 0 && _width != 0 && _height != 0;
+}
+
+void JpegSlices::find_slices(size_t size, uint32_t min_rows)
+{
+    uint32_t const mcus_per_row    = (_width + _mcu_width - 1) / _mcu_width;
+    uint32_t const mcu_rows_count  = (_height + _mcu_height - 1) / _mcu_height;
+    uint64_t       restarts_count  = 0;
+    uint32_t       first_mcu_row   = 0;
+    size_t         slice_begin     = _headers_size;
+    size_t         pos             = _headers_size;
+    size_t         end_of_the_data = size;
+    while (pos + 1 < size)
+    {
+        auto const* const found = static_cast<uint8_t const*>(std::memchr(_data + pos, marker_prefix, size - pos)); // NOLINT(*pointer-arithmetic)
+        if (!found)
+            break;
+        pos = static_cast<size_t>(found - _data);
+        if (pos + 1 >= size)
+            break;
+        uint8_t const marker = _data[pos + 1]; // NOLINT(*pointer-arithmetic)
+        if (marker == 0x00)                    // A 0xFF byte of the data, that is followed by a 0 so that it isn't read as a marker
+        {
+            pos += 2;
+            continue;
+        }
+        if (marker == marker_prefix) // Fill byte
+        {
+            pos++;
+            continue;
+        }
+        if (!is_restart(marker))
+        {
+            end_of_the_data = pos; // Usually the end of image marker
+            break;
+        }
+        restarts_count++;
+        auto const mcus_before = restarts_count * _restart_interval;
+        auto const mcu_row     = static_cast<uint32_t>(mcus_before / mcus_per_row);
+        if (mcus_before % mcus_per_row == 0 && mcu_row < mcu_rows_count && (mcu_row - first_mcu_row) * _mcu_height >= min_rows)
+        {
+            _slices.push_back(Slice{slice_begin, pos, first_mcu_row * _mcu_height});
+            slice_begin   = pos + 2;
+            first_mcu_row = mcu_row;
+        }
+        pos += 2;
+    }
+    _slices.push_back(Slice{slice_begin, end_of_the_data, first_mcu_row * _mcu_height});
+}
+
+void JpegSlices::make_jpeg(uint32_t begin, uint32_t end, std::vector<uint8_t>& jpeg) const
+{
+    auto const& first_slice = _slices[begin];   // NOLINT(*constant-array-index)
+    auto const& last_slice  = _slices[end - 1]; // NOLINT(*constant-array-index)
+    auto const  data_size   = last_slice.end - first_slice.begin;
+    jpeg.resize(_headers_size + data_size + 2);
+
+    std::memcpy(jpeg.data(), _data, _headers_size);
+    auto const height        = first_row(end) - first_slice.first_row;
+    jpeg[_height_offset]     = static_cast<uint8_t>(height >> 8);
+    jpeg[_height_offset + 1] = static_cast<uint8_t>(height & 0xFF);
+
+    uint8_t* const data = jpeg.data() + _headers_size;       // NOLINT(*pointer-arithmetic)
+    std::memcpy(data, _data + first_slice.begin, data_size); // NOLINT(*pointer-arithmetic)
+    jpeg[_headers_size + data_size]     = marker_prefix;
+    jpeg[_headers_size + data_size + 1] = end_of_image;
+
+    // The decoder expects the restart markers of each scan to be numbered RST0, RST1, ..., RST7, RST0, ...
+    // The data ends with the end of image marker that we have just written, so there is always a byte after a 0xFF
+    uint32_t restarts_count = 0;
+    for (size_t pos = 0; pos < data_size;)
+    {
+        auto* const found = static_cast<uint8_t*>(std::memchr(data + pos, marker_prefix, data_size - pos)); // NOLINT(*pointer-arithmetic)
+        if (!found)
+            break;
+        pos = static_cast<size_t>(found - data) + 1;
+        if (is_restart(data[pos])) // NOLINT(*pointer-arithmetic)
+        {
+            data[pos] = static_cast<uint8_t>(first_restart + restarts_count % 8); // NOLINT(*pointer-arithmetic)
+            restarts_count++;
+        }
+        if (data[pos] != marker_prefix) // NOLINT(*pointer-arithmetic)
+            pos++;
+    }
+}
+
+} // namespace wcam::internal
\ No newline at end of file
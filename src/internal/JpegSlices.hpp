@@ -0,0 +1,48 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace wcam::internal {
+
+/// Splits a JPEG into horizontal slices that can be decoded independently (e.g. in parallel), at its restart markers.
+/// Many webcams put a restart marker (RSTn) every few blocks (see the DRI marker), and each of them resets the state of the entropy decoder,
+/// so the rows of blocks that start right after one of them can be decoded without the data before it.
+class JpegSlices {
+public:
+    /// Finds the slices of that JPEG, which must stay alive while they are used. Each slice has at least `min_rows` rows, except the last one.
+    /// There are no slices (count() is 0) if the JPEG has no restart markers at the start of its rows of blocks, or if it isn't a sequential (baseline) JPEG with a single scan.
+    JpegSlices(uint8_t const* data, size_t size, uint32_t min_rows);
+
+    [[nodiscard]] auto count() const -> uint32_t { return static_cast<uint32_t>(_slices.size()); }
+    /// The index, in the full image, of the first row of that slice (or the height of the image for the index count())
+    [[nodiscard]] auto first_row(uint32_t slice) const -> uint32_t { return slice < _slices.size() ? _slices[slice].first_row : _height; } // NOLINT(*constant-array-index)
+
+    /// Writes in `jpeg` a standalone JPEG made of the slices from `begin` to `end` (excluded): the headers of the full JPEG (with the height of those slices),
+    /// their data (with their restart markers renumbered from 0, as the decoder expects them), and an end marker.
+    void make_jpeg(uint32_t begin, uint32_t end, std::vector<uint8_t>& jpeg) const;
+
+private:
+    /// Returns false if we can't split this JPEG
+    auto read_headers(size_t size) -> bool;
+    void find_slices(size_t size, uint32_t min_rows);
+
+private:
+    struct Slice {
+        size_t   begin{};     // Offset of the data of the first row, right after a restart marker (or the headers)
+        size_t   end{};       // Offset of the restart marker that starts the next slice (or of the end of the data)
+        uint32_t first_row{}; // In the full image
+    };
+
+    uint8_t const*     _data;
+    size_t             _headers_size{};  // Everything up to the end of the start of scan (SOS) marker
+    size_t             _height_offset{}; // Where the height of the image is written in the start of frame (SOF) marker
+    uint32_t           _width{};
+    uint32_t           _height{};
+    uint32_t           _mcu_width{}; // The blocks of pixels that the data is made of (Minimum Coded Units)
+    uint32_t           _mcu_height{};
+    uint32_t           _restart_interval{}; // Number of MCUs between two restart markers
+    std::vector<Slice> _slices{};
+};
+
+} // namespace wcam::internal
\ No newline at end of file
@@ -0,0 +1,67 @@
+#pragma once
+#include <array>
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <optional>
+#include <utility>
+
+namespace wcam::internal {
+
+/// Hands the frames from one thread that produces them to one thread that consumes them.
+/// It holds at most `Capacity` frames: when it is full, push() drops the oldest one, because a late image is worth less than the latest one.
+template<typename T, size_t Capacity>
+class LatestFramesQueue {
+public:
+    /// Returns true iff the oldest frame had to be dropped to make room for that one
+    auto push(T frame) -> bool
+    {
+        auto dropped_frame = std::optional<T>{}; // Destroyed once the mutex is unlocked, because destroying a frame can have to lock other mutexes (e.g. to give a buffer back to the driver)
+        {
+            auto const lock = std::scoped_lock{_mutex};
+            if (_size == Capacity)
+            {
+                dropped_frame = std::move(_frames[_first]); // NOLINT(*constant-array-index)
+                _first        = (_first + 1) % Capacity;
+                _size--;
+            }
+            _frames[(_first + _size) % Capacity] = std::move(frame); // NOLINT(*constant-array-index)
+            _size++;
+        }
+        _condition.notify_one();
+        return dropped_frame.has_value();
+    }
+
+    /// Blocks until there is a frame, and removes the oldest one. Returns nullopt once close() has been called.
+    auto pop() -> std::optional<T>
+    {
+        auto lock = std::unique_lock{_mutex};
+        _condition.wait(lock, [&] { return _size != 0 || _is_closed; });
+        if (_is_closed)
+            return std::nullopt;
+        auto frame = std::move(_frames[_first]); // NOLINT(*constant-array-index)
+        _first     = (_first + 1) % Capacity;
+        _size--;
+        return frame;
+    }
+
+    /// Wakes up the consumer, and makes pop() return nullopt from now on
+    void close()
+    {
+        {
+            auto const lock = std::scoped_lock{_mutex};
+            _is_closed      = true;
+        }
+        _condition.notify_all();
+    }
+
+private:
+    std::mutex              _mutex{};
+    std::condition_variable _condition{};
+    std::array<T, Capacity> _frames{};
+    size_t                  _first{}; // Index of the oldest frame
+    size_t                  _size{};
+    bool                    _is_closed{false};
+};
+
+} // namespace wcam::internal
\ No newline at end of file
@@ -1,10 +1,17 @@
 #include "Manager.hpp"
 #include <mutex>
 #include <variant>
+#include "CapabilitiesCache.hpp"
+#include "ConversionPool.hpp"
 #include "WebcamRequest.hpp"
 
 namespace wcam::internal {
 
+Manager::Manager()
+{
+    conversion_pool(); // Make sure the pool is created before the Manager, so that it is destroyed after it, and after all the captures that use it
+}
+
 Manager::~Manager()
 {
     stop_thread_ifn();
@@ -25,6 +32,7 @@ void Manager::stop_thread_ifn()
         return;
 
     _wants_to_stop_thread.store(true);
+    _devices_watcher.wake_up();
     _thread->join();
     _thread.reset();
 }
@@ -54,29 +62,48 @@ void Manager::check_if_update_needs_to_continue()
     _infos_have_been_requested_this_frame.store(false);
 }
 
+/// How long we wait before trying again to start a capture that failed (e.g. because another application was using the webcam)
+static constexpr auto retry_delay = std::chrono::milliseconds{250};
+
 void Manager::thread_job(Manager& self)
 {
+    auto changes = DevicesChanges{.all_devices_might_have_changed = true}; // We don't know what happened while the thread was stopped
     while (!self._wants_to_stop_thread.load())
-        self.update();
+    {
+        bool const needs_retry = self.update(changes);
+        changes                = self._devices_watcher.wait_for_changes(needs_retry ? std::make_optional(retry_delay) : std::nullopt); // Sleep until something actually happens, instead of enumerating all the devices again and again
+    }
 }
 
 auto grab_all_infos_impl() -> std::vector<Info>;
+auto grab_info_impl(DeviceId const& id) -> std::optional<Info>;
+
+static void sort_resolutions(Info& webcam_info)
+{
+    auto& resolutions = webcam_info.resolutions;
+    std::sort(resolutions.begin(), resolutions.end(), [](Resolution const& res_a, Resolution const& res_b) {
+        return res_a.pixels_count() > res_b.pixels_count()
+               || (res_a.pixels_count() == res_b.pixels_count() && res_a.width() > res_b.width());
+    });
+    resolutions.erase(std::unique(resolutions.begin(), resolutions.end()), resolutions.end());
+}
 
 static auto grab_all_infos() -> std::vector<Info>
 {
     auto list_webcams_infos = internal::grab_all_infos_impl();
     for (auto& webcam_info : list_webcams_infos)
-    {
-        auto& resolutions = webcam_info.resolutions;
-        std::sort(resolutions.begin(), resolutions.end(), [](Resolution const& res_a, Resolution const& res_b) {
-            return res_a.pixels_count() > res_b.pixels_count()
-                   || (res_a.pixels_count() == res_b.pixels_count() && res_a.width() > res_b.width());
-        });
-        resolutions.erase(std::unique(resolutions.begin(), resolutions.end()), resolutions.end());
-    }
+        sort_resolutions(webcam_info);
     return list_webcams_infos;
 }
 
+static auto grab_info(DeviceId const& id) -> std::optional<Info>
+{
+    auto webcam_info = internal::grab_info_impl(id);
+    if (webcam_info.has_value())
+        sort_resolutions(*webcam_info);
+    return webcam_info;
+}
+
 auto Manager::infos() const -> std::vector<Info>
 {
     _infos_have_been_requested_this_frame.store(true);
@@ -98,6 +125,7 @@ auto Manager::open_or_get_webcam(DeviceId const& id) -> SharedWebcam
     }
     auto const request    = std::make_shared<WebcamRequest>(id);
     _current_requests[id] = request; // Store a weak_ptr in the current requests
+    _devices_watcher.wake_up();      // Start the capture as soon as possible
     return SharedWebcam{request};
 }
 
@@ -113,6 +141,7 @@ void Manager::request_a_restart_of_the_capture_if_it_exists(DeviceId const& id)
     if (!request)
         return;
     request->maybe_capture() = CaptureNotInitYet{};
+    _devices_watcher.wake_up(); // Restart the capture as soon as possible
 }
 
 auto Manager::default_resolution(DeviceId const& id) const -> Resolution
@@ -145,16 +174,39 @@ auto Manager::is_plugged_in(DeviceId const& id) const -> bool
            });
 }
 
-/// Iterates over the map + might modify an element of the map
-void Manager::update()
+void Manager::update_infos(DevicesChanges const& changes)
 {
+    if (changes.all_devices_might_have_changed)
     {
         auto infos = grab_all_infos();
+        {
+            std::scoped_lock lock{_infos_mutex};
+            _infos = std::move(infos);
+        }
+        capabilities_cache().save(); // Once for all the devices that have been enumerated
+        return;
+    }
+
+    for (auto const& id : changes.devices_that_changed) // Only enumerate the devices that have actually been plugged in or unplugged
+    {
+        auto webcam_info = grab_info(id);
 
         std::scoped_lock lock{_infos_mutex};
-        _infos = std::move(infos);
+        std::erase_if(_infos, [&](Info const& info) {
+            return info.id == id;
+        });
+        if (webcam_info.has_value())
+            _infos.push_back(std::move(*webcam_info));
     }
+    capabilities_cache().save(); // Once for all the devices that have been enumerated
+}
+
+/// Iterates over the map + might modify an element of the map
+auto Manager::update(DevicesChanges const& changes) -> bool
+{
+    update_infos(changes);
 
+    bool needs_retry{false};
     {
         auto const current_requests = [&]() { // IIFE
             std::scoped_lock lock{_captures_mutex};
@@ -176,14 +228,16 @@ void Manager::update()
             // Otherwise, the webcam is plugged in but the capture is not valid, so we should try to (re)create it
             try
             {
-                request->maybe_capture() = Capture{request->id(), selected_resolution(request->id())};
+                request->maybe_capture() = Capture{request->id(), selected_resolution(request->id()), request->settings()};
             }
             catch (CaptureException const& e)
             {
                 request->maybe_capture() = e.capture_error;
+                needs_retry              = true;
             }
         }
     }
+    return needs_retry;
 }
 
 auto Manager::selected_resolution(DeviceId const& id) const -> Resolution
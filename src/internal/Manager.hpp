@@ -9,13 +9,14 @@
 #include "../Resolution.hpp"
 #include "../ResolutionsMap.hpp"
 #include "../SharedWebcam.hpp"
+#include "DevicesWatcher.hpp"
 #include "WebcamRequest.hpp"
 
 namespace wcam::internal {
 
 class Manager {
 public:
-    Manager() = default;
+    Manager();
     ~Manager();
     Manager(Manager const&)                        = delete;
     auto operator=(Manager const&) -> Manager&     = delete;
@@ -41,7 +42,9 @@ private:
     void start_thread_ifn();
     void stop_thread_ifn();
 
-    void        update();
+    /// Returns true iff some captures failed to start and we should retry them a bit later
+    auto        update(DevicesChanges const&) -> bool;
+    void        update_infos(DevicesChanges const&);
     static void thread_job(Manager& self);
 
 private:
@@ -53,6 +56,7 @@ private:
     std::atomic<bool>          _wants_to_stop_thread{false};
     mutable std::atomic<bool>  _infos_have_been_requested_this_frame{false};
     std::optional<std::thread> _thread{};
+    DevicesWatcher             _devices_watcher{};
 
     ResolutionsMap _selected_resolutions{};
 };
@@ -0,0 +1,62 @@
+#pragma once
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include "../FirstRowIs.hpp"
+#include "../Image.hpp"
+#include "../Resolution.hpp"
+#include "../YUVEncoding.hpp"
+#include "BufferPool.hpp"
+
+namespace wcam::internal {
+
+/// The buffer where an image that we give to an Image is written: the one that the Image provides (see Image::destination_buffer()), or else one of the BufferPool that we share with it
+template<typename PixelFormatT>
+class OutputBuffer {
+public:
+    using Planes = typename PixelFormatT::Planes;
+
+    /// `resolution` is the one of the image that will be written, after the Orientation and the resize have been applied
+    OutputBuffer(Image& image, Resolution resolution)
+        : _resolution{resolution}
+    {
+        if (auto const buffer = image.destination_buffer(PixelFormatT{}, resolution))
+        {
+            assert(buffer->data);
+            _data   = buffer->data;
+            _planes = buffer->planes;
+        }
+        else
+        {
+            _allocated = buffer_pool().get(PixelFormatT::data_length(resolution));
+            _data      = _allocated.get();
+            _planes    = PixelFormatT::packed_planes(resolution);
+        }
+    }
+
+    [[nodiscard]] auto data() const -> uint8_t* { return _data; }
+    [[nodiscard]] auto planes() const -> Planes const& { return _planes; }
+    /// Where the first row of that plane starts
+    [[nodiscard]] auto plane(size_t index) const -> uint8_t* { return _data + _planes[index].offset; } // NOLINT(*pointer-arithmetic, *constant-array-index)
+    [[nodiscard]] auto stride(size_t index) const -> size_t { return _planes[index].stride; }          // NOLINT(*constant-array-index)
+
+    /// Gives the image that has been written to the buffer to the Image
+    void set_data(Image& image, FirstRowIs row_order, YUVEncoding yuv_encoding = {})
+    {
+        auto const length = PixelFormatT::data_length(_resolution, _planes);
+        if (_allocated)
+            image.set_data(ImageDataView<PixelFormatT>{std::move(_allocated), length, _resolution, row_order, _planes, yuv_encoding});
+        else
+            image.set_data(ImageDataView<PixelFormatT>{static_cast<uint8_t const*>(_data), length, _resolution, row_order, _planes, yuv_encoding});
+    }
+
+private:
+    uint8_t*                 _data{};
+    Planes                   _planes{};
+    Resolution               _resolution{};
+    std::shared_ptr<uint8_t> _allocated{}; // Only if the Image doesn't provide its own buffer
+};
+
+} // namespace wcam::internal
\ No newline at end of file
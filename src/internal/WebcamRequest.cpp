@@ -21,4 +21,11 @@ auto WebcamRequest::image() const -> MaybeImage
     );
 }
 
+auto WebcamRequest::dropped_frames() const -> DroppedFrames
+{
+    if (auto const* const capture = std::get_if<Capture>(&_maybe_capture))
+        return capture->dropped_frames();
+    return DroppedFrames{};
+}
+
 } // namespace wcam::internal
\ No newline at end of file
@@ -1,7 +1,9 @@
 #pragma once
+#include <memory>
 #include <variant>
 #include "../DeviceId.hpp"
 #include "Capture.hpp"
+#include "CaptureSettings.hpp"
 
 namespace wcam::internal {
 
@@ -15,13 +17,18 @@ public:
     {}
 
     [[nodiscard]] auto image() const -> MaybeImage;
+    /// All zeros when there is no capture
+    [[nodiscard]] auto dropped_frames() const -> DroppedFrames;
 
     [[nodiscard]] auto id() const -> DeviceId const& { return _id; }
     [[nodiscard]] auto maybe_capture() -> MaybeCapture& { return _maybe_capture; }
+    /// Shared with the Capture, which reads them from its capture thread
+    [[nodiscard]] auto settings() const -> std::shared_ptr<CaptureSettings> const& { return _settings; }
 
 private:
-    DeviceId             _id;
-    mutable MaybeCapture _maybe_capture{CaptureNotInitYet{}};
+    DeviceId                         _id;
+    mutable MaybeCapture             _maybe_capture{CaptureNotInitYet{}};
+    std::shared_ptr<CaptureSettings> _settings{std::make_shared<CaptureSettings>()};
 };
 
 } // namespace wcam::internal
\ No newline at end of file
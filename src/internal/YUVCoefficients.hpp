@@ -0,0 +1,55 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include "../YUVEncoding.hpp"
+
+namespace wcam::internal {
+
+/// Fixed-point coefficients (with 8 fractional bits) of the conversion from YUV to RGB.
+/// Each channel is computed as (y * (Y - y_offset) + u_coef * (U - 128) + v_coef * (V - 128) + 128) >> 8,
+/// so that all the conversions (scalar and SIMD, YUYV and NV12) share the exact same maths.
+struct YUVCoefficients {
+    int16_t y_offset{};
+    int16_t y{};
+    int16_t r_v{};
+    int16_t g_u{};
+    int16_t g_v{};
+    int16_t b_u{};
+};
+
+constexpr auto fixed_point(double x) -> int16_t
+{
+    return static_cast<int16_t>(x >= 0. ? x * 256. + 0.5 : x * 256. - 0.5);
+}
+
+/// `kr` and `kb` are the weights of red and blue in the luma
+constexpr auto make_yuv_coefficients(double kr, double kb, YUVRange range) -> YUVCoefficients
+{
+    double const kg           = 1. - kr - kb;
+    double const luma_scale   = range == YUVRange::Full ? 1. : 255. / 219.;
+    double const chroma_scale = range == YUVRange::Full ? 1. : 255. / 224.;
+    return YUVCoefficients{
+        .y_offset = static_cast<int16_t>(range == YUVRange::Full ? 0 : 16),
+        .y        = fixed_point(luma_scale),
+        .r_v      = fixed_point(chroma_scale * 2. * (1. - kr)),
+        .g_u      = fixed_point(-chroma_scale * 2. * (1. - kb) * kb / kg),
+        .g_v      = fixed_point(-chroma_scale * 2. * (1. - kr) * kr / kg),
+        .b_u      = fixed_point(chroma_scale * 2. * (1. - kb)),
+    };
+}
+
+/// The coefficients are computed at compile time, once for each encoding
+inline auto yuv_coefficients(YUVEncoding encoding) -> YUVCoefficients const&
+{
+    static constexpr auto all_coefficients = std::array{
+        // Indexed by 2 * matrix + range
+        make_yuv_coefficients(0.299, 0.114, YUVRange::Limited),
+        make_yuv_coefficients(0.299, 0.114, YUVRange::Full),
+        make_yuv_coefficients(0.2126, 0.0722, YUVRange::Limited),
+        make_yuv_coefficients(0.2126, 0.0722, YUVRange::Full),
+    };
+    return all_coefficients[2 * static_cast<size_t>(encoding.matrix) + static_cast<size_t>(encoding.range)]; // NOLINT(*constant-array-index)
+}
+
+} // namespace wcam::internal
\ No newline at end of file
@@ -0,0 +1,470 @@
+#include "conversions.hpp"
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <vector>
+#include "ConversionPool.hpp"
+#include "row_conversions.hpp"
+
+namespace wcam::internal {
+
+/// A row that the current thread can use to convert a row that can't be written directly to its destination. It is small enough to stay in the cache.
+static auto scratch_row(size_t index, size_t length) -> uint8_t*
+{
+    thread_local auto rows = std::array<std::vector<uint8_t>, 4>{};
+    rows[index].resize(length); // NOLINT(*constant-array-index)
+    return rows[index].data();  // NOLINT(*constant-array-index)
+}
+
+static auto scratch_row(size_t index, Destination const& destination) -> uint8_t*
+{
+    return scratch_row(index, static_cast<size_t>(destination.source_width()) * destination.bytes_per_pixel());
+}
+
+/// Calls `convert_row(y, destination_row)` for all the rows of the source image, possibly in parallel, and puts the results in the destination
+template<typename ConvertRow>
+static void convert_rows(Destination const& destination, uint32_t height, ConvertRow const& convert_row)
+{
+    conversion_pool().convert(height, destination.source_width() * destination.bytes_per_pixel(), 1, [&](uint32_t begin, uint32_t end) {
+        for (uint32_t y = begin; y < end; y++)
+        {
+            if (uint8_t* const row = destination.direct_row(y))
+            {
+                convert_row(y, row);
+            }
+            else
+            {
+                uint8_t* const scratch = scratch_row(0, destination);
+                convert_row(y, scratch);
+                destination.write_row(y, scratch);
+            }
+        }
+    });
+}
+
+/// Copies the first plane, e.g. the Y plane of NV12 to GREY8
+template<typename PixelFormatT>
+static void copy(ImageDataView<PixelFormatT> const& data, Destination const& destination)
+{
+    auto const     row_length = static_cast<size_t>(data.resolution().width()) * destination.bytes_per_pixel();
+    uint8_t const* source     = data.plane(0);
+    auto const     stride     = data.stride(0);
+    conversion_pool().convert(data.resolution().height(), row_length, 1, [&](uint32_t begin, uint32_t end) {
+        for (uint32_t y = begin; y < end; y++)
+        {
+            uint8_t const* const row = source + y * stride; // NOLINT(*pointer-arithmetic)
+            if (uint8_t* const destination_row = destination.direct_row(y))
+                std::memcpy(destination_row, row, row_length);
+            else
+                destination.write_row(y, row);
+        }
+    });
+}
+
+/// Converts between the RGB formats, or any format that has a single plane
+template<typename PixelFormatT>
+static void repack(ImageDataView<PixelFormatT> const& data, RGB_RowConversion conversion, Destination const& destination)
+{
+    auto const     width  = data.resolution().width();
+    uint8_t const* source = data.plane(0);
+    auto const     stride = data.stride(0);
+    convert_rows(destination, data.resolution().height(), [&](uint32_t y, uint8_t* row) {
+        conversion(source + y * stride, row, width); // NOLINT(*pointer-arithmetic)
+    });
+}
+
+static void YUYV_to(ImageDataView<YUYV> const& yuyv_data, YUYV_RowConversion conversion, Destination const& destination)
+{
+    auto const     width        = yuyv_data.resolution().width();
+    uint8_t const* yuyv         = yuyv_data.plane(0);
+    auto const     stride       = yuyv_data.stride(0);
+    auto const&    coefficients = yuv_coefficients(yuyv_data.yuv_encoding());
+    convert_rows(destination, yuyv_data.resolution().height(), [&](uint32_t y, uint8_t* row) {
+        conversion(yuyv + y * stride, row, width, coefficients); // NOLINT(*pointer-arithmetic)
+    });
+}
+
+/// Converts an image whose rows share their chroma two by two. `uv_row(y)` returns the (u, v) pairs of the rows `y` and `y + 1`.
+template<typename PixelFormatT, typename UVRow>
+static void YUV420_to(ImageDataView<PixelFormatT> const& data, NV12_RowConversion conversion, Destination const& destination, UVRow const& uv_row)
+{
+    auto const width  = static_cast<size_t>(data.resolution().width());
+    auto const height = data.resolution().height();
+
+    uint8_t const* const y_plane      = data.plane(0);
+    auto const           y_stride     = data.stride(0);
+    auto const&          coefficients = yuv_coefficients(data.yuv_encoding());
+
+    conversion_pool().convert(height, width * destination.bytes_per_pixel(), 2, [&](uint32_t begin, uint32_t end) {
+        for (uint32_t y = begin; y < end; y += 2)
+        {
+            auto const     y1   = std::min(y + 1, height - 1); // If the height is odd, the last row is converted twice
+            uint8_t* const row0 = destination.direct_row(y);
+            uint8_t* const row1 = destination.direct_row(y1);
+            conversion(
+                y_plane + y * y_stride, y_plane + y1 * y_stride, // NOLINT(*pointer-arithmetic)
+                uv_row(y),
+                row0 ? row0 : scratch_row(0, destination),
+                row1 ? row1 : scratch_row(1, destination),
+                data.resolution().width(),
+                coefficients
+            );
+            if (!row0)
+                destination.write_row(y, scratch_row(0, destination));
+            if (!row1)
+                destination.write_row(y1, scratch_row(1, destination));
+        }
+    });
+}
+
+static void NV12_to(ImageDataView<NV12> const& nv12_data, NV12_RowConversion conversion, Destination const& destination)
+{
+    uint8_t const* const uv_plane  = nv12_data.plane(1);
+    auto const           uv_stride = nv12_data.stride(1);
+    YUV420_to(nv12_data, conversion, destination, [&](uint32_t y) {
+        return uv_plane + (y / 2) * uv_stride; // NOLINT(*pointer-arithmetic)
+    });
+}
+
+/// Interleaves the u and v samples in a scratch row, and then uses the conversion of NV12
+static void I420_to(ImageDataView<I420> const& i420_data, NV12_RowConversion conversion, Destination const& destination)
+{
+    uint8_t const* const u_plane      = i420_data.plane(1);
+    uint8_t const* const v_plane      = i420_data.plane(2);
+    auto const           u_stride     = i420_data.stride(1);
+    auto const           v_stride     = i420_data.stride(2);
+    auto const           chroma_width = (i420_data.resolution().width() + 1) / 2;
+    YUV420_to(i420_data, conversion, destination, [&](uint32_t y) {
+        uint8_t* const uv = scratch_row(2, size_t{chroma_width} * 2);
+        row_conversions().merge_chroma(u_plane + (y / 2) * u_stride, v_plane + (y / 2) * v_stride, uv, chroma_width); // NOLINT(*pointer-arithmetic)
+        return uv;
+    });
+}
+
+/// Interleaves the planes of each row in a scratch row of YUYV (which has the same chroma as I422), and then uses the conversion of YUYV
+static void I422_to(ImageDataView<I422> const& i422_data, YUYV_RowConversion conversion, Destination const& destination)
+{
+    uint8_t const* const y_plane      = i422_data.plane(0);
+    uint8_t const* const u_plane      = i422_data.plane(1);
+    uint8_t const* const v_plane      = i422_data.plane(2);
+    auto const           y_stride     = i422_data.stride(0);
+    auto const           u_stride     = i422_data.stride(1);
+    auto const           v_stride     = i422_data.stride(2);
+    auto const           width        = i422_data.resolution().width();
+    auto const           even_width   = (width + 1) / 2 * 2; // The conversions of YUYV only convert pairs of pixels
+    auto const&          coefficients = yuv_coefficients(i422_data.yuv_encoding());
+    convert_rows(destination, i422_data.resolution().height(), [&](uint32_t y, uint8_t* row) {
+        uint8_t* const yuyv = scratch_row(2, size_t{even_width} * 2);
+        row_conversions().merge_to_YUYV(y_plane + y * y_stride, u_plane + y * u_stride, v_plane + y * v_stride, yuyv, width); // NOLINT(*pointer-arithmetic)
+        if (even_width == width)
+        {
+            conversion(yuyv, row, width, coefficients);
+        }
+        else
+        {
+            // The row doesn't have room for the extra pixel
+            uint8_t* const padded_row = scratch_row(3, size_t{even_width} * destination.bytes_per_pixel());
+            conversion(yuyv, padded_row, even_width, coefficients);
+            std::memcpy(row, padded_row, size_t{width} * destination.bytes_per_pixel());
+        }
+    });
+}
+
+/// Calls `convert_rows(y, y1, rows)` for each pair of rows of the source image (with y1 == y for the last row of an odd height), possibly in parallel.
+/// It must write the rows y and y1 of Y to rows[0] and rows[1], and the chroma that they share to rows[2] (the (u, v) pairs of NV12, or the u of I420) and rows[3] (the v of I420).
+/// Those rows are then put in the destination.
+template<typename ConvertRows>
+static void convert_row_pairs(YUV420Destination const& destination, uint32_t height, ConvertRows const& convert_rows)
+{
+    auto const& luma         = destination.luma();
+    auto const  rows_count   = destination.has_interleaved_chroma() ? size_t{3} : size_t{4};
+    auto const  destinations = std::array<Destination const*, 4>{&luma, &luma, &destination.chroma(0), &destination.chroma(1)};
+    conversion_pool().convert(height, static_cast<size_t>(luma.source_width()) * 3 / 2, 2, [&](uint32_t begin, uint32_t end) {
+        for (uint32_t y = begin; y < end; y += 2)
+        {
+            auto const y1          = std::min(y + 1, height - 1);
+            auto const source_rows = std::array<uint32_t, 4>{y, y1, y / 2, y / 2};
+            auto       rows        = std::array<uint8_t*, 4>{};
+            auto       is_scratch  = std::array<bool, 4>{};
+            for (size_t i = 0; i < rows_count; ++i)
+            {
+                rows[i]       = destinations[i]->direct_row(source_rows[i]); // NOLINT(*constant-array-index)
+                is_scratch[i] = rows[i] == nullptr;                          // NOLINT(*constant-array-index)
+                if (is_scratch[i])                                           // NOLINT(*constant-array-index)
+                    rows[i] = scratch_row(i, *destinations[i]);              // NOLINT(*constant-array-index)
+            }
+            convert_rows(y, y1, rows);
+            for (size_t i = 0; i < rows_count; ++i)
+            {
+                if (is_scratch[i])                                       // NOLINT(*constant-array-index)
+                    destinations[i]->write_row(source_rows[i], rows[i]); // NOLINT(*constant-array-index)
+            }
+        }
+    });
+}
+
+/// Copies the rows y and y1 of the Y plane of NV12 or I420
+template<typename PixelFormatT>
+static void copy_luma(ImageDataView<PixelFormatT> const& data, uint32_t y, uint32_t y1, std::array<uint8_t*, 4> const& rows)
+{
+    std::memcpy(rows[0], data.plane(0) + y * data.stride(0), data.resolution().width());  // NOLINT(*pointer-arithmetic)
+    std::memcpy(rows[1], data.plane(0) + y1 * data.stride(0), data.resolution().width()); // NOLINT(*pointer-arithmetic)
+}
+
+void convert(ImageDataView<RGB24> const& data, RGB24, Destination const& destination)
+{
+    copy(data, destination);
+}
+
+void convert(ImageDataView<RGB24> const& data, BGR24, Destination const& destination)
+{
+    repack(data, row_conversions().swap_red_and_blue, destination);
+}
+
+void convert(ImageDataView<RGB24> const& data, RGBA32, Destination const& destination)
+{
+    repack(data, row_conversions().add_alpha, destination);
+}
+
+void convert(ImageDataView<RGB24> const& data, BGRA32, Destination const& destination)
+{
+    repack(data, row_conversions().add_alpha_and_swap_red_and_blue, destination);
+}
+
+void convert(ImageDataView<RGB24> const& data, GREY8, Destination const& destination)
+{
+    repack(data, row_conversions().RGB24_to_GREY8, destination);
+}
+
+void convert(ImageDataView<BGR24> const& data, RGB24, Destination const& destination)
+{
+    repack(data, row_conversions().swap_red_and_blue, destination);
+}
+
+void convert(ImageDataView<BGR24> const& data, BGR24, Destination const& destination)
+{
+    copy(data, destination);
+}
+
+void convert(ImageDataView<BGR24> const& data, RGBA32, Destination const& destination)
+{
+    repack(data, row_conversions().add_alpha_and_swap_red_and_blue, destination);
+}
+
+void convert(ImageDataView<BGR24> const& data, BGRA32, Destination const& destination)
+{
+    repack(data, row_conversions().add_alpha, destination);
+}
+
+void convert(ImageDataView<BGR24> const& data, GREY8, Destination const& destination)
+{
+    repack(data, row_conversions().BGR24_to_GREY8, destination);
+}
+
+void convert(ImageDataView<RGBA32> const& data, RGB24, Destination const& destination)
+{
+    repack(data, row_conversions().remove_alpha, destination);
+}
+
+void convert(ImageDataView<RGBA32> const& data, BGR24, Destination const& destination)
+{
+    repack(data, row_conversions().remove_alpha_and_swap_red_and_blue, destination);
+}
+
+void convert(ImageDataView<RGBA32> const& data, RGBA32, Destination const& destination)
+{
+    copy(data, destination);
+}
+
+void convert(ImageDataView<BGRA32> const& data, RGB24, Destination const& destination)
+{
+    repack(data, row_conversions().remove_alpha_and_swap_red_and_blue, destination);
+}
+
+void convert(ImageDataView<BGRA32> const& data, BGR24, Destination const& destination)
+{
+    repack(data, row_conversions().remove_alpha, destination);
+}
+
+void convert(ImageDataView<BGRA32> const& data, BGRA32, Destination const& destination)
+{
+    copy(data, destination);
+}
+
+void convert(ImageDataView<NV12> const& data, RGB24, Destination const& destination)
+{
+    NV12_to(data, row_conversions().NV12_to_RGB24, destination);
+}
+
+void convert(ImageDataView<NV12> const& data, BGR24, Destination const& destination)
+{
+    NV12_to(data, row_conversions().NV12_to_BGR24, destination);
+}
+
+void convert(ImageDataView<NV12> const& data, RGBA32, Destination const& destination)
+{
+    NV12_to(data, row_conversions().NV12_to_RGBA32, destination);
+}
+
+void convert(ImageDataView<NV12> const& data, BGRA32, Destination const& destination)
+{
+    NV12_to(data, row_conversions().NV12_to_BGRA32, destination);
+}
+
+void convert(ImageDataView<NV12> const& data, GREY8, Destination const& destination)
+{
+    copy(data, destination);
+}
+
+void convert(ImageDataView<I422> const& data, RGB24, Destination const& destination)
+{
+    I422_to(data, row_conversions().YUYV_to_RGB24, destination);
+}
+
+void convert(ImageDataView<YUYV> const& data, RGB24, Destination const& destination)
+{
+    YUYV_to(data, row_conversions().YUYV_to_RGB24, destination);
+}
+
+void convert(ImageDataView<YUYV> const& data, BGR24, Destination const& destination)
+{
+    YUYV_to(data, row_conversions().YUYV_to_BGR24, destination);
+}
+
+void convert(ImageDataView<YUYV> const& data, RGBA32, Destination const& destination)
+{
+    YUYV_to(data, row_conversions().YUYV_to_RGBA32, destination);
+}
+
+void convert(ImageDataView<YUYV> const& data, BGRA32, Destination const& destination)
+{
+    YUYV_to(data, row_conversions().YUYV_to_BGRA32, destination);
+}
+
+void convert(ImageDataView<YUYV> const& data, GREY8, Destination const& destination)
+{
+    repack(data, row_conversions().YUYV_to_GREY8, destination);
+}
+
+void convert(ImageDataView<YUYV> const& data, NV12, YUV420Destination const& destination)
+{
+    uint8_t const* const yuyv   = data.plane(0);
+    auto const           stride = data.stride(0);
+    convert_row_pairs(destination, data.resolution().height(), [&](uint32_t y, uint32_t y1, std::array<uint8_t*, 4> const& rows) {
+        row_conversions().YUYV_to_NV12(yuyv + y * stride, yuyv + y1 * stride, rows[0], rows[1], rows[2], data.resolution().width()); // NOLINT(*pointer-arithmetic)
+    });
+}
+
+void convert(ImageDataView<YUYV> const& data, I420, YUV420Destination const& destination)
+{
+    uint8_t const* const yuyv   = data.plane(0);
+    auto const           stride = data.stride(0);
+    convert_row_pairs(destination, data.resolution().height(), [&](uint32_t y, uint32_t y1, std::array<uint8_t*, 4> const& rows) {
+        row_conversions().YUYV_to_I420(yuyv + y * stride, yuyv + y1 * stride, rows[0], rows[1], rows[2], rows[3], data.resolution().width()); // NOLINT(*pointer-arithmetic)
+    });
+}
+
+void convert(ImageDataView<GREY8> const& data, RGB24, Destination const& destination)
+{
+    repack(data, row_conversions().GREY8_to_RGB24, destination);
+}
+
+void convert(ImageDataView<GREY8> const& data, BGR24, Destination const& destination)
+{
+    repack(data, row_conversions().GREY8_to_RGB24, destination);
+}
+
+void convert(ImageDataView<GREY8> const& data, RGBA32, Destination const& destination)
+{
+    repack(data, row_conversions().GREY8_to_RGBA32, destination);
+}
+
+void convert(ImageDataView<GREY8> const& data, BGRA32, Destination const& destination)
+{
+    repack(data, row_conversions().GREY8_to_RGBA32, destination);
+}
+
+void convert(ImageDataView<GREY8> const& data, GREY8, Destination const& destination)
+{
+    copy(data, destination);
+}
+
+void convert(ImageDataView<NV12> const& data, NV12, YUV420Destination const& destination)
+{
+    auto const chroma_length = (data.resolution().width() + size_t{1}) / 2 * 2;
+    convert_row_pairs(destination, data.resolution().height(), [&](uint32_t y, uint32_t y1, std::array<uint8_t*, 4> const& rows) {
+        copy_luma(data, y, y1, rows);
+        std::memcpy(rows[2], data.plane(1) + (y / 2) * data.stride(1), chroma_length); // NOLINT(*pointer-arithmetic)
+    });
+}
+
+void convert(ImageDataView<NV12> const& data, I420, YUV420Destination const& destination)
+{
+    auto const chroma_width = (data.resolution().width() + 1) / 2;
+    convert_row_pairs(destination, data.resolution().height(), [&](uint32_t y, uint32_t y1, std::array<uint8_t*, 4> const& rows) {
+        copy_luma(data, y, y1, rows);
+        row_conversions().split_chroma(data.plane(1) + (y / 2) * data.stride(1), rows[2], rows[3], chroma_width); // NOLINT(*pointer-arithmetic)
+    });
+}
+
+void convert(ImageDataView<I420> const& data, RGB24, Destination const& destination)
+{
+    I420_to(data, row_conversions().NV12_to_RGB24, destination);
+}
+
+void convert(ImageDataView<I420> const& data, BGR24, Destination const& destination)
+{
+    I420_to(data, row_conversions().NV12_to_BGR24, destination);
+}
+
+void convert(ImageDataView<I420> const& data, RGBA32, Destination const& destination)
+{
+    I420_to(data, row_conversions().NV12_to_RGBA32, destination);
+}
+
+void convert(ImageDataView<I420> const& data, BGRA32, Destination const& destination)
+{
+    I420_to(data, row_conversions().NV12_to_BGRA32, destination);
+}
+
+void convert(ImageDataView<I420> const& data, GREY8, Destination const& destination)
+{
+    copy(data, destination);
+}
+
+void convert(ImageDataView<I420> const& data, NV12, YUV420Destination const& destination)
+{
+    auto const chroma_width = (data.resolution().width() + 1) / 2;
+    convert_row_pairs(destination, data.resolution().height(), [&](uint32_t y, uint32_t y1, std::array<uint8_t*, 4> const& rows) {
+        copy_luma(data, y, y1, rows);
+        row_conversions().merge_chroma(data.plane(1) + (y / 2) * data.stride(1), data.plane(2) + (y / 2) * data.stride(2), rows[2], chroma_width); // NOLINT(*pointer-arithmetic)
+    });
+}
+
+void convert(ImageDataView<I420> const& data, I420, YUV420Destination const& destination)
+{
+    auto const chroma_width = (data.resolution().width() + size_t{1}) / 2;
+    convert_row_pairs(destination, data.resolution().height(), [&](uint32_t y, uint32_t y1, std::array<uint8_t*, 4> const& rows) {
+        copy_luma(data, y, y1, rows);
+        std::memcpy(rows[2], data.plane(1) + (y / 2) * data.stride(1), chroma_width); // NOLINT(*pointer-arithmetic)
+        std::memcpy(rows[3], data.plane(2) + (y / 2) * data.stride(2), chroma_width); // NOLINT(*pointer-arithmetic)
+    });
+}
+
+auto resized_resolution(CaptureSettings const& settings, Resolution oriented_resolution) -> std::optional<Resolution>
+{
+    if (auto const output_resolution = settings.output_resolution())
+        return output_resolution;
+    if (auto const max_resolution = settings.max_resolution())
+        return scaled_resolution(oriented_resolution, largest_scale_that_fits(oriented_resolution, *max_resolution));
+    return std::nullopt;
+}
+
+auto is_identity(Orientation const& orientation, FirstRowIs row_order) -> bool
+{
+    return !orientation.mirror
+           && orientation.rotation == Rotation::None
+           && (!orientation.normalize_row_order || row_order == FirstRowIs::Top);
+}
+
+} // namespace wcam::internal
\ No newline at end of file
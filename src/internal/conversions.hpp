@@ -0,0 +1,247 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include "../FirstRowIs.hpp"
+#include "../Image.hpp"
+#include "../Orientation.hpp"
+#include "../Resolution.hpp"
+#include "CaptureSettings.hpp"
+#include "Destination.hpp"
+#include "ImageFactory.hpp"
+#include "OutputBuffer.hpp"
+#include "crop.hpp"
+#include "pixel_formats.hpp"
+#include "resize.hpp"
+#include "tensors.hpp"
+
+namespace wcam::internal {
+
+/// The direct conversions we know how to do, and their relative cost per pixel (0 means that there is no such conversion).
+/// When adding a conversion, add its cost here and an overload of convert() below.
+template<typename From, typename To>
+inline constexpr int conversion_cost = 0;
+template<>
+inline constexpr int conversion_cost<RGB24, RGB24> = 1; // A copy, only used to apply an Orientation
+template<>
+inline constexpr int conversion_cost<BGR24, BGR24> = 1;
+template<>
+inline constexpr int conversion_cost<RGBA32, RGBA32> = 1;
+template<>
+inline constexpr int conversion_cost<BGRA32, BGRA32> = 1;
+template<>
+inline constexpr int conversion_cost<GREY8, GREY8> = 1;
+template<>
+inline constexpr int conversion_cost<NV12, NV12> = 1;
+template<>
+inline constexpr int conversion_cost<I420, I420> = 1;
+template<>
+inline constexpr int conversion_cost<NV12, GREY8> = 1; // A copy of the Y plane
+template<>
+inline constexpr int conversion_cost<I420, GREY8> = 1;
+template<>
+inline constexpr int conversion_cost<YUYV, GREY8> = 1; // Only keeps the Y samples
+template<>
+inline constexpr int conversion_cost<RGB24, BGR24> = 2; // A shuffle
+template<>
+inline constexpr int conversion_cost<NV12, I420> = 2;
+template<>
+inline constexpr int conversion_cost<I420, NV12> = 2;
+template<>
+inline constexpr int conversion_cost<YUYV, NV12> = 2; // A shuffle, and the chroma of two rows averaged
+template<>
+inline constexpr int conversion_cost<YUYV, I420> = 2;
+template<>
+inline constexpr int conversion_cost<BGR24, RGB24> = 2;
+template<>
+inline constexpr int conversion_cost<RGB24, RGBA32> = 2;
+template<>
+inline constexpr int conversion_cost<BGR24, BGRA32> = 2;
+template<>
+inline constexpr int conversion_cost<RGB24, BGRA32> = 2;
+template<>
+inline constexpr int conversion_cost<BGR24, RGBA32> = 2;
+template<>
+inline constexpr int conversion_cost<RGBA32, RGB24> = 2;
+template<>
+inline constexpr int conversion_cost<BGRA32, BGR24> = 2;
+template<>
+inline constexpr int conversion_cost<RGBA32, BGR24> = 2;
+template<>
+inline constexpr int conversion_cost<BGRA32, RGB24> = 2;
+template<>
+inline constexpr int conversion_cost<GREY8, RGB24> = 2;
+template<>
+inline constexpr int conversion_cost<GREY8, BGR24> = 2;
+template<>
+inline constexpr int conversion_cost<GREY8, RGBA32> = 2;
+template<>
+inline constexpr int conversion_cost<GREY8, BGRA32> = 2;
+template<>
+inline constexpr int conversion_cost<RGB24, GREY8> = 2; // A weighted sum, but it only writes a third of the bytes, and an Image that implements GREY8 prefers it on a tie
+template<>
+inline constexpr int conversion_cost<BGR24, GREY8> = 2;
+template<>
+inline constexpr int conversion_cost<NV12, RGB24> = 4; // A color space conversion
+template<>
+inline constexpr int conversion_cost<NV12, BGR24> = 4;
+template<>
+inline constexpr int conversion_cost<NV12, RGBA32> = 4;
+template<>
+inline constexpr int conversion_cost<NV12, BGRA32> = 4;
+template<>
+inline constexpr int conversion_cost<I420, RGB24> = 4;
+template<>
+inline constexpr int conversion_cost<I420, BGR24> = 4;
+template<>
+inline constexpr int conversion_cost<I420, RGBA32> = 4;
+template<>
+inline constexpr int conversion_cost<I420, BGRA32> = 4;
+template<>
+inline constexpr int conversion_cost<YUYV, RGB24> = 4;
+template<>
+inline constexpr int conversion_cost<YUYV, BGR24> = 4;
+template<>
+inline constexpr int conversion_cost<YUYV, RGBA32> = 4;
+template<>
+inline constexpr int conversion_cost<YUYV, BGRA32> = 4;
+
+void convert(ImageDataView<RGB24> const&, RGB24, Destination const&);
+void convert(ImageDataView<RGB24> const&, BGR24, Destination const&);
+void convert(ImageDataView<RGB24> const&, RGBA32, Destination const&);
+void convert(ImageDataView<RGB24> const&, BGRA32, Destination const&);
+void convert(ImageDataView<RGB24> const&, GREY8, Destination const&);
+void convert(ImageDataView<BGR24> const&, RGB24, Destination const&);
+void convert(ImageDataView<BGR24> const&, BGR24, Destination const&);
+void convert(ImageDataView<BGR24> const&, RGBA32, Destination const&);
+void convert(ImageDataView<BGR24> const&, BGRA32, Destination const&);
+void convert(ImageDataView<BGR24> const&, GREY8, Destination const&);
+void convert(ImageDataView<RGBA32> const&, RGB24, Destination const&);
+void convert(ImageDataView<RGBA32> const&, BGR24, Destination const&);
+void convert(ImageDataView<RGBA32> const&, RGBA32, Destination const&);
+void convert(ImageDataView<BGRA32> const&, RGB24, Destination const&);
+void convert(ImageDataView<BGRA32> const&, BGR24, Destination const&);
+void convert(ImageDataView<BGRA32> const&, BGRA32, Destination const&);
+void convert(ImageDataView<NV12> const&, RGB24, Destination const&);
+void convert(ImageDataView<NV12> const&, BGR24, Destination const&);
+void convert(ImageDataView<NV12> const&, RGBA32, Destination const&);
+void convert(ImageDataView<NV12> const&, BGRA32, Destination const&);
+void convert(ImageDataView<NV12> const&, GREY8, Destination const&);
+void convert(ImageDataView<NV12> const&, NV12, YUV420Destination const&);
+void convert(ImageDataView<NV12> const&, I420, YUV420Destination const&);
+void convert(ImageDataView<I420> const&, RGB24, Destination const&);
+void convert(ImageDataView<I420> const&, BGR24, Destination const&);
+void convert(ImageDataView<I420> const&, RGBA32, Destination const&);
+void convert(ImageDataView<I420> const&, BGRA32, Destination const&);
+void convert(ImageDataView<I420> const&, GREY8, Destination const&);
+void convert(ImageDataView<I420> const&, NV12, YUV420Destination const&);
+void convert(ImageDataView<I420> const&, I420, YUV420Destination const&);
+void convert(ImageDataView<I422> const&, RGB24, Destination const&);
+void convert(ImageDataView<YUYV> const&, RGB24, Destination const&);
+void convert(ImageDataView<YUYV> const&, BGR24, Destination const&);
+void convert(ImageDataView<YUYV> const&, RGBA32, Destination const&);
+void convert(ImageDataView<YUYV> const&, BGRA32, Destination const&);
+void convert(ImageDataView<YUYV> const&, GREY8, Destination const&);
+void convert(ImageDataView<YUYV> const&, NV12, YUV420Destination const&);
+void convert(ImageDataView<YUYV> const&, I420, YUV420Destination const&);
+void convert(ImageDataView<GREY8> const&, RGB24, Destination const&);
+void convert(ImageDataView<GREY8> const&, BGR24, Destination const&);
+void convert(ImageDataView<GREY8> const&, RGBA32, Destination const&);
+void convert(ImageDataView<GREY8> const&, BGRA32, Destination const&);
+void convert(ImageDataView<GREY8> const&, GREY8, Destination const&);
+
+/// The resolution that the images must be resized to (after the Orientation has been applied), if it is not `oriented_resolution`:
+/// the output resolution, or else the one that fits the images in the max resolution (see SharedWebcam::set_max_resolution())
+auto resized_resolution(CaptureSettings const&, Resolution oriented_resolution) -> std::optional<Resolution>;
+
+/// Returns true iff the images don't need to be transformed
+auto is_identity(Orientation const&, FirstRowIs row_order) -> bool;
+
+template<typename To, typename From>
+void convert_and_set_data(Image& image, ImageDataView<From> const& data, Orientation const& orientation)
+{
+    auto output = OutputBuffer<To>{image, oriented_resolution(data.resolution(), orientation)};
+    if constexpr (is_packed_pixel_format<To>)
+    {
+        auto const destination = Destination{output.plane(0), To::bytes_per_pixel, data.resolution(), data.row_order(), orientation, output.stride(0)};
+        convert(data, To{}, destination);
+        output.set_data(image, destination.row_order());
+    }
+    else
+    {
+        auto const destination = YUV420Destination{output.data(), output.planes(), data.resolution(), data.row_order(), orientation};
+        convert(data, To{}, destination);
+        output.set_data(image, destination.row_order(), data.yuv_encoding());
+    }
+}
+
+/// Calls `callback.template operator()<To>()` with the cheapest of the pixel formats that the Image implements and that we know how to convert `From` to
+/// (e.g. YUYV directly to BGR24 for an Image that only wants BGR24 and RGB24). Returns false if there is none.
+template<typename From, typename Callback>
+auto with_cheapest_conversion(PixelFormatsSet const& formats, Callback const& callback) -> bool
+{
+    auto best_cost  = std::numeric_limits<int>::max();
+    auto best_index = size_t{0};
+    for_each_pixel_format([&]<typename To>() {
+        if (conversion_cost<From, To> == 0 || !formats.contains<To>())
+            return;
+        // All the Images implement RGB24, so on a tie we prefer a format that the Image has chosen to implement
+        if (conversion_cost<From, To> < best_cost || (conversion_cost<From, To> == best_cost && best_index == pixel_format_index<RGB24>))
+        {
+            best_cost  = conversion_cost<From, To>;
+            best_index = pixel_format_index<To>;
+        }
+    });
+    if (best_cost == std::numeric_limits<int>::max())
+        return false;
+
+    for_each_pixel_format([&]<typename To>() {
+        if constexpr (conversion_cost<From, To> != 0)
+        {
+            if (pixel_format_index<To> == best_index)
+                callback.template operator()<To>();
+        }
+    });
+    return true;
+}
+
+/// Gives the image data to the Image, after applying the orientation that the user asked for.
+/// If the Image doesn't implement the set_data() overload of that pixel format, or if we need to apply an orientation, we convert it in one pass
+/// to the cheapest of the pixel formats that the Image implements (see with_cheapest_conversion()).
+/// If the Image wants tensors, we convert it in one pass to a tensor instead. If the user asked for another resolution, we resize it in the same pass as the conversion.
+/// If the user asked for a region of interest, all of this only sees a view of that region.
+template<typename From>
+void set_data(Image& image, ImageDataView<From> const& full_data, CaptureSettings const& settings)
+{
+    auto const region      = settings.region_of_interest();
+    auto const data        = region ? crop(full_data, *region) : full_data;
+    auto const orientation = settings.orientation();
+    if (wants_tensors())
+    {
+        set_tensor_data(image, data, orientation, settings.tensor_format());
+        return;
+    }
+
+    auto const output_resolution = resized_resolution(settings, oriented_resolution(data.resolution(), orientation));
+    if (output_resolution && *output_resolution != oriented_resolution(data.resolution(), orientation))
+    {
+        resize_and_set_data(image, data, orientation, *output_resolution, settings.resize_filter());
+        return;
+    }
+
+    auto const& formats = image_factory().implemented_formats();
+    if (formats.contains<From>() && is_identity(orientation, data.row_order()))
+    {
+        image.set_data(data);
+        return;
+    }
+
+    bool const converted = with_cheapest_conversion<From>(formats, [&]<typename To>() {
+        convert_and_set_data<To>(image, data, orientation);
+    });
+    if (!converted)
+        image.set_data(data); // We don't know any conversion, so let the Image deal with it (it can always convert to RGB24)
+}
+
+} // namespace wcam::internal
\ No newline at end of file
@@ -0,0 +1,45 @@
+#include "cpu_features.hpp"
+#if WCAM_ARCH_X86 && defined(_MSC_VER)
+#include <immintrin.h>
+#include <intrin.h>
+#include <array>
+#endif
+
+namespace wcam::internal {
+
+static auto detect_cpu_features() -> CpuFeatures
+{
+    auto features = CpuFeatures{};
+#if WCAM_ARCH_X86
+#if defined(_MSC_VER)
+    auto info = std::array<int, 4>{};
+    __cpuid(info.data(), 0);
+    int const max_leaf = info[0];
+
+    __cpuid(info.data(), 1);
+    features.sse4_1                   = (info[2] & (1 << 19)) != 0;
+    bool const os_saves_avx_registers = (info[2] & (1 << 27)) != 0 && (info[2] & (1 << 28)) != 0 && (_xgetbv(0) & 0b110) == 0b110; // OSXSAVE + AVX, and the OS actually saves the YMM registers
+    if (max_leaf >= 7)
+    {
+        __cpuidex(info.data(), 7, 0);
+        features.avx2 = os_saves_avx_registers && (info[1] & (1 << 5)) != 0;
+    }
+#else
+    __builtin_cpu_init();
+    features.sse4_1 = __builtin_cpu_supports("sse4.1");
+    features.avx2   = __builtin_cpu_supports("avx2"); // Also checks that the OS saves the YMM registers
+#endif
+#endif
+#if WCAM_ARCH_NEON
+    features.neon = true; // NEON is mandatory on ARM64, and if we are compiled with __ARM_NEON on 32-bit ARM then we already assume it is there
+#endif
+    return features;
+}
+
+auto cpu_features() -> CpuFeatures const&
+{
+    static auto const instance = detect_cpu_features();
+    return instance;
+}
+
+} // namespace wcam::internal
\ No newline at end of file
@@ -0,0 +1,33 @@
+#pragma once
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define WCAM_ARCH_X86 1
+#else
+#define WCAM_ARCH_X86 0
+#endif
+
+#if defined(__ARM_NEON) || defined(_M_ARM64)
+#define WCAM_ARCH_NEON 1
+#else
+#define WCAM_ARCH_NEON 0
+#endif
+
+/// Allows a function to use the instructions of an instruction set that the rest of the library is not compiled for. You must check `cpu_features()` before calling such a function.
+#if WCAM_ARCH_X86 && !defined(_MSC_VER)
+#define WCAM_TARGET(instruction_set) __attribute__((target(instruction_set)))
+#else
+#define WCAM_TARGET(instruction_set) // MSVC lets us use all the intrinsics without any special flag
+#endif
+
+namespace wcam::internal {
+
+struct CpuFeatures {
+    bool sse4_1{false};
+    bool avx2{false};
+    bool neon{false};
+};
+
+/// The instruction sets supported by the CPU we are currently running on
+auto cpu_features() -> CpuFeatures const&;
+
+} // namespace wcam::internal
\ No newline at end of file
@@ -0,0 +1,30 @@
+#include "crop.hpp"
+#include <algorithm>
+#include <utility>
+
+namespace wcam::internal {
+
+/// Returns the start and the length of the range along one axis
+static auto clamp_range(uint32_t start, uint32_t length, uint32_t size, uint32_t alignment) -> std::pair<uint32_t, uint32_t>
+{
+    start        = std::min(start, size - 1) / alignment * alignment;
+    uint32_t end = start + std::min(length, size - start);
+    if (end % alignment != 0)
+    {
+        uint32_t const aligned_end = end + alignment - end % alignment;
+        if (aligned_end <= size)
+            end = aligned_end;
+        else if (end - end % alignment > start)
+            end -= end % alignment;
+    }
+    return {start, end - start};
+}
+
+auto clamp_region(RegionOfInterest region, Resolution resolution, uint32_t columns_alignment, uint32_t rows_alignment) -> RegionOfInterest
+{
+    auto const [x, width]  = clamp_range(region.x, region.size.width(), resolution.width(), columns_alignment);
+    auto const [y, height] = clamp_range(region.y, region.size.height(), resolution.height(), rows_alignment);
+    return RegionOfInterest{x, y, Resolution{width, height}};
+}
+
+} // namespace wcam::internal
\ No newline at end of file
@@ -0,0 +1,60 @@
+#pragma once
+#include <cstdint>
+#include <type_traits>
+#include "../FirstRowIs.hpp"
+#include "../Image.hpp"
+#include "../RegionOfInterest.hpp"
+#include "../Resolution.hpp"
+
+namespace wcam::internal {
+
+/// The columns (and rows) that a view of a rectangle of the image must start on, so that it doesn't split the chroma samples that neighbouring pixels share
+template<typename PixelFormatT>
+inline constexpr uint32_t crop_columns_alignment = 1;
+template<>
+inline constexpr uint32_t crop_columns_alignment<YUYV> = 2;
+template<>
+inline constexpr uint32_t crop_columns_alignment<NV12> = 2;
+template<>
+inline constexpr uint32_t crop_columns_alignment<I420> = 2;
+
+template<typename PixelFormatT>
+inline constexpr uint32_t crop_rows_alignment = 1;
+template<>
+inline constexpr uint32_t crop_rows_alignment<NV12> = 2;
+template<>
+inline constexpr uint32_t crop_rows_alignment<I420> = 2;
+
+/// Clamps the region to an image of that resolution, and moves its start (by less than `alignment`) to a multiple of the alignment.
+/// Its size is also rounded to a multiple of the alignment when the image is big enough, because the conversions of YUYV can only write pairs of pixels.
+auto clamp_region(RegionOfInterest region, Resolution resolution, uint32_t columns_alignment = 1, uint32_t rows_alignment = 1) -> RegionOfInterest;
+
+/// Returns a view of the rectangle of the image that is described by `region` (see RegionOfInterest), without copying anything
+template<typename PixelFormatT>
+auto crop(ImageDataView<PixelFormatT> const& data, RegionOfInterest region) -> ImageDataView<PixelFormatT>
+{
+    region = clamp_region(region, data.resolution());
+    if (data.row_order() == wcam::FirstRowIs::Bottom)
+        region.y = data.resolution().height() - region.y - region.size.height(); // The rows are counted from the bottom in memory
+    region = clamp_region(region, data.resolution(), crop_columns_alignment<PixelFormatT>, crop_rows_alignment<PixelFormatT>);
+
+    auto planes = data.planes();
+    if constexpr (std::is_same_v<PixelFormatT, NV12>)
+    {
+        planes[0].offset += region.y * planes[0].stride + region.x;
+        planes[1].offset += region.y / 2 * planes[1].stride + region.x; // Each (u, v) pair covers two columns
+    }
+    else if constexpr (std::is_same_v<PixelFormatT, I420>)
+    {
+        planes[0].offset += region.y * planes[0].stride + region.x;
+        planes[1].offset += region.y / 2 * planes[1].stride + region.x / 2;
+        planes[2].offset += region.y / 2 * planes[2].stride + region.x / 2;
+    }
+    else
+    {
+        planes[0].offset += region.y * planes[0].stride + region.x * PixelFormatT::bytes_per_pixel;
+    }
+    return data.with_planes(region.size, planes);
+}
+
+} // namespace wcam::internal
\ No newline at end of file
@@ -0,0 +1,86 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include "../Image.hpp"
+
+namespace wcam::internal {
+
+/// All the pixel formats that an Image can receive. When adding a new one, add it here.
+using AllPixelFormats = std::tuple<RGB24, BGR24, RGBA32, BGRA32, NV12, I420, I422, YUYV, GREY8, PlanarRGBF32, PlanarRGBF16>;
+
+/// True for the pixel formats that have a single plane of interleaved pixels, that a Destination can write.
+/// The others (NV12, I420 and I422) are written plane by plane (see YUV420Destination).
+template<typename PixelFormatT>
+inline constexpr bool is_packed_pixel_format = requires { PixelFormatT::bytes_per_pixel; };
+
+template<typename PixelFormatT, size_t Index = 0>
+constexpr auto find_pixel_format_index() -> size_t
+{
+    static_assert(Index < std::tuple_size_v<AllPixelFormats>, "This pixel format is missing from AllPixelFormats");
+    if constexpr (std::is_same_v<std::tuple_element_t<Index, AllPixelFormats>, PixelFormatT>)
+        return Index;
+    else
+        return find_pixel_format_index<PixelFormatT, Index + 1>();
+}
+
+template<typename PixelFormatT>
+inline constexpr size_t pixel_format_index = find_pixel_format_index<PixelFormatT>();
+
+/// Calls `callback.template operator()<PixelFormatT>()` for each of the pixel formats
+template<typename Callback>
+void for_each_pixel_format(Callback&& callback)
+{
+    [&]<size_t... Indices>(std::index_sequence<Indices...>) {
+        (callback.template operator()<std::tuple_element_t<Indices, AllPixelFormats>>(), ...);
+    }(std::make_index_sequence<std::tuple_size_v<AllPixelFormats>>{});
+}
+
+/// A set of pixel formats
+class PixelFormatsSet {
+public:
+    template<typename PixelFormatT>
+    void insert()
+    {
+        _bits |= uint32_t{1} << pixel_format_index<PixelFormatT>;
+    }
+
+    template<typename PixelFormatT>
+    [[nodiscard]] auto contains() const -> bool
+    {
+        return (_bits & (uint32_t{1} << pixel_format_index<PixelFormatT>)) != 0;
+    }
+
+private:
+    uint32_t _bits{};
+};
+
+/// Deduces the class that declares the set_data() overload that receives PixelFormatT
+template<typename PixelFormatT, typename ClassT>
+auto class_that_declares_set_data(void (ClassT::*)(ImageDataView<PixelFormatT> const&)) -> ClassT;
+
+/// Returns true iff ImageT (or one of its base classes other than wcam::Image) overrides the set_data() that receives PixelFormatT.
+/// If it doesn't, calling that set_data() would use the default implementation of wcam::Image, which converts the data to RGB24.
+template<typename ImageT, typename PixelFormatT>
+constexpr auto overrides_set_data() -> bool
+{
+    if constexpr (requires { class_that_declares_set_data<PixelFormatT>(&ImageT::set_data); })
+        return !std::is_same_v<decltype(class_that_declares_set_data<PixelFormatT>(&ImageT::set_data)), Image>;
+    else
+        return false; // ImageT declares some overloads of set_data(), which hide the others (that are still the ones of wcam::Image)
+}
+
+template<typename ImageT>
+auto implemented_formats() -> PixelFormatsSet
+{
+    auto formats = PixelFormatsSet{};
+    for_each_pixel_format([&]<typename PixelFormatT>() {
+        if constexpr (overrides_set_data<ImageT, PixelFormatT>())
+            formats.insert<PixelFormatT>();
+    });
+    return formats;
+}
+
+} // namespace wcam::internal
\ No newline at end of file
@@ -0,0 +1,268 @@
+#include "resize.hpp"
+#include <algorithm>
+#include <array>
+#include <type_traits>
+#include "ConversionPool.hpp"
+#include "ImageFactory.hpp"
+#include "conversions.hpp"
+
+namespace wcam::internal {
+
+/// The sums of the vertical box filter are on 16 bits, so a box can't be taller than that (which only matters when downscaling by more than 256)
+static constexpr uint32_t max_box_size = 256;
+
+auto bilinear_samples(uint32_t source_size, uint32_t size) -> std::vector<BilinearSample>
+{
+    auto       samples = std::vector<BilinearSample>{};
+    auto const scale   = static_cast<float>(source_size) / static_cast<float>(size);
+    samples.reserve(size);
+    for (uint32_t i = 0; i < size; ++i)
+    {
+        float const    position = std::clamp((static_cast<float>(i) + 0.5f) * scale - 0.5f, 0.f, static_cast<float>(source_size - 1));
+        uint32_t const first    = static_cast<uint32_t>(position);
+        samples.push_back({first, std::min(first + 1, source_size - 1), position - static_cast<float>(first)});
+    }
+    return samples;
+}
+
+static auto resize_samples(uint32_t source_size, uint32_t size, ResizeFilter filter) -> std::vector<ResizeSample>
+{
+    auto samples = std::vector<ResizeSample>{};
+    samples.reserve(size);
+    if (filter == ResizeFilter::Bilinear)
+    {
+        for (auto const& sample : bilinear_samples(source_size, size))
+        {
+            auto const weight = static_cast<uint32_t>(sample.weight * 256.f + 0.5f);
+            if (weight == 0 || sample.first == sample.second)
+                samples.push_back({sample.first, sample.first, 0});
+            else if (weight == 256)
+                samples.push_back({sample.second, sample.second, 0});
+            else
+                samples.push_back({sample.first, sample.second, weight});
+        }
+        return samples;
+    }
+
+    for (uint32_t i = 0; i < size; ++i)
+    {
+        // When downscaling, each source pixel belongs to exactly one box. When upscaling, the boxes are smaller than a pixel, so we take the pixel under their center.
+        auto const first = size >= source_size
+                               ? static_cast<uint32_t>((uint64_t{2} * i + 1) * source_size / (uint64_t{2} * size))
+                               : static_cast<uint32_t>(uint64_t{i} * source_size / size);
+        auto const last  = size >= source_size
+                               ? first
+                               : std::min(static_cast<uint32_t>((uint64_t{i} + 1) * source_size / size) - 1, first + max_box_size - 1);
+        auto const count = last - first + 1;
+        samples.push_back({first, last, (65536 + count / 2) / count});
+    }
+    return samples;
+}
+
+auto oriented_resolution(Resolution resolution, Orientation const& orientation) -> Resolution
+{
+    if (orientation.rotation == Rotation::Clockwise90 || orientation.rotation == Rotation::Clockwise270)
+        return Resolution{resolution.height(), resolution.width()};
+    return resolution;
+}
+
+auto scaled_resolution(Resolution resolution, uint32_t eighths) -> Resolution
+{
+    return Resolution{(resolution.width() * eighths + 7) / 8, (resolution.height() * eighths + 7) / 8};
+}
+
+auto largest_scale_that_fits(Resolution resolution, Resolution max_resolution) -> uint32_t
+{
+    for (uint32_t eighths = 8; eighths > 1; --eighths)
+    {
+        auto const scaled = scaled_resolution(resolution, eighths);
+        if (scaled.width() <= max_resolution.width() && scaled.height() <= max_resolution.height())
+            return eighths;
+    }
+    return 1;
+}
+
+auto smallest_scale_that_covers(Resolution resolution, Resolution target) -> uint32_t
+{
+    for (uint32_t eighths = 1; eighths < 8; ++eighths)
+    {
+        auto const scaled = scaled_resolution(resolution, eighths);
+        if (scaled.width() >= target.width() && scaled.height() >= target.height())
+            return eighths;
+    }
+    return 8;
+}
+
+ResizeDestination::ResizeDestination(uint8_t* data, size_t bytes_per_pixel, Resolution source_resolution, FirstRowIs source_row_order, Orientation const& orientation, Resolution resolution, ResizeFilter filter, size_t row_stride)
+    // The orientation is applied to the resized image, so its size before the orientation is the same rotation of `resolution` (rotating by 90° twice is the identity)
+    : _destination{data, bytes_per_pixel, oriented_resolution(resolution, orientation), source_row_order, orientation, row_stride}
+    , _source_width{source_resolution.width()}
+    , _filter{filter}
+{
+    auto const resized_resolution = oriented_resolution(resolution, orientation);
+    _columns                      = resize_samples(source_resolution.width(), resized_resolution.width(), filter);
+    _rows                         = resize_samples(source_resolution.height(), resized_resolution.height(), filter);
+}
+
+template<size_t Channels>
+static void resize_row(uint8_t const* row, uint8_t* out, std::vector<ResizeSample> const& columns, ResizeFilter filter)
+{
+    if (filter == ResizeFilter::Bilinear)
+    {
+        for (auto const& column : columns)
+        {
+            uint8_t const* const first  = row + column.first * Channels; // NOLINT(*pointer-arithmetic)
+            uint8_t const* const second = row + column.last * Channels;  // NOLINT(*pointer-arithmetic)
+            for (size_t c = 0; c < Channels; ++c)
+                out[c] = static_cast<uint8_t>((first[c] * (256 - column.weight) + second[c] * column.weight + 128) >> 8); // NOLINT(*pointer-arithmetic)
+            out += Channels;                                                                                              // NOLINT(*pointer-arithmetic)
+        }
+        return;
+    }
+
+    for (auto const& column : columns)
+    {
+        auto sums = std::array<uint32_t, Channels>{};
+        for (uint32_t x = column.first; x <= column.last; ++x)
+        {
+            for (size_t c = 0; c < Channels; ++c)
+                sums[c] += row[x * Channels + c]; // NOLINT(*pointer-arithmetic, *constant-array-index)
+        }
+        for (size_t c = 0; c < Channels; ++c)
+            out[c] = static_cast<uint8_t>((sums[c] * column.weight + 32768) >> 16); // NOLINT(*pointer-arithmetic, *constant-array-index)
+        out += Channels;                                                              // NOLINT(*pointer-arithmetic)
+    }
+}
+
+void ResizeDestination::write_row(uint32_t t, uint8_t const* row) const
+{
+    uint8_t* out = _destination.direct_row(t);
+    if (!out)
+    {
+        thread_local auto scratch_row = std::vector<uint8_t>{};
+        scratch_row.resize(_columns.size() * bytes_per_pixel());
+        out = scratch_row.data();
+    }
+
+    if (_columns.size() == _source_width)
+        std::memcpy(out, row, _columns.size() * bytes_per_pixel());
+    else if (bytes_per_pixel() == 1)
+        resize_row<1>(row, out, _columns, _filter);
+    else if (bytes_per_pixel() == 3)
+        resize_row<3>(row, out, _columns, _filter);
+    else
+        resize_row<4>(row, out, _columns, _filter);
+
+    if (out != _destination.direct_row(t))
+        _destination.write_row(t, out);
+}
+
+/// The planes of an image have rows that cover this many rows of the image (e.g. 2 for the chroma planes of NV12 and I420)
+template<typename PixelFormatT>
+static auto rows_per_plane_row(size_t plane) -> uint32_t
+{
+    if constexpr (std::is_same_v<PixelFormatT, NV12> || std::is_same_v<PixelFormatT, I420>)
+        return plane != 0 ? 2 : 1;
+    else
+        return 1;
+}
+
+/// Filters vertically each plane of the source (which is a simple interpolation of bytes, that doesn't care about their meaning), then converts the resulting row
+/// with the same convert() as a full image, and filters it horizontally.
+template<typename From, typename To>
+static void resize(ImageDataView<From> const& data, ResizeDestination const& destination)
+{
+    auto const one_row    = Resolution{data.resolution().width(), 1};
+    auto const planes     = From::packed_planes(one_row);
+    auto const row_length = static_cast<size_t>(one_row.width()) * To::bytes_per_pixel;
+    conversion_pool().convert(destination.rows_count(), row_length, 1, [&](uint32_t begin, uint32_t end) {
+        auto filtered_rows = std::vector<uint8_t>(From::data_length(one_row));
+        auto converted_row = std::vector<uint8_t>(row_length);
+        auto sums          = std::vector<uint16_t>{};
+        for (uint32_t t = begin; t < end; ++t)
+        {
+            for (size_t p = 0; p < planes.size(); ++p)
+            {
+                uint8_t const* const plane   = data.plane(p);
+                auto const           stride  = data.stride(p);
+                auto const           divisor = rows_per_plane_row<From>(p);
+                destination.filter_rows(t, planes[p].stride, [&](uint32_t y) { return plane + (y / divisor) * stride; }, filtered_rows.data() + planes[p].offset, sums); // NOLINT(*pointer-arithmetic, *constant-array-index)
+            }
+            convert(
+                ImageDataView<From>{filtered_rows.data(), filtered_rows.size(), one_row, FirstRowIs::Top, planes, data.yuv_encoding()},
+                To{},
+                Destination{converted_row.data(), To::bytes_per_pixel, one_row, FirstRowIs::Top}
+            );
+            destination.write_row(t, converted_row.data());
+        }
+    });
+}
+
+/// The resized rows are written through a Destination, so we only resize to the packed pixel formats (e.g. NV12 is resized to RGB24)
+static auto packed_formats(PixelFormatsSet const& formats) -> PixelFormatsSet
+{
+    auto packed = PixelFormatsSet{};
+    for_each_pixel_format([&]<typename PixelFormatT>() {
+        if constexpr (is_packed_pixel_format<PixelFormatT>)
+        {
+            if (formats.contains<PixelFormatT>())
+                packed.insert<PixelFormatT>();
+        }
+    });
+    return packed;
+}
+
+template<typename From>
+static void resize_and_set_data_impl(Image& image, ImageDataView<From> const& data, Orientation const& orientation, Resolution resolution, ResizeFilter filter)
+{
+    with_cheapest_conversion<From>(packed_formats(image_factory().implemented_formats()), [&]<typename To>() {
+        if constexpr (is_packed_pixel_format<To>)
+        {
+            make_resized_image_and_set_data<To>(image, data.resolution(), data.row_order(), orientation, resolution, filter, [&](ResizeDestination const& destination) {
+                resize<From, To>(data, destination);
+            });
+        }
+    });
+}
+
+void resize_and_set_data(Image& image, ImageDataView<RGB24> const& data, Orientation const& orientation, Resolution resolution, ResizeFilter filter)
+{
+    resize_and_set_data_impl(image, data, orientation, resolution, filter);
+}
+
+void resize_and_set_data(Image& image, ImageDataView<BGR24> const& data, Orientation const& orientation, Resolution resolution, ResizeFilter filter)
+{
+    resize_and_set_data_impl(image, data, orientation, resolution, filter);
+}
+
+void resize_and_set_data(Image& image, ImageDataView<RGBA32> const& data, Orientation const& orientation, Resolution resolution, ResizeFilter filter)
+{
+    resize_and_set_data_impl(image, data, orientation, resolution, filter);
+}
+
+void resize_and_set_data(Image& image, ImageDataView<BGRA32> const& data, Orientation const& orientation, Resolution resolution, ResizeFilter filter)
+{
+    resize_and_set_data_impl(image, data, orientation, resolution, filter);
+}
+
+void resize_and_set_data(Image& image, ImageDataView<NV12> const& data, Orientation const& orientation, Resolution resolution, ResizeFilter filter)
+{
+    resize_and_set_data_impl(image, data, orientation, resolution, filter);
+}
+
+void resize_and_set_data(Image& image, ImageDataView<I420> const& data, Orientation const& orientation, Resolution resolution, ResizeFilter filter)
+{
+    resize_and_set_data_impl(image, data, orientation, resolution, filter);
+}
+
+void resize_and_set_data(Image& image, ImageDataView<YUYV> const& data, Orientation const& orientation, Resolution resolution, ResizeFilter filter)
+{
+    resize_and_set_data_impl(image, data, orientation, resolution, filter);
+}
+
+void resize_and_set_data(Image& image, ImageDataView<GREY8> const& data, Orientation const& orientation, Resolution resolution, ResizeFilter filter)
+{
+    resize_and_set_data_impl(image, data, orientation, resolution, filter);
+}
+
+} // namespace wcam::internal
\ No newline at end of file
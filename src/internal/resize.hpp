@@ -0,0 +1,120 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <vector>
+#include "../FirstRowIs.hpp"
+#include "../Image.hpp"
+#include "../Orientation.hpp"
+#include "../ResizeFilter.hpp"
+#include "../Resolution.hpp"
+#include "Destination.hpp"
+#include "OutputBuffer.hpp"
+#include "row_conversions.hpp"
+
+namespace wcam::internal {
+
+/// The two source pixels (or rows) that a pixel (or row) of a resized image is interpolated from, and the weight of the second one
+struct BilinearSample {
+    uint32_t first;
+    uint32_t second;
+    float    weight;
+};
+
+/// The bilinear samples of a row (or a column) of `size` values, taken in a row of `source_size` values, with the same convention as most resize functions (pixel centers are aligned)
+auto bilinear_samples(uint32_t source_size, uint32_t size) -> std::vector<BilinearSample>;
+
+/// The consecutive source pixels (or rows) that a pixel (or row) of a resized image is computed from, with integer weights
+struct ResizeSample {
+    uint32_t first;
+    uint32_t last;   // Included
+    uint32_t weight; // For ResizeFilter::Bilinear, the weight of `last`, out of 256. For ResizeFilter::Box, the reciprocal of the number of samples, out of 65536.
+};
+
+/// Where the rows of an image that is being resized and converted to a packed format (RGB24, BGR24, RGBA32, BGRA32, GREY8) are written.
+/// Each row of the resized image is computed from a few consecutive rows of the source image, that are first filtered vertically while they are still in the source format (e.g. YUYV),
+/// then converted (so the color conversion only runs once per row of the resized image), and then filtered horizontally, directly to their place.
+/// It applies an Orientation to the resized image, like a Destination.
+class ResizeDestination {
+public:
+    /// `source_resolution` and `source_row_order` are the ones of the image that is being resized.
+    /// `resolution` is the one of the resized image, after the Orientation has been applied. `row_stride` is the one of its rows, or 0 if they are not padded.
+    ResizeDestination(uint8_t* data, size_t bytes_per_pixel, Resolution source_resolution, FirstRowIs source_row_order, Orientation const& orientation, Resolution resolution, ResizeFilter filter, size_t row_stride = 0);
+
+    [[nodiscard]] auto resolution() const -> Resolution { return _destination.resolution(); }
+    [[nodiscard]] auto row_order() const -> FirstRowIs { return _destination.row_order(); }
+    /// Width of the rows of the source image
+    [[nodiscard]] auto source_width() const -> uint32_t { return _source_width; }
+    [[nodiscard]] auto bytes_per_pixel() const -> size_t { return _destination.bytes_per_pixel(); }
+    /// Number of rows of the resized image, before the Orientation is applied. They are numbered in the order of the source rows they use.
+    [[nodiscard]] auto rows_count() const -> uint32_t { return static_cast<uint32_t>(_rows.size()); }
+    /// The first row of the source image that the row `t` uses. It never decreases when `t` increases.
+    [[nodiscard]] auto first_source_row(uint32_t t) const -> uint32_t { return _rows[t].first; } // NOLINT(*constant-array-index)
+
+    /// Filters vertically the source rows that the row `t` uses, which `row(y)` returns, and writes the resulting `length` bytes to `out`.
+    /// `row(y)` is called for increasing values of `y`, and the row it returns must stay valid until the call after the next one. `sums` is a scratch buffer.
+    template<typename RowOf>
+    void filter_rows(uint32_t t, size_t length, RowOf const& row, uint8_t* out, std::vector<uint16_t>& sums) const
+    {
+        auto const& sample = _rows[t]; // NOLINT(*constant-array-index)
+        if (sample.first == sample.last)
+        {
+            std::memcpy(out, row(sample.first), length);
+        }
+        else if (_filter == ResizeFilter::Bilinear)
+        {
+            uint8_t const* const first = row(sample.first);
+            row_conversions().blend_rows(first, row(sample.last), out, length, sample.weight);
+        }
+        else
+        {
+            sums.assign(length, 0);
+            for (uint32_t y = sample.first; y <= sample.last; ++y)
+                row_conversions().add_row(row(y), sums.data(), length);
+            row_conversions().average_row(sums.data(), out, length, sample.weight);
+        }
+    }
+
+    /// Filters horizontally the row `t`, that has been filtered vertically and converted to the destination format, and writes it to its place
+    void write_row(uint32_t t, uint8_t const* row) const;
+
+private:
+    Destination               _destination;
+    uint32_t                  _source_width{};
+    ResizeFilter              _filter{};
+    std::vector<ResizeSample> _columns{};
+    std::vector<ResizeSample> _rows{};
+};
+
+/// Gets a buffer for an image in PixelFormatT (see OutputBuffer), calls `fill` to compute it, and gives it to the Image
+template<typename PixelFormatT, typename Fill>
+void make_resized_image_and_set_data(Image& image, Resolution source_resolution, FirstRowIs source_row_order, Orientation const& orientation, Resolution resolution, ResizeFilter filter, Fill const& fill)
+{
+    auto       output      = OutputBuffer<PixelFormatT>{image, resolution};
+    auto const destination = ResizeDestination{output.plane(0), PixelFormatT::bytes_per_pixel, source_resolution, source_row_order, orientation, resolution, filter, output.stride(0)};
+    fill(destination);
+    output.set_data(image, destination.row_order());
+}
+
+/// Gives the image data to the Image, resized to `resolution` (after applying the Orientation), and converted in the same pass to the cheapest pixel format that the Image implements
+void resize_and_set_data(Image&, ImageDataView<RGB24> const&, Orientation const&, Resolution, ResizeFilter);
+void resize_and_set_data(Image&, ImageDataView<BGR24> const&, Orientation const&, Resolution, ResizeFilter);
+void resize_and_set_data(Image&, ImageDataView<RGBA32> const&, Orientation const&, Resolution, ResizeFilter);
+void resize_and_set_data(Image&, ImageDataView<BGRA32> const&, Orientation const&, Resolution, ResizeFilter);
+void resize_and_set_data(Image&, ImageDataView<NV12> const&, Orientation const&, Resolution, ResizeFilter);
+void resize_and_set_data(Image&, ImageDataView<I420> const&, Orientation const&, Resolution, ResizeFilter);
+void resize_and_set_data(Image&, ImageDataView<YUYV> const&, Orientation const&, Resolution, ResizeFilter);
+void resize_and_set_data(Image&, ImageDataView<GREY8> const&, Orientation const&, Resolution, ResizeFilter);
+
+/// The resolution of the images once the Orientation has been applied
+auto oriented_resolution(Resolution, Orientation const&) -> Resolution;
+
+/// `resolution` scaled by eighths / 8, rounded up. These are the scales that libjpeg can decode a JPEG to almost for free, by dropping DCT coefficients.
+auto scaled_resolution(Resolution resolution, uint32_t eighths) -> Resolution;
+/// The largest scale, in eighths (from 1 to 8), that makes `resolution` fit in `max_resolution`. 1 if even that doesn't fit.
+auto largest_scale_that_fits(Resolution resolution, Resolution max_resolution) -> uint32_t;
+/// The smallest scale, in eighths (from 1 to 8), that keeps `resolution` at least as big as `target`, so that resizing it to `target` afterwards loses nothing. 8 if `target` is bigger than `resolution`.
+auto smallest_scale_that_covers(Resolution resolution, Resolution target) -> uint32_t;
+
+} // namespace wcam::internal
\ No newline at end of file
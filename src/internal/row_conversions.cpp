@@ -0,0 +1,116 @@
+#include "row_conversions.hpp"
+
+namespace wcam::internal {
+
+static auto select_row_conversions() -> RowConversions
+{
+    auto conversions = RowConversions{
+        .YUYV_to_RGB24                      = &scalar::YUYV_to_RGB24,
+        .YUYV_to_BGR24                      = &scalar::YUYV_to_BGR24,
+        .YUYV_to_RGBA32                     = &scalar::YUYV_to_RGBA32,
+        .YUYV_to_BGRA32                     = &scalar::YUYV_to_BGRA32,
+        .NV12_to_RGB24                      = &scalar::NV12_to_RGB24,
+        .NV12_to_BGR24                      = &scalar::NV12_to_BGR24,
+        .NV12_to_RGBA32                     = &scalar::NV12_to_RGBA32,
+        .NV12_to_BGRA32                     = &scalar::NV12_to_BGRA32,
+        .swap_red_and_blue                  = &scalar::swap_red_and_blue,
+        .add_alpha                          = &scalar::add_alpha,
+        .add_alpha_and_swap_red_and_blue    = &scalar::add_alpha_and_swap_red_and_blue,
+        .remove_alpha                       = &scalar::remove_alpha, // Only used by the default implementations of Image::set_data(), that none of our backends produce, so it doesn't need to be fast
+        .remove_alpha_and_swap_red_and_blue = &scalar::remove_alpha_and_swap_red_and_blue,
+        .YUYV_to_GREY8                      = &scalar::YUYV_to_GREY8,
+        .GREY8_to_RGB24                     = &scalar::GREY8_to_RGB24,
+        .GREY8_to_RGBA32                    = &scalar::GREY8_to_RGBA32,
+        .RGB24_to_GREY8                     = &scalar::RGB24_to_GREY8, // Only used for the Images that want GREY8 from a webcam that gives BGR24, which is rare enough that it doesn't need to be fast
+        .BGR24_to_GREY8                     = &scalar::BGR24_to_GREY8,
+        .YUYV_to_NV12                       = &scalar::YUYV_to_NV12,
+        .YUYV_to_I420                       = &scalar::YUYV_to_I420,
+        .split_chroma                       = &scalar::split_chroma,
+        .merge_chroma                       = &scalar::merge_chroma,
+        .merge_to_YUYV                      = &scalar::merge_to_YUYV,
+        .blend_rows                         = &scalar::blend_rows,
+        .add_row                            = &scalar::add_row,
+        .average_row                        = &scalar::average_row,
+    };
+    [[maybe_unused]] auto const& features = cpu_features();
+#if WCAM_ARCH_X86
+    if (features.sse4_1)
+    {
+        conversions.YUYV_to_RGB24  = &sse4_1::YUYV_to_RGB24;
+        conversions.YUYV_to_BGR24  = &sse4_1::YUYV_to_BGR24;
+        conversions.YUYV_to_RGBA32 = &sse4_1::YUYV_to_RGBA32;
+        conversions.YUYV_to_BGRA32 = &sse4_1::YUYV_to_BGRA32;
+        conversions.NV12_to_RGB24  = &sse4_1::NV12_to_RGB24;
+        conversions.NV12_to_BGR24  = &sse4_1::NV12_to_BGR24;
+        conversions.NV12_to_RGBA32 = &sse4_1::NV12_to_RGBA32;
+        conversions.NV12_to_BGRA32 = &sse4_1::NV12_to_BGRA32;
+        // There is no AVX2 version of the shuffles: the SSE4.1 versions are already bound by the memory bandwidth
+        conversions.swap_red_and_blue               = &sse4_1::swap_red_and_blue;
+        conversions.add_alpha                       = &sse4_1::add_alpha;
+        conversions.add_alpha_and_swap_red_and_blue = &sse4_1::add_alpha_and_swap_red_and_blue;
+        conversions.YUYV_to_GREY8                   = &sse4_1::YUYV_to_GREY8;
+        conversions.GREY8_to_RGB24                  = &sse4_1::GREY8_to_RGB24;
+        conversions.GREY8_to_RGBA32                 = &sse4_1::GREY8_to_RGBA32;
+        conversions.YUYV_to_NV12                    = &sse4_1::YUYV_to_NV12;
+        conversions.YUYV_to_I420                    = &sse4_1::YUYV_to_I420;
+        conversions.split_chroma                    = &sse4_1::split_chroma;
+        conversions.merge_chroma                    = &sse4_1::merge_chroma;
+        conversions.merge_to_YUYV                   = &sse4_1::merge_to_YUYV;
+        conversions.blend_rows                      = &sse4_1::blend_rows;
+        conversions.add_row                         = &sse4_1::add_row;
+        conversions.average_row                     = &sse4_1::average_row;
+    }
+    if (features.avx2)
+    {
+        conversions.YUYV_to_RGB24  = &avx2::YUYV_to_RGB24;
+        conversions.YUYV_to_BGR24  = &avx2::YUYV_to_BGR24;
+        conversions.YUYV_to_RGBA32 = &avx2::YUYV_to_RGBA32;
+        conversions.YUYV_to_BGRA32 = &avx2::YUYV_to_BGRA32;
+        conversions.NV12_to_RGB24  = &avx2::NV12_to_RGB24;
+        conversions.NV12_to_BGR24  = &avx2::NV12_to_BGR24;
+        conversions.NV12_to_RGBA32 = &avx2::NV12_to_RGBA32;
+        conversions.NV12_to_BGRA32 = &avx2::NV12_to_BGRA32;
+        conversions.YUYV_to_GREY8  = &avx2::YUYV_to_GREY8;
+        conversions.YUYV_to_NV12   = &avx2::YUYV_to_NV12;
+        conversions.YUYV_to_I420   = &avx2::YUYV_to_I420;
+        conversions.blend_rows     = &avx2::blend_rows;
+        conversions.add_row        = &avx2::add_row;
+    }
+#endif
+#if WCAM_ARCH_NEON
+    if (features.neon)
+    {
+        conversions.YUYV_to_RGB24                   = &neon::YUYV_to_RGB24;
+        conversions.YUYV_to_BGR24                   = &neon::YUYV_to_BGR24;
+        conversions.YUYV_to_RGBA32                  = &neon::YUYV_to_RGBA32;
+        conversions.YUYV_to_BGRA32                  = &neon::YUYV_to_BGRA32;
+        conversions.NV12_to_RGB24                   = &neon::NV12_to_RGB24;
+        conversions.NV12_to_BGR24                   = &neon::NV12_to_BGR24;
+        conversions.NV12_to_RGBA32                  = &neon::NV12_to_RGBA32;
+        conversions.NV12_to_BGRA32                  = &neon::NV12_to_BGRA32;
+        conversions.swap_red_and_blue               = &neon::swap_red_and_blue;
+        conversions.add_alpha                       = &neon::add_alpha;
+        conversions.add_alpha_and_swap_red_and_blue = &neon::add_alpha_and_swap_red_and_blue;
+        conversions.YUYV_to_GREY8                   = &neon::YUYV_to_GREY8;
+        conversions.GREY8_to_RGB24                  = &neon::GREY8_to_RGB24;
+        conversions.GREY8_to_RGBA32                 = &neon::GREY8_to_RGBA32;
+        conversions.YUYV_to_NV12                    = &neon::YUYV_to_NV12;
+        conversions.YUYV_to_I420                    = &neon::YUYV_to_I420;
+        conversions.split_chroma                    = &neon::split_chroma;
+        conversions.merge_chroma                    = &neon::merge_chroma;
+        conversions.merge_to_YUYV                   = &neon::merge_to_YUYV;
+        conversions.blend_rows                      = &neon::blend_rows;
+        conversions.add_row                         = &neon::add_row;
+        conversions.average_row                     = &neon::average_row;
+    }
+#endif
+    return conversions;
+}
+
+auto row_conversions() -> RowConversions const&
+{
+    static auto const instance = select_row_conversions();
+    return instance;
+}
+
+} // namespace wcam::internal
\ No newline at end of file
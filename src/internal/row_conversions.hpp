@@ -0,0 +1,199 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include "YUVCoefficients.hpp"
+#include "cpu_features.hpp"
+
+namespace wcam::internal {
+
+/// Order of the channels in the pixels of RGB24, BGR24, RGBA32 and BGRA32 images
+enum class ChannelOrder {
+    RGB,
+    BGR,
+    RGBA,
+    BGRA,
+};
+
+/// Number of bytes of each pixel
+template<ChannelOrder order>
+inline constexpr uint32_t pixel_size = order == ChannelOrder::RGB || order == ChannelOrder::BGR ? 3 : 4;
+
+/// Converts one row of `width` pixels. `width` must be even, like for any YUYV image.
+using YUYV_RowConversion = void (*)(uint8_t const* yuyv, uint8_t* rgb, uint32_t width, YUVCoefficients const&);
+
+/// Converts two rows of `width` pixels that share the same row of chroma samples, so that each (u, v) pair is loaded and processed once for a 2x2 block of pixels.
+/// For the last row of an image with an odd height, just pass the same row twice.
+using NV12_RowConversion = void (*)(uint8_t const* y_row0, uint8_t const* y_row1, uint8_t const* uv_row, uint8_t* rgb_row0, uint8_t* rgb_row1, uint32_t width, YUVCoefficients const&);
+
+/// Converts one row of `width` pixels between two of the RGB formats (or GREY8, or from YUYV to GREY8). For swap_red_and_blue(), `in` and `out` can be the same buffer, to convert in place.
+using RGB_RowConversion = void (*)(uint8_t const* in, uint8_t* out, uint32_t width);
+
+/// Converts two rows of `width` pixels to the two rows of Y and the row of (u, v) pairs that they share in NV12, by averaging their chroma vertically.
+/// `width` must be even, like for any YUYV image. For the last row of an image with an odd height, just pass the same row twice.
+using YUYV_to_NV12_RowConversion = void (*)(uint8_t const* yuyv_row0, uint8_t const* yuyv_row1, uint8_t* y_row0, uint8_t* y_row1, uint8_t* uv_row, uint32_t width);
+
+/// Same as YUYV_to_NV12_RowConversion, but writes the u and v samples to two separate rows, like in I420
+using YUYV_to_I420_RowConversion = void (*)(uint8_t const* yuyv_row0, uint8_t const* yuyv_row1, uint8_t* y_row0, uint8_t* y_row1, uint8_t* u_row, uint8_t* v_row, uint32_t width);
+
+/// Splits `count` (u, v) pairs of a row of NV12 to the rows of u and v of I420
+using SplitChroma = void (*)(uint8_t const* uv, uint8_t* u, uint8_t* v, uint32_t count);
+
+/// Interleaves `count` samples of the rows of u and v of I420 to the (u, v) pairs of a row of NV12
+using MergeChroma = void (*)(uint8_t const* u, uint8_t const* v, uint8_t* uv, uint32_t count);
+
+/// Interleaves a row of `width` pixels of the Y, U and V planes of I422 to a row of YUYV. For an odd `width`, the last Y sample is repeated, so that `yuyv` must be (width + 1) / 2 * 4 bytes long.
+using MergeToYUYV = void (*)(uint8_t const* y, uint8_t const* u, uint8_t const* v, uint8_t* yuyv, uint32_t width);
+
+/// Blends two rows byte per byte, for a bilinear resize: out = (row0 * (256 - weight) + row1 * weight + 128) / 256, with `weight` in [0, 255].
+/// It works on any packed bytes, so it can be applied to a row of YUYV before converting it.
+using BlendRows = void (*)(uint8_t const* row0, uint8_t const* row1, uint8_t* out, size_t length, uint32_t weight);
+
+/// Adds a row to the sums of a box filter, byte per byte. The sums don't overflow for up to 257 rows.
+using AddRow = void (*)(uint8_t const* row, uint16_t* sums, size_t length);
+
+/// Divides the sums of a box filter of `count` rows: out = (sums * reciprocal + 32768) / 65536, where `reciprocal` is 65536 / count rounded to nearest and `count` is at least 2.
+using AverageRow = void (*)(uint16_t const* sums, uint8_t* out, size_t length, uint32_t reciprocal);
+
+/// The fastest implementation of each conversion that the current CPU supports
+struct RowConversions {
+    YUYV_RowConversion         YUYV_to_RGB24{};
+    YUYV_RowConversion         YUYV_to_BGR24{};
+    YUYV_RowConversion         YUYV_to_RGBA32{};
+    YUYV_RowConversion         YUYV_to_BGRA32{};
+    NV12_RowConversion         NV12_to_RGB24{};
+    NV12_RowConversion         NV12_to_BGR24{};
+    NV12_RowConversion         NV12_to_RGBA32{};
+    NV12_RowConversion         NV12_to_BGRA32{};
+    RGB_RowConversion          swap_red_and_blue{};                  /// BGR24 to RGB24, and RGB24 to BGR24
+    RGB_RowConversion          add_alpha{};                          /// RGB24 to RGBA32, and BGR24 to BGRA32
+    RGB_RowConversion          add_alpha_and_swap_red_and_blue{};    /// BGR24 to RGBA32, and RGB24 to BGRA32
+    RGB_RowConversion          remove_alpha{};                       /// RGBA32 to RGB24, and BGRA32 to BGR24
+    RGB_RowConversion          remove_alpha_and_swap_red_and_blue{}; /// BGRA32 to RGB24, and RGBA32 to BGR24
+    RGB_RowConversion          YUYV_to_GREY8{};                      /// Only keeps the Y samples
+    RGB_RowConversion          GREY8_to_RGB24{};                     /// And to BGR24, which is the same
+    RGB_RowConversion          GREY8_to_RGBA32{};                    /// And to BGRA32, which is the same
+    RGB_RowConversion          RGB24_to_GREY8{};
+    RGB_RowConversion          BGR24_to_GREY8{};
+    YUYV_to_NV12_RowConversion YUYV_to_NV12{};
+    YUYV_to_I420_RowConversion YUYV_to_I420{};
+    SplitChroma                split_chroma{};
+    MergeChroma                merge_chroma{};
+    MergeToYUYV                merge_to_YUYV{};
+    BlendRows                  blend_rows{};
+    AddRow                     add_row{};
+    AverageRow                 average_row{};
+};
+
+auto row_conversions() -> RowConversions const&;
+
+/// The reference implementations. The SIMD ones give bit-exact results, and fallback to these for the pixels at the end of the rows that don't fill a whole SIMD register.
+namespace scalar {
+void YUYV_to_RGB24(uint8_t const* yuyv, uint8_t* rgb, uint32_t width, YUVCoefficients const&);
+void YUYV_to_BGR24(uint8_t const* yuyv, uint8_t* bgr, uint32_t width, YUVCoefficients const&);
+void YUYV_to_RGBA32(uint8_t const* yuyv, uint8_t* rgba, uint32_t width, YUVCoefficients const&);
+void YUYV_to_BGRA32(uint8_t const* yuyv, uint8_t* bgra, uint32_t width, YUVCoefficients const&);
+void NV12_to_RGB24(uint8_t const* y_row0, uint8_t const* y_row1, uint8_t const* uv_row, uint8_t* rgb_row0, uint8_t* rgb_row1, uint32_t width, YUVCoefficients const&);
+void NV12_to_BGR24(uint8_t const* y_row0, uint8_t const* y_row1, uint8_t const* uv_row, uint8_t* bgr_row0, uint8_t* bgr_row1, uint32_t width, YUVCoefficients const&);
+void NV12_to_RGBA32(uint8_t const* y_row0, uint8_t const* y_row1, uint8_t const* uv_row, uint8_t* rgba_row0, uint8_t* rgba_row1, uint32_t width, YUVCoefficients const&);
+void NV12_to_BGRA32(uint8_t const* y_row0, uint8_t const* y_row1, uint8_t const* uv_row, uint8_t* bgra_row0, uint8_t* bgra_row1, uint32_t width, YUVCoefficients const&);
+void swap_red_and_blue(uint8_t const* bgr, uint8_t* rgb, uint32_t width);
+void add_alpha(uint8_t const* rgb, uint8_t* rgba, uint32_t width);
+void add_alpha_and_swap_red_and_blue(uint8_t const* bgr, uint8_t* rgba, uint32_t width);
+void remove_alpha(uint8_t const* rgba, uint8_t* rgb, uint32_t width);
+void remove_alpha_and_swap_red_and_blue(uint8_t const* bgra, uint8_t* rgb, uint32_t width);
+void YUYV_to_GREY8(uint8_t const* yuyv, uint8_t* grey, uint32_t width);
+void GREY8_to_RGB24(uint8_t const* grey, uint8_t* rgb, uint32_t width);
+void GREY8_to_RGBA32(uint8_t const* grey, uint8_t* rgba, uint32_t width);
+void RGB24_to_GREY8(uint8_t const* rgb, uint8_t* grey, uint32_t width);
+void BGR24_to_GREY8(uint8_t const* bgr, uint8_t* grey, uint32_t width);
+void YUYV_to_NV12(uint8_t const* yuyv_row0, uint8_t const* yuyv_row1, uint8_t* y_row0, uint8_t* y_row1, uint8_t* uv_row, uint32_t width);
+void YUYV_to_I420(uint8_t const* yuyv_row0, uint8_t const* yuyv_row1, uint8_t* y_row0, uint8_t* y_row1, uint8_t* u_row, uint8_t* v_row, uint32_t width);
+void split_chroma(uint8_t const* uv, uint8_t* u, uint8_t* v, uint32_t count);
+void merge_chroma(uint8_t const* u, uint8_t const* v, uint8_t* uv, uint32_t count);
+void merge_to_YUYV(uint8_t const* y, uint8_t const* u, uint8_t const* v, uint8_t* yuyv, uint32_t width);
+void blend_rows(uint8_t const* row0, uint8_t const* row1, uint8_t* out, size_t length, uint32_t weight);
+void add_row(uint8_t const* row, uint16_t* sums, size_t length);
+void average_row(uint16_t const* sums, uint8_t* out, size_t length, uint32_t reciprocal);
+
+/// Selects the version of a conversion for a given output format, for the SIMD kernels that are written once for all the orders and fallback to the scalar version for the end of the rows
+template<ChannelOrder order>
+inline constexpr auto YUYV_to = order == ChannelOrder::RGB ? &YUYV_to_RGB24 : order == ChannelOrder::BGR ? &YUYV_to_BGR24 : order == ChannelOrder::RGBA ? &YUYV_to_RGBA32 : &YUYV_to_BGRA32;
+template<ChannelOrder order>
+inline constexpr auto NV12_to = order == ChannelOrder::RGB ? &NV12_to_RGB24 : order == ChannelOrder::BGR ? &NV12_to_BGR24 : order == ChannelOrder::RGBA ? &NV12_to_RGBA32 : &NV12_to_BGRA32;
+} // namespace scalar
+
+#if WCAM_ARCH_X86
+namespace sse4_1 {
+void YUYV_to_RGB24(uint8_t const* yuyv, uint8_t* rgb, uint32_t width, YUVCoefficients const&);
+void YUYV_to_BGR24(uint8_t const* yuyv, uint8_t* bgr, uint32_t width, YUVCoefficients const&);
+void YUYV_to_RGBA32(uint8_t const* yuyv, uint8_t* rgba, uint32_t width, YUVCoefficients const&);
+void YUYV_to_BGRA32(uint8_t const* yuyv, uint8_t* bgra, uint32_t width, YUVCoefficients const&);
+void NV12_to_RGB24(uint8_t const* y_row0, uint8_t const* y_row1, uint8_t const* uv_row, uint8_t* rgb_row0, uint8_t* rgb_row1, uint32_t width, YUVCoefficients const&);
+void NV12_to_BGR24(uint8_t const* y_row0, uint8_t const* y_row1, uint8_t const* uv_row, uint8_t* bgr_row0, uint8_t* bgr_row1, uint32_t width, YUVCoefficients const&);
+void NV12_to_RGBA32(uint8_t const* y_row0, uint8_t const* y_row1, uint8_t const* uv_row, uint8_t* rgba_row0, uint8_t* rgba_row1, uint32_t width, YUVCoefficients const&);
+void NV12_to_BGRA32(uint8_t const* y_row0, uint8_t const* y_row1, uint8_t const* uv_row, uint8_t* bgra_row0, uint8_t* bgra_row1, uint32_t width, YUVCoefficients const&);
+void swap_red_and_blue(uint8_t const* bgr, uint8_t* rgb, uint32_t width);
+void add_alpha(uint8_t const* rgb, uint8_t* rgba, uint32_t width);
+void add_alpha_and_swap_red_and_blue(uint8_t const* bgr, uint8_t* rgba, uint32_t width);
+void YUYV_to_GREY8(uint8_t const* yuyv, uint8_t* grey, uint32_t width);
+void GREY8_to_RGB24(uint8_t const* grey, uint8_t* rgb, uint32_t width);
+void GREY8_to_RGBA32(uint8_t const* grey, uint8_t* rgba, uint32_t width);
+void YUYV_to_NV12(uint8_t const* yuyv_row0, uint8_t const* yuyv_row1, uint8_t* y_row0, uint8_t* y_row1, uint8_t* uv_row, uint32_t width);
+void YUYV_to_I420(uint8_t const* yuyv_row0, uint8_t const* yuyv_row1, uint8_t* y_row0, uint8_t* y_row1, uint8_t* u_row, uint8_t* v_row, uint32_t width);
+void split_chroma(uint8_t const* uv, uint8_t* u, uint8_t* v, uint32_t count);
+void merge_chroma(uint8_t const* u, uint8_t const* v, uint8_t* uv, uint32_t count);
+void merge_to_YUYV(uint8_t const* y, uint8_t const* u, uint8_t const* v, uint8_t* yuyv, uint32_t width);
+void blend_rows(uint8_t const* row0, uint8_t const* row1, uint8_t* out, size_t length, uint32_t weight);
+void add_row(uint8_t const* row, uint16_t* sums, size_t length);
+void average_row(uint16_t const* sums, uint8_t* out, size_t length, uint32_t reciprocal);
+
+template<ChannelOrder order>
+inline constexpr auto YUYV_to = order == ChannelOrder::RGB ? &YUYV_to_RGB24 : order == ChannelOrder::BGR ? &YUYV_to_BGR24 : order == ChannelOrder::RGBA ? &YUYV_to_RGBA32 : &YUYV_to_BGRA32;
+template<ChannelOrder order>
+inline constexpr auto NV12_to = order == ChannelOrder::RGB ? &NV12_to_RGB24 : order == ChannelOrder::BGR ? &NV12_to_BGR24 : order == ChannelOrder::RGBA ? &NV12_to_RGBA32 : &NV12_to_BGRA32;
+} // namespace sse4_1
+namespace avx2 {
+void YUYV_to_RGB24(uint8_t const* yuyv, uint8_t* rgb, uint32_t width, YUVCoefficients const&);
+void YUYV_to_BGR24(uint8_t const* yuyv, uint8_t* bgr, uint32_t width, YUVCoefficients const&);
+void YUYV_to_RGBA32(uint8_t const* yuyv, uint8_t* rgba, uint32_t width, YUVCoefficients const&);
+void YUYV_to_BGRA32(uint8_t const* yuyv, uint8_t* bgra, uint32_t width, YUVCoefficients const&);
+void NV12_to_RGB24(uint8_t const* y_row0, uint8_t const* y_row1, uint8_t const* uv_row, uint8_t* rgb_row0, uint8_t* rgb_row1, uint32_t width, YUVCoefficients const&);
+void NV12_to_BGR24(uint8_t const* y_row0, uint8_t const* y_row1, uint8_t const* uv_row, uint8_t* bgr_row0, uint8_t* bgr_row1, uint32_t width, YUVCoefficients const&);
+void NV12_to_RGBA32(uint8_t const* y_row0, uint8_t const* y_row1, uint8_t const* uv_row, uint8_t* rgba_row0, uint8_t* rgba_row1, uint32_t width, YUVCoefficients const&);
+void NV12_to_BGRA32(uint8_t const* y_row0, uint8_t const* y_row1, uint8_t const* uv_row, uint8_t* bgra_row0, uint8_t* bgra_row1, uint32_t width, YUVCoefficients const&);
+void YUYV_to_GREY8(uint8_t const* yuyv, uint8_t* grey, uint32_t width);
+void YUYV_to_NV12(uint8_t const* yuyv_row0, uint8_t const* yuyv_row1, uint8_t* y_row0, uint8_t* y_row1, uint8_t* uv_row, uint32_t width);
+void YUYV_to_I420(uint8_t const* yuyv_row0, uint8_t const* yuyv_row1, uint8_t* y_row0, uint8_t* y_row1, uint8_t* u_row, uint8_t* v_row, uint32_t width);
+void blend_rows(uint8_t const* row0, uint8_t const* row1, uint8_t* out, size_t length, uint32_t weight);
+void add_row(uint8_t const* row, uint16_t* sums, size_t length);
+} // namespace avx2
+#endif
+
+#if WCAM_ARCH_NEON
+namespace neon {
+void YUYV_to_RGB24(uint8_t const* yuyv, uint8_t* rgb, uint32_t width, YUVCoefficients const&);
+void YUYV_to_BGR24(uint8_t const* yuyv, uint8_t* bgr, uint32_t width, YUVCoefficients const&);
+void YUYV_to_RGBA32(uint8_t const* yuyv, uint8_t* rgba, uint32_t width, YUVCoefficients const&);
+void YUYV_to_BGRA32(uint8_t const* yuyv, uint8_t* bgra, uint32_t width, YUVCoefficients const&);
+void NV12_to_RGB24(uint8_t const* y_row0, uint8_t const* y_row1, uint8_t const* uv_row, uint8_t* rgb_row0, uint8_t* rgb_row1, uint32_t width, YUVCoefficients const&);
+void NV12_to_BGR24(uint8_t const* y_row0, uint8_t const* y_row1, uint8_t const* uv_row, uint8_t* bgr_row0, uint8_t* bgr_row1, uint32_t width, YUVCoefficients const&);
+void NV12_to_RGBA32(uint8_t const* y_row0, uint8_t const* y_row1, uint8_t const* uv_row, uint8_t* rgba_row0, uint8_t* rgba_row1, uint32_t width, YUVCoefficients const&);
+void NV12_to_BGRA32(uint8_t const* y_row0, uint8_t const* y_row1, uint8_t const* uv_row, uint8_t* bgra_row0, uint8_t* bgra_row1, uint32_t width, YUVCoefficients const&);
+void swap_red_and_blue(uint8_t const* bgr, uint8_t* rgb, uint32_t width);
+void add_alpha(uint8_t const* rgb, uint8_t* rgba, uint32_t width);
+void add_alpha_and_swap_red_and_blue(uint8_t const* bgr, uint8_t* rgba, uint32_t width);
+void YUYV_to_GREY8(uint8_t const* yuyv, uint8_t* grey, uint32_t width);
+void GREY8_to_RGB24(uint8_t const* grey, uint8_t* rgb, uint32_t width);
+void GREY8_to_RGBA32(uint8_t const* grey, uint8_t* rgba, uint32_t width);
+void YUYV_to_NV12(uint8_t const* yuyv_row0, uint8_t const* yuyv_row1, uint8_t* y_row0, uint8_t* y_row1, uint8_t* uv_row, uint32_t width);
+void YUYV_to_I420(uint8_t const* yuyv_row0, uint8_t const* yuyv_row1, uint8_t* y_row0, uint8_t* y_row1, uint8_t* u_row, uint8_t* v_row, uint32_t width);
+void split_chroma(uint8_t const* uv, uint8_t* u, uint8_t* v, uint32_t count);
+void merge_chroma(uint8_t const* u, uint8_t const* v, uint8_t* uv, uint32_t count);
+void merge_to_YUYV(uint8_t const* y, uint8_t const* u, uint8_t const* v, uint8_t* yuyv, uint32_t width);
+void blend_rows(uint8_t const* row0, uint8_t const* row1, uint8_t* out, size_t length, uint32_t weight);
+void add_row(uint8_t const* row, uint16_t* sums, size_t length);
+void average_row(uint16_t const* sums, uint8_t* out, size_t length, uint32_t reciprocal);
+} // namespace neon
+#endif
+
+} // namespace wcam::internal
\ No newline at end of file
@@ -0,0 +1,330 @@
+#include "row_conversions.hpp"
+#if WCAM_ARCH_NEON
+#include <arm_neon.h>
+#include <utility>
+
+namespace wcam::internal::neon {
+
+/// Index of the red and blue channels in a pixel
+template<ChannelOrder order>
+static constexpr int R = order == ChannelOrder::RGB || order == ChannelOrder::RGBA ? 0 : 2;
+template<ChannelOrder order>
+static constexpr int B = 2 - R<order>;
+
+/// (luma + chroma) >> 8 for 8 pixels, computed on 32 bits, and saturated to [0, 255]
+static inline auto channel(int32x4_t luma_lo, int32x4_t luma_hi, int32x4x2_t chroma) -> uint8x8_t
+{
+    return vqmovun_s16(vcombine_s16(
+        vshrn_n_s32(vaddq_s32(luma_lo, chroma.val[0]), 8),
+        vshrn_n_s32(vaddq_s32(luma_hi, chroma.val[1]), 8)
+    ));
+}
+
+/// Converts 16 pixels. The chroma terms have one value per pixel, and are in RGB order.
+template<ChannelOrder order>
+static inline void store_16_pixels(uint8x16_t y, uint8_t* rgb, int32x4x2_t const (&chroma)[3][2], YUVCoefficients const& coefs) // NOLINT(*c-arrays)
+{
+    int16x8_t const lo = vsubq_s16(vreinterpretq_s16_u16(vmovl_u8(vget_low_u8(y))), vdupq_n_s16(coefs.y_offset));
+    int16x8_t const hi = vsubq_s16(vreinterpretq_s16_u16(vmovl_u8(vget_high_u8(y))), vdupq_n_s16(coefs.y_offset));
+
+    // y * (Y - y_offset) + 128
+    int32x4_t const offset = vdupq_n_s32(128);
+    int32x4_t const luma0  = vmlaq_n_s32(offset, vmovl_s16(vget_low_s16(lo)), coefs.y);
+    int32x4_t const luma1  = vmlaq_n_s32(offset, vmovl_s16(vget_high_s16(lo)), coefs.y);
+    int32x4_t const luma2  = vmlaq_n_s32(offset, vmovl_s16(vget_low_s16(hi)), coefs.y);
+    int32x4_t const luma3  = vmlaq_n_s32(offset, vmovl_s16(vget_high_s16(hi)), coefs.y);
+
+    uint8x16_t const r = vcombine_u8(channel(luma0, luma1, chroma[0][0]), channel(luma2, luma3, chroma[0][1]));
+    uint8x16_t const g = vcombine_u8(channel(luma0, luma1, chroma[1][0]), channel(luma2, luma3, chroma[1][1]));
+    uint8x16_t const b = vcombine_u8(channel(luma0, luma1, chroma[2][0]), channel(luma2, luma3, chroma[2][1]));
+    if constexpr (pixel_size<order> == 3)
+    {
+        auto out          = uint8x16x3_t{};
+        out.val[R<order>] = r;
+        out.val[1]        = g;
+        out.val[B<order>] = b;
+        vst3q_u8(rgb, out);
+    }
+    else
+    {
+        auto out          = uint8x16x4_t{};
+        out.val[R<order>] = r;
+        out.val[1]        = g;
+        out.val[B<order>] = b;
+        out.val[3]        = vdupq_n_u8(255);
+        vst4q_u8(rgb, out);
+    }
+}
+
+/// Computes (u * u_coef + v * v_coef) on 32 bits, once per pair, and duplicates it for the two pixels of each row that use it
+static inline void duplicated_chroma_term(int16x8_t u, int16x8_t v, int16_t u_coef, int16_t v_coef, int32x4x2_t (&res)[2]) // NOLINT(*c-arrays)
+{
+    int32x4_t const lo = vmlal_n_s16(vmull_n_s16(vget_low_s16(u), u_coef), vget_low_s16(v), v_coef);   // Pairs 0 to 3
+    int32x4_t const hi = vmlal_n_s16(vmull_n_s16(vget_high_s16(u), u_coef), vget_high_s16(v), v_coef); // Pairs 4 to 7
+    res[0]             = vzipq_s32(lo, lo);                                                               // Pixels 0 to 7
+    res[1]             = vzipq_s32(hi, hi);                                                               // Pixels 8 to 15
+}
+
+/// The chroma terms of 8 (u, v) pairs, for the 16 pixels that use them. [channel][pixels 0 to 7, pixels 8 to 15]
+static inline void chroma_terms(uint8x8_t u8, uint8x8_t v8, YUVCoefficients const& coefs, int32x4x2_t (&chroma)[3][2]) // NOLINT(*c-arrays)
+{
+    int16x8_t const u = vreinterpretq_s16_u16(vsubl_u8(u8, vdup_n_u8(128)));
+    int16x8_t const v = vreinterpretq_s16_u16(vsubl_u8(v8, vdup_n_u8(128)));
+    duplicated_chroma_term(u, v, 0, coefs.r_v, chroma[0]);
+    duplicated_chroma_term(u, v, coefs.g_u, coefs.g_v, chroma[1]);
+    duplicated_chroma_term(u, v, coefs.b_u, 0, chroma[2]);
+}
+
+// Same maths as the x86 version, on 32 bits, which gives the exact same results as the scalar version
+template<ChannelOrder order>
+static void YUYV_to_pixels(uint8_t const* yuyv, uint8_t* rgb, uint32_t width, YUVCoefficients const& coefs)
+{
+    uint32_t x = 0;
+    for (; x + 16 <= width; x += 16)
+    {
+        uint8x8x4_t const in = vld4_u8(yuyv + x * 2); // NOLINT(*pointer-arithmetic) Deinterleaves into Y of even pixels, U, Y of odd pixels, V
+        uint8x8x2_t const y  = vzip_u8(in.val[0], in.val[2]);
+
+        int32x4x2_t chroma[3][2]; // NOLINT(*c-arrays, *member-init)
+        chroma_terms(in.val[1], in.val[3], coefs, chroma);
+        store_16_pixels<order>(vcombine_u8(y.val[0], y.val[1]), rgb + x * pixel_size<order>, chroma, coefs); // NOLINT(*pointer-arithmetic)
+    }
+    scalar::YUYV_to<order>(yuyv + x * 2, rgb + x * pixel_size<order>, width - x, coefs); // NOLINT(*pointer-arithmetic)
+}
+
+template<ChannelOrder order>
+static void NV12_to_pixels(uint8_t const* y_row0, uint8_t const* y_row1, uint8_t const* uv_row, uint8_t* rgb_row0, uint8_t* rgb_row1, uint32_t width, YUVCoefficients const& coefs)
+{
+    uint32_t x = 0;
+    for (; x + 16 <= width; x += 16)
+    {
+        uint8x8x2_t const uv = vld2_u8(uv_row + x); // NOLINT(*pointer-arithmetic) Deinterleaves into 8 U and 8 V
+
+        int32x4x2_t chroma[3][2]; // NOLINT(*c-arrays, *member-init)
+        chroma_terms(uv.val[0], uv.val[1], coefs, chroma);
+        store_16_pixels<order>(vld1q_u8(y_row0 + x), rgb_row0 + x * pixel_size<order>, chroma, coefs); // NOLINT(*pointer-arithmetic)
+        store_16_pixels<order>(vld1q_u8(y_row1 + x), rgb_row1 + x * pixel_size<order>, chroma, coefs); // NOLINT(*pointer-arithmetic)
+    }
+    scalar::NV12_to<order>(y_row0 + x, y_row1 + x, uv_row + x, rgb_row0 + x * pixel_size<order>, rgb_row1 + x * pixel_size<order>, width - x, coefs); // NOLINT(*pointer-arithmetic)
+}
+
+void swap_red_and_blue(uint8_t const* bgr, uint8_t* rgb, uint32_t width)
+{
+    uint32_t x = 0;
+    for (; x + 16 <= width; x += 16)
+    {
+        uint8x16x3_t pixels = vld3q_u8(bgr + x * 3); // NOLINT(*pointer-arithmetic) Deinterleaves into B, G and R
+        std::swap(pixels.val[0], pixels.val[2]);
+        vst3q_u8(rgb + x * 3, pixels); // NOLINT(*pointer-arithmetic)
+    }
+    scalar::swap_red_and_blue(bgr + x * 3, rgb + x * 3, width - x); // NOLINT(*pointer-arithmetic)
+}
+
+void add_alpha(uint8_t const* rgb, uint8_t* rgba, uint32_t width)
+{
+    uint32_t x = 0;
+    for (; x + 16 <= width; x += 16)
+    {
+        uint8x16x3_t const in  = vld3q_u8(rgb + x * 3); // NOLINT(*pointer-arithmetic)
+        uint8x16x4_t const out = {{in.val[0], in.val[1], in.val[2], vdupq_n_u8(255)}};
+        vst4q_u8(rgba + x * 4, out); // NOLINT(*pointer-arithmetic)
+    }
+    scalar::add_alpha(rgb + x * 3, rgba + x * 4, width - x); // NOLINT(*pointer-arithmetic)
+}
+
+void add_alpha_and_swap_red_and_blue(uint8_t const* bgr, uint8_t* rgba, uint32_t width)
+{
+    uint32_t x = 0;
+    for (; x + 16 <= width; x += 16)
+    {
+        uint8x16x3_t const in  = vld3q_u8(bgr + x * 3); // NOLINT(*pointer-arithmetic)
+        uint8x16x4_t const out = {{in.val[2], in.val[1], in.val[0], vdupq_n_u8(255)}};
+        vst4q_u8(rgba + x * 4, out); // NOLINT(*pointer-arithmetic)
+    }
+    scalar::add_alpha_and_swap_red_and_blue(bgr + x * 3, rgba + x * 4, width - x); // NOLINT(*pointer-arithmetic)
+}
+
+void YUYV_to_GREY8(uint8_t const* yuyv, uint8_t* grey, uint32_t width)
+{
+    uint32_t x = 0;
+    for (; x + 16 <= width; x += 16)
+        vst1q_u8(grey + x, vld2q_u8(yuyv + x * 2).val[0]); // NOLINT(*pointer-arithmetic) Deinterleaves into 16 Y and 16 (u or v)
+    scalar::YUYV_to_GREY8(yuyv + x * 2, grey + x, width - x); // NOLINT(*pointer-arithmetic)
+}
+
+void YUYV_to_NV12(uint8_t const* yuyv_row0, uint8_t const* yuyv_row1, uint8_t* y_row0, uint8_t* y_row1, uint8_t* uv_row, uint32_t width)
+{
+    uint32_t x = 0;
+    for (; x + 16 <= width; x += 16)
+    {
+        uint8x8x4_t const row0 = vld4_u8(yuyv_row0 + x * 2); // NOLINT(*pointer-arithmetic) Deinterleaves into y0, u, y1, v
+        uint8x8x4_t const row1 = vld4_u8(yuyv_row1 + x * 2); // NOLINT(*pointer-arithmetic)
+        vst2_u8(y_row0 + x, uint8x8x2_t{{row0.val[0], row0.val[2]}}); // NOLINT(*pointer-arithmetic)
+        vst2_u8(y_row1 + x, uint8x8x2_t{{row1.val[0], row1.val[2]}}); // NOLINT(*pointer-arithmetic)
+        vst2_u8(uv_row + x, uint8x8x2_t{{vrhadd_u8(row0.val[1], row1.val[1]), vrhadd_u8(row0.val[3], row1.val[3])}}); // NOLINT(*pointer-arithmetic)
+    }
+    scalar::YUYV_to_NV12(yuyv_row0 + x * 2, yuyv_row1 + x * 2, y_row0 + x, y_row1 + x, uv_row + x, width - x); // NOLINT(*pointer-arithmetic)
+}
+
+void YUYV_to_I420(uint8_t const* yuyv_row0, uint8_t const* yuyv_row1, uint8_t* y_row0, uint8_t* y_row1, uint8_t* u_row, uint8_t* v_row, uint32_t width)
+{
+    uint32_t x = 0;
+    for (; x + 16 <= width; x += 16)
+    {
+        uint8x8x4_t const row0 = vld4_u8(yuyv_row0 + x * 2); // NOLINT(*pointer-arithmetic) Deinterleaves into y0, u, y1, v
+        uint8x8x4_t const row1 = vld4_u8(yuyv_row1 + x * 2); // NOLINT(*pointer-arithmetic)
+        vst2_u8(y_row0 + x, uint8x8x2_t{{row0.val[0], row0.val[2]}}); // NOLINT(*pointer-arithmetic)
+        vst2_u8(y_row1 + x, uint8x8x2_t{{row1.val[0], row1.val[2]}}); // NOLINT(*pointer-arithmetic)
+        vst1_u8(u_row + x / 2, vrhadd_u8(row0.val[1], row1.val[1])); // NOLINT(*pointer-arithmetic)
+        vst1_u8(v_row + x / 2, vrhadd_u8(row0.val[3], row1.val[3])); // NOLINT(*pointer-arithmetic)
+    }
+    scalar::YUYV_to_I420(yuyv_row0 + x * 2, yuyv_row1 + x * 2, y_row0 + x, y_row1 + x, u_row + x / 2, v_row + x / 2, width - x); // NOLINT(*pointer-arithmetic)
+}
+
+void split_chroma(uint8_t const* uv, uint8_t* u, uint8_t* v, uint32_t count)
+{
+    uint32_t i = 0;
+    for (; i + 16 <= count; i += 16)
+    {
+        uint8x16x2_t const chroma = vld2q_u8(uv + i * 2); // NOLINT(*pointer-arithmetic)
+        vst1q_u8(u + i, chroma.val[0]); // NOLINT(*pointer-arithmetic)
+        vst1q_u8(v + i, chroma.val[1]); // NOLINT(*pointer-arithmetic)
+    }
+    scalar::split_chroma(uv + i * 2, u + i, v + i, count - i); // NOLINT(*pointer-arithmetic)
+}
+
+void merge_chroma(uint8_t const* u, uint8_t const* v, uint8_t* uv, uint32_t count)
+{
+    uint32_t i = 0;
+    for (; i + 16 <= count; i += 16)
+        vst2q_u8(uv + i * 2, uint8x16x2_t{{vld1q_u8(u + i), vld1q_u8(v + i)}}); // NOLINT(*pointer-arithmetic)
+    scalar::merge_chroma(u + i, v + i, uv + i * 2, count - i); // NOLINT(*pointer-arithmetic)
+}
+
+void merge_to_YUYV(uint8_t const* y, uint8_t const* u, uint8_t const* v, uint8_t* yuyv, uint32_t width)
+{
+    uint32_t x = 0;
+    for (; x + 32 <= width; x += 32)
+    {
+        uint8x16x2_t const luma = vld2q_u8(y + x); // NOLINT(*pointer-arithmetic) The Y samples of the even and of the odd pixels
+        vst4q_u8(yuyv + x * 2, uint8x16x4_t{{luma.val[0], vld1q_u8(u + x / 2), luma.val[1], vld1q_u8(v + x / 2)}}); // NOLINT(*pointer-arithmetic)
+    }
+    scalar::merge_to_YUYV(y + x, u + x / 2, v + x / 2, yuyv + x * 2, width - x); // NOLINT(*pointer-arithmetic)
+}
+
+void GREY8_to_RGB24(uint8_t const* grey, uint8_t* rgb, uint32_t width)
+{
+    uint32_t x = 0;
+    for (; x + 16 <= width; x += 16)
+    {
+        uint8x16_t const g = vld1q_u8(grey + x); // NOLINT(*pointer-arithmetic)
+        vst3q_u8(rgb + x * 3, uint8x16x3_t{{g, g, g}}); // NOLINT(*pointer-arithmetic)
+    }
+    scalar::GREY8_to_RGB24(grey + x, rgb + x * 3, width - x); // NOLINT(*pointer-arithmetic)
+}
+
+void GREY8_to_RGBA32(uint8_t const* grey, uint8_t* rgba, uint32_t width)
+{
+    uint32_t x = 0;
+    for (; x + 16 <= width; x += 16)
+    {
+        uint8x16_t const g = vld1q_u8(grey + x); // NOLINT(*pointer-arithmetic)
+        vst4q_u8(rgba + x * 4, uint8x16x4_t{{g, g, g, vdupq_n_u8(255)}}); // NOLINT(*pointer-arithmetic)
+    }
+    scalar::GREY8_to_RGBA32(grey + x, rgba + x * 4, width - x); // NOLINT(*pointer-arithmetic)
+}
+
+/// a * (256 - w) + b * w, computed as (a << 8) - a * w + b * w because 256 doesn't fit in 8 bits. The rounding shift adds the 128.
+static inline auto blend(uint8x8_t a, uint8x8_t b, uint8x8_t weight) -> uint8x8_t
+{
+    return vrshrn_n_u16(vmlal_u8(vmlsl_u8(vshll_n_u8(a, 8), a, weight), b, weight), 8);
+}
+
+void blend_rows(uint8_t const* row0, uint8_t const* row1, uint8_t* out, size_t length, uint32_t weight)
+{
+    uint8x8_t const weight1 = vdup_n_u8(static_cast<uint8_t>(weight));
+
+    size_t i = 0;
+    for (; i + 16 <= length; i += 16)
+    {
+        uint8x16_t const a = vld1q_u8(row0 + i); // NOLINT(*pointer-arithmetic)
+        uint8x16_t const b = vld1q_u8(row1 + i); // NOLINT(*pointer-arithmetic)
+        vst1q_u8(out + i, vcombine_u8(blend(vget_low_u8(a), vget_low_u8(b), weight1), blend(vget_high_u8(a), vget_high_u8(b), weight1))); // NOLINT(*pointer-arithmetic)
+    }
+    scalar::blend_rows(row0 + i, row1 + i, out + i, length - i, weight); // NOLINT(*pointer-arithmetic)
+}
+
+void add_row(uint8_t const* row, uint16_t* sums, size_t length)
+{
+    size_t i = 0;
+    for (; i + 16 <= length; i += 16)
+    {
+        uint8x16_t const in = vld1q_u8(row + i);                                  // NOLINT(*pointer-arithmetic)
+        vst1q_u16(sums + i, vaddw_u8(vld1q_u16(sums + i), vget_low_u8(in)));     // NOLINT(*pointer-arithmetic)
+        vst1q_u16(sums + i + 8, vaddw_u8(vld1q_u16(sums + i + 8), vget_high_u8(in))); // NOLINT(*pointer-arithmetic)
+    }
+    scalar::add_row(row + i, sums + i, length - i); // NOLINT(*pointer-arithmetic)
+}
+
+/// (sums * multiplier + 32768) / 65536, for 8 sums. The rounding shift adds the 32768.
+static inline auto average(uint16x8_t sums, uint16_t multiplier) -> uint8x8_t
+{
+    return vqmovn_u16(vcombine_u16(
+        vrshrn_n_u32(vmull_n_u16(vget_low_u16(sums), multiplier), 16),
+        vrshrn_n_u32(vmull_n_u16(vget_high_u16(sums), multiplier), 16)
+    ));
+}
+
+void average_row(uint16_t const* sums, uint8_t* out, size_t length, uint32_t reciprocal)
+{
+    auto const multiplier = static_cast<uint16_t>(reciprocal);
+
+    size_t i = 0;
+    for (; i + 16 <= length; i += 16)
+        vst1q_u8(out + i, vcombine_u8(average(vld1q_u16(sums + i), multiplier), average(vld1q_u16(sums + i + 8), multiplier))); // NOLINT(*pointer-arithmetic)
+    scalar::average_row(sums + i, out + i, length - i, reciprocal); // NOLINT(*pointer-arithmetic)
+}
+
+void YUYV_to_RGB24(uint8_t const* yuyv, uint8_t* rgb, uint32_t width, YUVCoefficients const& coefs)
+{
+    YUYV_to_pixels<ChannelOrder::RGB>(yuyv, rgb, width, coefs);
+}
+
+void YUYV_to_BGR24(uint8_t const* yuyv, uint8_t* bgr, uint32_t width, YUVCoefficients const& coefs)
+{
+    YUYV_to_pixels<ChannelOrder::BGR>(yuyv, bgr, width, coefs);
+}
+
+void YUYV_to_RGBA32(uint8_t const* yuyv, uint8_t* rgba, uint32_t width, YUVCoefficients const& coefs)
+{
+    YUYV_to_pixels<ChannelOrder::RGBA>(yuyv, rgba, width, coefs);
+}
+
+void YUYV_to_BGRA32(uint8_t const* yuyv, uint8_t* bgra, uint32_t width, YUVCoefficients const& coefs)
+{
+    YUYV_to_pixels<ChannelOrder::BGRA>(yuyv, bgra, width, coefs);
+}
+
+void NV12_to_RGB24(uint8_t const* y_row0, uint8_t const* y_row1, uint8_t const* uv_row, uint8_t* rgb_row0, uint8_t* rgb_row1, uint32_t width, YUVCoefficients const& coefs)
+{
+    NV12_to_pixels<ChannelOrder::RGB>(y_row0, y_row1, uv_row, rgb_row0, rgb_row1, width, coefs);
+}
+
+void NV12_to_BGR24(uint8_t const* y_row0, uint8_t const* y_row1, uint8_t const* uv_row, uint8_t* bgr_row0, uint8_t* bgr_row1, uint32_t width, YUVCoefficients const& coefs)
+{
+    NV12_to_pixels<ChannelOrder::BGR>(y_row0, y_row1, uv_row, bgr_row0, bgr_row1, width, coefs);
+}
+
+void NV12_to_RGBA32(uint8_t const* y_row0, uint8_t const* y_row1, uint8_t const* uv_row, uint8_t* rgba_row0, uint8_t* rgba_row1, uint32_t width, YUVCoefficients const& coefs)
+{
+    NV12_to_pixels<ChannelOrder::RGBA>(y_row0, y_row1, uv_row, rgba_row0, rgba_row1, width, coefs);
+}
+
+void NV12_to_BGRA32(uint8_t const* y_row0, uint8_t const* y_row1, uint8_t const* uv_row, uint8_t* bgra_row0, uint8_t* bgra_row1, uint32_t width, YUVCoefficients const& coefs)
+{
+    NV12_to_pixels<ChannelOrder::BGRA>(y_row0, y_row1, uv_row, bgra_row0, bgra_row1, width, coefs);
+}
+
+} // namespace wcam::internal::neon
+
+#endif
\ No newline at end of file
@@ -0,0 +1,288 @@
+#include <algorithm>
+#include "row_conversions.hpp"
+
+namespace wcam::internal::scalar {
+
+/// Index of the red and blue channels in a pixel
+template<ChannelOrder order>
+static constexpr uint32_t R = order == ChannelOrder::RGB || order == ChannelOrder::RGBA ? 0 : 2;
+template<ChannelOrder order>
+static constexpr uint32_t B = 2 - R<order>;
+
+static auto clamp_to_byte(int x) -> uint8_t
+{
+    return static_cast<uint8_t>(std::clamp(x, 0, 255));
+}
+
+/// The terms that only depend on the chroma, shared by all the pixels that use the same (u, v) pair
+struct ChromaTerms {
+    int r;
+    int g;
+    int b;
+};
+
+static auto chroma_terms(uint8_t u, uint8_t v, YUVCoefficients const& coefs) -> ChromaTerms
+{
+    int const D = u - 128;
+    int const E = v - 128;
+    return {
+        .r = coefs.r_v * E + 128,
+        .g = coefs.g_u * D + coefs.g_v * E + 128,
+        .b = coefs.b_u * D + 128,
+    };
+}
+
+template<ChannelOrder order>
+static void write_pixel(uint8_t* rgb, uint8_t y, ChromaTerms const& chroma, YUVCoefficients const& coefs)
+{
+    int const C = coefs.y * (y - coefs.y_offset);
+
+    rgb[R<order>] = clamp_to_byte((C + chroma.r) >> 8); // NOLINT(*pointer-arithmetic)
+    rgb[1]        = clamp_to_byte((C + chroma.g) >> 8); // NOLINT(*pointer-arithmetic)
+    rgb[B<order>] = clamp_to_byte((C + chroma.b) >> 8); // NOLINT(*pointer-arithmetic)
+    if constexpr (pixel_size<order> == 4)
+        rgb[3] = 255; // NOLINT(*pointer-arithmetic)
+}
+
+template<ChannelOrder order>
+static void YUYV_to_pixels(uint8_t const* yuyv, uint8_t* rgb, uint32_t width, YUVCoefficients const& coefs)
+{
+    for (uint32_t x = 0; x + 1 < width; x += 2)
+    {
+        auto const chroma = chroma_terms(yuyv[x * 2 + 1], yuyv[x * 2 + 3], coefs);            // NOLINT(*pointer-arithmetic)
+        write_pixel<order>(rgb + x * pixel_size<order>, yuyv[x * 2 + 0], chroma, coefs);       // NOLINT(*pointer-arithmetic)
+        write_pixel<order>(rgb + (x + 1) * pixel_size<order>, yuyv[x * 2 + 2], chroma, coefs); // NOLINT(*pointer-arithmetic)
+    }
+}
+
+template<ChannelOrder order>
+static void NV12_to_pixels(uint8_t const* y_row0, uint8_t const* y_row1, uint8_t const* uv_row, uint8_t* rgb_row0, uint8_t* rgb_row1, uint32_t width, YUVCoefficients const& coefs)
+{
+    for (uint32_t x = 0; x < width; x += 2)
+    {
+        auto const chroma = chroma_terms(uv_row[x], uv_row[x + 1], coefs); // NOLINT(*pointer-arithmetic)
+        for (uint32_t pixel = x; pixel < x + 2 && pixel < width; ++pixel)
+        {
+            write_pixel<order>(rgb_row0 + pixel * pixel_size<order>, y_row0[pixel], chroma, coefs); // NOLINT(*pointer-arithmetic)
+            write_pixel<order>(rgb_row1 + pixel * pixel_size<order>, y_row1[pixel], chroma, coefs); // NOLINT(*pointer-arithmetic)
+        }
+    }
+}
+
+void swap_red_and_blue(uint8_t const* bgr, uint8_t* rgb, uint32_t width)
+{
+    for (uint32_t x = 0; x < width; ++x)
+    {
+        // Read all the channels before writing, so that this works in place
+        uint8_t const b = bgr[x * 3 + 0]; // NOLINT(*pointer-arithmetic)
+        uint8_t const g = bgr[x * 3 + 1]; // NOLINT(*pointer-arithmetic)
+        uint8_t const r = bgr[x * 3 + 2]; // NOLINT(*pointer-arithmetic)
+        rgb[x * 3 + 0]  = r;              // NOLINT(*pointer-arithmetic)
+        rgb[x * 3 + 1]  = g;              // NOLINT(*pointer-arithmetic)
+        rgb[x * 3 + 2]  = b;              // NOLINT(*pointer-arithmetic)
+    }
+}
+
+/// Copies the channels from 3 to 4 bytes pixels, or the other way around
+template<uint32_t in_size, uint32_t out_size, bool swap_red_and_blue>
+static void repack(uint8_t const* in, uint8_t* out, uint32_t width)
+{
+    constexpr uint32_t r = swap_red_and_blue ? 2 : 0;
+    for (uint32_t x = 0; x < width; ++x)
+    {
+        out[x * out_size + 0] = in[x * in_size + r];     // NOLINT(*pointer-arithmetic)
+        out[x * out_size + 1] = in[x * in_size + 1];     // NOLINT(*pointer-arithmetic)
+        out[x * out_size + 2] = in[x * in_size + 2 - r]; // NOLINT(*pointer-arithmetic)
+        if constexpr (out_size == 4)
+            out[x * out_size + 3] = 255; // NOLINT(*pointer-arithmetic)
+    }
+}
+
+void add_alpha(uint8_t const* rgb, uint8_t* rgba, uint32_t width)
+{
+    repack<3, 4, false>(rgb, rgba, width);
+}
+
+void add_alpha_and_swap_red_and_blue(uint8_t const* bgr, uint8_t* rgba, uint32_t width)
+{
+    repack<3, 4, true>(bgr, rgba, width);
+}
+
+void remove_alpha(uint8_t const* rgba, uint8_t* rgb, uint32_t width)
+{
+    repack<4, 3, false>(rgba, rgb, width);
+}
+
+void remove_alpha_and_swap_red_and_blue(uint8_t const* bgra, uint8_t* rgb, uint32_t width)
+{
+    repack<4, 3, true>(bgra, rgb, width);
+}
+
+void YUYV_to_GREY8(uint8_t const* yuyv, uint8_t* grey, uint32_t width)
+{
+    for (uint32_t x = 0; x < width; ++x)
+        grey[x] = yuyv[x * 2]; // NOLINT(*pointer-arithmetic)
+}
+
+/// Copies the grey value to the 3 color channels
+template<uint32_t out_size>
+static void expand_grey(uint8_t const* grey, uint8_t* out, uint32_t width)
+{
+    for (uint32_t x = 0; x < width; ++x)
+    {
+        out[x * out_size + 0] = grey[x]; // NOLINT(*pointer-arithmetic)
+        out[x * out_size + 1] = grey[x]; // NOLINT(*pointer-arithmetic)
+        out[x * out_size + 2] = grey[x]; // NOLINT(*pointer-arithmetic)
+        if constexpr (out_size == 4)
+            out[x * out_size + 3] = 255; // NOLINT(*pointer-arithmetic)
+    }
+}
+
+void GREY8_to_RGB24(uint8_t const* grey, uint8_t* rgb, uint32_t width)
+{
+    expand_grey<3>(grey, rgb, width);
+}
+
+void GREY8_to_RGBA32(uint8_t const* grey, uint8_t* rgba, uint32_t width)
+{
+    expand_grey<4>(grey, rgba, width);
+}
+
+/// The luma of BT.601, with 8 bits of precision
+template<uint32_t r>
+static void luma(uint8_t const* in, uint8_t* grey, uint32_t width)
+{
+    for (uint32_t x = 0; x < width; ++x)
+        grey[x] = static_cast<uint8_t>((77 * in[x * 3 + r] + 150 * in[x * 3 + 1] + 29 * in[x * 3 + 2 - r] + 128) >> 8); // NOLINT(*pointer-arithmetic)
+}
+
+void RGB24_to_GREY8(uint8_t const* rgb, uint8_t* grey, uint32_t width)
+{
+    luma<0>(rgb, grey, width);
+}
+
+void BGR24_to_GREY8(uint8_t const* bgr, uint8_t* grey, uint32_t width)
+{
+    luma<2>(bgr, grey, width);
+}
+
+/// The rounded average of two chroma samples of vertically adjacent pixels
+static auto average(uint8_t a, uint8_t b) -> uint8_t
+{
+    return static_cast<uint8_t>((a + b + 1) >> 1);
+}
+
+void YUYV_to_NV12(uint8_t const* yuyv_row0, uint8_t const* yuyv_row1, uint8_t* y_row0, uint8_t* y_row1, uint8_t* uv_row, uint32_t width)
+{
+    for (uint32_t x = 0; x + 1 < width; x += 2)
+    {
+        y_row0[x]     = yuyv_row0[x * 2 + 0];                                // NOLINT(*pointer-arithmetic)
+        y_row0[x + 1] = yuyv_row0[x * 2 + 2];                                // NOLINT(*pointer-arithmetic)
+        y_row1[x]     = yuyv_row1[x * 2 + 0];                                // NOLINT(*pointer-arithmetic)
+        y_row1[x + 1] = yuyv_row1[x * 2 + 2];                                // NOLINT(*pointer-arithmetic)
+        uv_row[x]     = average(yuyv_row0[x * 2 + 1], yuyv_row1[x * 2 + 1]); // NOLINT(*pointer-arithmetic)
+        uv_row[x + 1] = average(yuyv_row0[x * 2 + 3], yuyv_row1[x * 2 + 3]); // NOLINT(*pointer-arithmetic)
+    }
+}
+
+void YUYV_to_I420(uint8_t const* yuyv_row0, uint8_t const* yuyv_row1, uint8_t* y_row0, uint8_t* y_row1, uint8_t* u_row, uint8_t* v_row, uint32_t width)
+{
+    for (uint32_t x = 0; x + 1 < width; x += 2)
+    {
+        y_row0[x]     = yuyv_row0[x * 2 + 0];                                // NOLINT(*pointer-arithmetic)
+        y_row0[x + 1] = yuyv_row0[x * 2 + 2];                                // NOLINT(*pointer-arithmetic)
+        y_row1[x]     = yuyv_row1[x * 2 + 0];                                // NOLINT(*pointer-arithmetic)
+        y_row1[x + 1] = yuyv_row1[x * 2 + 2];                                // NOLINT(*pointer-arithmetic)
+        u_row[x / 2]  = average(yuyv_row0[x * 2 + 1], yuyv_row1[x * 2 + 1]); // NOLINT(*pointer-arithmetic)
+        v_row[x / 2]  = average(yuyv_row0[x * 2 + 3], yuyv_row1[x * 2 + 3]); // NOLINT(*pointer-arithmetic)
+    }
+}
+
+void split_chroma(uint8_t const* uv, uint8_t* u, uint8_t* v, uint32_t count)
+{
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        u[i] = uv[i * 2 + 0]; // NOLINT(*pointer-arithmetic)
+        v[i] = uv[i * 2 + 1]; // NOLINT(*pointer-arithmetic)
+    }
+}
+
+void merge_chroma(uint8_t const* u, uint8_t const* v, uint8_t* uv, uint32_t count)
+{
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        uv[i * 2 + 0] = u[i]; // NOLINT(*pointer-arithmetic)
+        uv[i * 2 + 1] = v[i]; // NOLINT(*pointer-arithmetic)
+    }
+}
+
+void merge_to_YUYV(uint8_t const* y, uint8_t const* u, uint8_t const* v, uint8_t* yuyv, uint32_t width)
+{
+    for (uint32_t x = 0; x < width; x += 2)
+    {
+        yuyv[x * 2 + 0] = y[x];                            // NOLINT(*pointer-arithmetic)
+        yuyv[x * 2 + 1] = u[x / 2];                        // NOLINT(*pointer-arithmetic)
+        yuyv[x * 2 + 2] = x + 1 < width ? y[x + 1] : y[x]; // NOLINT(*pointer-arithmetic)
+        yuyv[x * 2 + 3] = v[x / 2];                        // NOLINT(*pointer-arithmetic)
+    }
+}
+
+void blend_rows(uint8_t const* row0, uint8_t const* row1, uint8_t* out, size_t length, uint32_t weight)
+{
+    for (size_t i = 0; i < length; ++i)
+        out[i] = static_cast<uint8_t>((row0[i] * (256 - weight) + row1[i] * weight + 128) >> 8); // NOLINT(*pointer-arithmetic)
+}
+
+void add_row(uint8_t const* row, uint16_t* sums, size_t length)
+{
+    for (size_t i = 0; i < length; ++i)
+        sums[i] = static_cast<uint16_t>(sums[i] + row[i]); // NOLINT(*pointer-arithmetic)
+}
+
+void average_row(uint16_t const* sums, uint8_t* out, size_t length, uint32_t reciprocal)
+{
+    for (size_t i = 0; i < length; ++i)
+        out[i] = static_cast<uint8_t>((sums[i] * reciprocal + 32768) >> 16); // NOLINT(*pointer-arithmetic)
+}
+
+void YUYV_to_RGB24(uint8_t const* yuyv, uint8_t* rgb, uint32_t width, YUVCoefficients const& coefs)
+{
+    YUYV_to_pixels<ChannelOrder::RGB>(yuyv, rgb, width, coefs);
+}
+
+void YUYV_to_BGR24(uint8_t const* yuyv, uint8_t* bgr, uint32_t width, YUVCoefficients const& coefs)
+{
+    YUYV_to_pixels<ChannelOrder::BGR>(yuyv, bgr, width, coefs);
+}
+
+void YUYV_to_RGBA32(uint8_t const* yuyv, uint8_t* rgba, uint32_t width, YUVCoefficients const& coefs)
+{
+    YUYV_to_pixels<ChannelOrder::RGBA>(yuyv, rgba, width, coefs);
+}
+
+void YUYV_to_BGRA32(uint8_t const* yuyv, uint8_t* bgra, uint32_t width, YUVCoefficients const& coefs)
+{
+    YUYV_to_pixels<ChannelOrder::BGRA>(yuyv, bgra, width, coefs);
+}
+
+void NV12_to_RGB24(uint8_t const* y_row0, uint8_t const* y_row1, uint8_t const* uv_row, uint8_t* rgb_row0, uint8_t* rgb_row1, uint32_t width, YUVCoefficients const& coefs)
+{
+    NV12_to_pixels<ChannelOrder::RGB>(y_row0, y_row1, uv_row, rgb_row0, rgb_row1, width, coefs);
+}
+
+void NV12_to_BGR24(uint8_t const* y_row0, uint8_t const* y_row1, uint8_t const* uv_row, uint8_t* bgr_row0, uint8_t* bgr_row1, uint32_t width, YUVCoefficients const& coefs)
+{
+    NV12_to_pixels<ChannelOrder::BGR>(y_row0, y_row1, uv_row, bgr_row0, bgr_row1, width, coefs);
+}
+
+void NV12_to_RGBA32(uint8_t const* y_row0, uint8_t const* y_row1, uint8_t const* uv_row, uint8_t* rgba_row0, uint8_t* rgba_row1, uint32_t width, YUVCoefficients const& coefs)
+{
+    NV12_to_pixels<ChannelOrder::RGBA>(y_row0, y_row1, uv_row, rgba_row0, rgba_row1, width, coefs);
+}
+
+void NV12_to_BGRA32(uint8_t const* y_row0, uint8_t const* y_row1, uint8_t const* uv_row, uint8_t* bgra_row0, uint8_t* bgra_row1, uint32_t width, YUVCoefficients const& coefs)
+{
+    NV12_to_pixels<ChannelOrder::BGRA>(y_row0, y_row1, uv_row, bgra_row0, bgra_row1, width, coefs);
+}
+
+} // namespace wcam::internal::scalar
\ No newline at end of file
@@ -0,0 +1,917 @@
+#include "row_conversions.hpp"
+#if WCAM_ARCH_X86
+#include <immintrin.h>
+#include <array>
+#include <cstddef>
+
+namespace wcam::internal {
+
+/// Masks that interleave 16 R, 16 G and 16 B values into the 48 bytes of 16 RGB24 pixels. masks[3 * output_register + channel]
+static constexpr auto RGB24_interleave_masks = []() {
+    auto masks = std::array<std::array<uint8_t, 16>, 9>{};
+    for (size_t output_register = 0; output_register < 3; ++output_register)
+    {
+        for (size_t i = 0; i < 16; ++i)
+        {
+            size_t const byte = output_register * 16 + i;
+            for (size_t channel = 0; channel < 3; ++channel)
+                masks[3 * output_register + channel][i] = byte % 3 == channel ? static_cast<uint8_t>(byte / 3) : 0x80; // 0x80 makes pshufb write a 0
+        }
+    }
+    return masks;
+}();
+
+WCAM_TARGET("sse4.1")
+static inline auto load_mask(size_t index) -> __m128i
+{
+    return _mm_loadu_si128(reinterpret_cast<__m128i const*>(RGB24_interleave_masks[index].data())); // NOLINT(*reinterpret-cast, *constant-array-index)
+}
+
+/// Writes 16 pixels (48 bytes)
+WCAM_TARGET("sse4.1")
+static inline void store_RGB24(uint8_t* rgb, __m128i r, __m128i g, __m128i b)
+{
+    for (size_t output_register = 0; output_register < 3; ++output_register)
+    {
+        __m128i const res = _mm_or_si128(
+            _mm_or_si128(
+                _mm_shuffle_epi8(r, load_mask(3 * output_register + 0)),
+                _mm_shuffle_epi8(g, load_mask(3 * output_register + 1))
+            ),
+            _mm_shuffle_epi8(b, load_mask(3 * output_register + 2))
+        );
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(rgb + 16 * output_register), res); // NOLINT(*reinterpret-cast, *pointer-arithmetic)
+    }
+}
+
+/// Masks that swap the first and third byte of each of the 16 pixels (48 bytes) stored in 3 registers. A pixel can straddle two registers, so each output register is built from the input registers it overlaps. masks[3 * output_register + input_register]
+static constexpr auto BGR24_swap_masks = []() {
+    auto masks = std::array<std::array<uint8_t, 16>, 9>{};
+    for (size_t output_register = 0; output_register < 3; ++output_register)
+    {
+        for (size_t i = 0; i < 16; ++i)
+        {
+            size_t const byte   = output_register * 16 + i;
+            size_t const source = byte - byte % 3 + (2 - byte % 3);
+            for (size_t input_register = 0; input_register < 3; ++input_register)
+                masks[3 * output_register + input_register][i] = source / 16 == input_register ? static_cast<uint8_t>(source % 16) : 0x80; // 0x80 makes pshufb write a 0
+        }
+    }
+    return masks;
+}();
+
+WCAM_TARGET("sse4.1")
+static inline auto swapped(__m128i in, size_t output_register, size_t input_register) -> __m128i
+{
+    return _mm_shuffle_epi8(in, _mm_loadu_si128(reinterpret_cast<__m128i const*>(BGR24_swap_masks[3 * output_register + input_register].data()))); // NOLINT(*reinterpret-cast, *constant-array-index)
+}
+
+/// Masks that spread 4 pixels of 3 bytes into 4 pixels of 4 bytes (whose alpha is 0, and must then be set with an or).
+/// masks[2 * swap_red_and_blue + first_byte / 4], where first_byte is the position of the first of the 12 input bytes in the register (0 or 4)
+static constexpr auto add_alpha_masks = []() {
+    auto masks = std::array<std::array<uint8_t, 16>, 4>{};
+    for (size_t swap = 0; swap < 2; ++swap)
+    {
+        for (size_t first_byte = 0; first_byte < 8; first_byte += 4)
+        {
+            for (size_t i = 0; i < 16; ++i)
+            {
+                size_t const pixel   = i / 4;
+                size_t const channel = i % 4;
+                size_t const source  = swap && channel != 3 ? 2 - channel : channel;
+                masks[2 * swap + first_byte / 4][i] = channel == 3 ? 0x80 : static_cast<uint8_t>(first_byte + 3 * pixel + source); // 0x80 makes pshufb write a 0
+            }
+        }
+    }
+    return masks;
+}();
+
+WCAM_TARGET("sse4.1")
+static inline auto add_alpha_mask(bool swap_red_and_blue, size_t first_byte) -> __m128i
+{
+    return _mm_loadu_si128(reinterpret_cast<__m128i const*>(add_alpha_masks[2 * static_cast<size_t>(swap_red_and_blue) + first_byte / 4].data())); // NOLINT(*reinterpret-cast, *constant-array-index)
+}
+
+/// Writes 16 pixels (64 bytes), with an opaque alpha
+WCAM_TARGET("sse4.1")
+static inline void store_RGBA32(uint8_t* rgba, __m128i r, __m128i g, __m128i b)
+{
+    __m128i const alpha = _mm_set1_epi8(-1);
+    __m128i const rg_lo = _mm_unpacklo_epi8(r, g); // (r, g) of pixels 0 to 7
+    __m128i const rg_hi = _mm_unpackhi_epi8(r, g); // (r, g) of pixels 8 to 15
+    __m128i const ba_lo = _mm_unpacklo_epi8(b, alpha);
+    __m128i const ba_hi = _mm_unpackhi_epi8(b, alpha);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(rgba), _mm_unpacklo_epi16(rg_lo, ba_lo));      // NOLINT(*reinterpret-cast)
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(rgba + 16), _mm_unpackhi_epi16(rg_lo, ba_lo)); // NOLINT(*reinterpret-cast, *pointer-arithmetic)
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(rgba + 32), _mm_unpacklo_epi16(rg_hi, ba_hi)); // NOLINT(*reinterpret-cast, *pointer-arithmetic)
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(rgba + 48), _mm_unpackhi_epi16(rg_hi, ba_hi)); // NOLINT(*reinterpret-cast, *pointer-arithmetic)
+}
+
+/// Writes 16 pixels in the given channel order
+template<ChannelOrder order>
+WCAM_TARGET("sse4.1")
+static inline void store_pixels(uint8_t* dst, __m128i r, __m128i g, __m128i b)
+{
+    if constexpr (order == ChannelOrder::RGB)
+        store_RGB24(dst, r, g, b);
+    else if constexpr (order == ChannelOrder::BGR)
+        store_RGB24(dst, b, g, r);
+    else if constexpr (order == ChannelOrder::RGBA)
+        store_RGBA32(dst, r, g, b);
+    else
+        store_RGBA32(dst, b, g, r);
+}
+
+/// Coefficients for _mm_madd_epi16 applied on (u, v) pairs
+WCAM_TARGET("sse4.1")
+static inline auto uv_coefficients(int16_t u_coef, int16_t v_coef) -> __m128i
+{
+    return _mm_set1_epi32(static_cast<int>((static_cast<uint32_t>(static_cast<uint16_t>(v_coef)) << 16) | static_cast<uint16_t>(u_coef)));
+}
+
+WCAM_TARGET("avx2")
+static inline auto uv_coefficients_256(int16_t u_coef, int16_t v_coef) -> __m256i
+{
+    return _mm256_set1_epi32(static_cast<int>((static_cast<uint32_t>(static_cast<uint16_t>(v_coef)) << 16) | static_cast<uint16_t>(u_coef)));
+}
+
+// The luma term y * (Y - y_offset) + 128 doesn't fit on 16 bits, so we do the maths on 32 bits, which gives the exact same results as the scalar version.
+// The luma term is computed with madd on (Y - y_offset, 1) pairs, and the chroma terms once per (u, v) pair, and then shared by the pixels that use it.
+// YUYV and NV12 only differ by the way they are loaded: once we have the Y of 16 pixels and their 8 (u, v) pairs, the maths are the same.
+
+/// The YUVCoefficients, loaded once per row
+struct Coefficients128 {
+    __m128i y_offset;
+    __m128i luma; // (y, 128), for madd on (Y - y_offset, 1) pairs
+    __m128i r;
+    __m128i g;
+    __m128i b;
+};
+
+WCAM_TARGET("sse4.1")
+static inline auto load_coefficients(YUVCoefficients const& coefs) -> Coefficients128
+{
+    return {
+        .y_offset = _mm_set1_epi16(coefs.y_offset),
+        .luma     = uv_coefficients(coefs.y, 128),
+        .r        = uv_coefficients(0, coefs.r_v),
+        .g        = uv_coefficients(coefs.g_u, coefs.g_v),
+        .b        = uv_coefficients(coefs.b_u, 0),
+    };
+}
+
+/// 16 values on 32 bits, one for each of the 16 pixels we process at once
+struct Terms128 {
+    __m128i values[4]; // NOLINT(*c-arrays)
+};
+
+/// `y_lo` and `y_hi` contain the Y of pixels 0 to 7 and 8 to 15, on 16 bits
+WCAM_TARGET("sse4.1")
+static inline auto luma_terms(__m128i y_lo, __m128i y_hi, Coefficients128 const& coefs) -> Terms128
+{
+    __m128i const one = _mm_set1_epi16(1);
+    y_lo              = _mm_sub_epi16(y_lo, coefs.y_offset);
+    y_hi              = _mm_sub_epi16(y_hi, coefs.y_offset);
+    return {{
+        _mm_madd_epi16(_mm_unpacklo_epi16(y_lo, one), coefs.luma),
+        _mm_madd_epi16(_mm_unpackhi_epi16(y_lo, one), coefs.luma),
+        _mm_madd_epi16(_mm_unpacklo_epi16(y_hi, one), coefs.luma),
+        _mm_madd_epi16(_mm_unpackhi_epi16(y_hi, one), coefs.luma),
+    }};
+}
+
+/// (luma + chroma) >> 8, saturated to [0, 255]
+WCAM_TARGET("sse4.1")
+static inline auto channel(Terms128 const& luma, Terms128 const& chroma) -> __m128i
+{
+    return _mm_packus_epi16(
+        _mm_packs_epi32(_mm_srai_epi32(_mm_add_epi32(luma.values[0], chroma.values[0]), 8), _mm_srai_epi32(_mm_add_epi32(luma.values[1], chroma.values[1]), 8)),
+        _mm_packs_epi32(_mm_srai_epi32(_mm_add_epi32(luma.values[2], chroma.values[2]), 8), _mm_srai_epi32(_mm_add_epi32(luma.values[3], chroma.values[3]), 8))
+    );
+}
+
+/// Chroma terms of 8 pairs, duplicated for the 16 pixels of a row that use them
+struct ChromaTerms128 {
+    Terms128 r;
+    Terms128 g;
+    Terms128 b;
+};
+
+WCAM_TARGET("sse4.1")
+static inline auto duplicated_chroma_term(__m128i uv_lo, __m128i uv_hi, __m128i coefs) -> Terms128
+{
+    __m128i const lo = _mm_madd_epi16(uv_lo, coefs);
+    __m128i const hi = _mm_madd_epi16(uv_hi, coefs);
+    return {{_mm_unpacklo_epi32(lo, lo), _mm_unpackhi_epi32(lo, lo), _mm_unpacklo_epi32(hi, hi), _mm_unpackhi_epi32(hi, hi)}};
+}
+
+/// `uv_lo` and `uv_hi` contain the (u - 128, v - 128) pairs 0 to 3 and 4 to 7, on 16 bits
+WCAM_TARGET("sse4.1")
+static inline auto chroma_terms(__m128i uv_lo, __m128i uv_hi, Coefficients128 const& coefs) -> ChromaTerms128
+{
+    return {
+        .r = duplicated_chroma_term(uv_lo, uv_hi, coefs.r),
+        .g = duplicated_chroma_term(uv_lo, uv_hi, coefs.g),
+        .b = duplicated_chroma_term(uv_lo, uv_hi, coefs.b),
+    };
+}
+
+/// Converts 16 pixels
+template<ChannelOrder order>
+WCAM_TARGET("sse4.1")
+static inline void store_16_pixels(uint8_t* rgb, Terms128 const& luma, ChromaTerms128 const& chroma)
+{
+    store_pixels<order>(rgb, channel(luma, chroma.r), channel(luma, chroma.g), channel(luma, chroma.b));
+}
+
+namespace sse4_1 {
+
+template<ChannelOrder order>
+WCAM_TARGET("sse4.1")
+static void YUYV_to_pixels(uint8_t const* yuyv, uint8_t* rgb, uint32_t width, YUVCoefficients const& coefficients)
+{
+    __m128i const low_bytes = _mm_set1_epi16(0x00FF);
+    __m128i const offset    = _mm_set1_epi16(128);
+    auto const    coefs     = load_coefficients(coefficients);
+
+    uint32_t x = 0;
+    for (; x + 16 <= width; x += 16)
+    {
+        __m128i const in0 = _mm_loadu_si128(reinterpret_cast<__m128i const*>(yuyv + x * 2));      // NOLINT(*reinterpret-cast, *pointer-arithmetic) Pixels 0 to 7
+        __m128i const in1 = _mm_loadu_si128(reinterpret_cast<__m128i const*>(yuyv + x * 2 + 16)); // NOLINT(*reinterpret-cast, *pointer-arithmetic) Pixels 8 to 15
+
+        __m128i const y0  = _mm_and_si128(in0, low_bytes);
+        __m128i const y1  = _mm_and_si128(in1, low_bytes);
+        __m128i const uv0 = _mm_sub_epi16(_mm_srli_epi16(in0, 8), offset); // (u, v) of pairs 0 to 3
+        __m128i const uv1 = _mm_sub_epi16(_mm_srli_epi16(in1, 8), offset); // (u, v) of pairs 4 to 7
+
+        store_16_pixels<order>(rgb + x * pixel_size<order>, luma_terms(y0, y1, coefs), chroma_terms(uv0, uv1, coefs)); // NOLINT(*pointer-arithmetic)
+    }
+    scalar::YUYV_to<order>(yuyv + x * 2, rgb + x * pixel_size<order>, width - x, coefficients); // NOLINT(*pointer-arithmetic)
+}
+
+/// Converts 16 pixels of a row
+template<ChannelOrder order>
+WCAM_TARGET("sse4.1")
+static inline void NV12_16_pixels(uint8_t const* y_row, uint8_t* rgb_row, ChromaTerms128 const& chroma, Coefficients128 const& coefs)
+{
+    __m128i const zero = _mm_setzero_si128();
+    __m128i const y    = _mm_loadu_si128(reinterpret_cast<__m128i const*>(y_row)); // NOLINT(*reinterpret-cast)
+    store_16_pixels<order>(rgb_row, luma_terms(_mm_unpacklo_epi8(y, zero), _mm_unpackhi_epi8(y, zero), coefs), chroma);
+}
+
+template<ChannelOrder order>
+WCAM_TARGET("sse4.1")
+static void NV12_to_pixels(uint8_t const* y_row0, uint8_t const* y_row1, uint8_t const* uv_row, uint8_t* rgb_row0, uint8_t* rgb_row1, uint32_t width, YUVCoefficients const& coefficients)
+{
+    __m128i const zero   = _mm_setzero_si128();
+    __m128i const offset = _mm_set1_epi16(128);
+    auto const    coefs  = load_coefficients(coefficients);
+
+    uint32_t x = 0;
+    for (; x + 16 <= width; x += 16)
+    {
+        __m128i const uv    = _mm_loadu_si128(reinterpret_cast<__m128i const*>(uv_row + x)); // NOLINT(*reinterpret-cast, *pointer-arithmetic) 8 (u, v) pairs
+        __m128i const uv_lo = _mm_sub_epi16(_mm_unpacklo_epi8(uv, zero), offset);
+        __m128i const uv_hi = _mm_sub_epi16(_mm_unpackhi_epi8(uv, zero), offset);
+
+        auto const chroma = chroma_terms(uv_lo, uv_hi, coefs);
+        NV12_16_pixels<order>(y_row0 + x, rgb_row0 + x * pixel_size<order>, chroma, coefs); // NOLINT(*pointer-arithmetic)
+        NV12_16_pixels<order>(y_row1 + x, rgb_row1 + x * pixel_size<order>, chroma, coefs); // NOLINT(*pointer-arithmetic)
+    }
+    scalar::NV12_to<order>(y_row0 + x, y_row1 + x, uv_row + x, rgb_row0 + x * pixel_size<order>, rgb_row1 + x * pixel_size<order>, width - x, coefficients); // NOLINT(*pointer-arithmetic)
+}
+
+WCAM_TARGET("sse4.1")
+void swap_red_and_blue(uint8_t const* bgr, uint8_t* rgb, uint32_t width)
+{
+    uint32_t x = 0;
+    for (; x + 16 <= width; x += 16)
+    {
+        // Load all the pixels before storing any of them, so that this works in place
+        __m128i const in0 = _mm_loadu_si128(reinterpret_cast<__m128i const*>(bgr + x * 3));      // NOLINT(*reinterpret-cast, *pointer-arithmetic)
+        __m128i const in1 = _mm_loadu_si128(reinterpret_cast<__m128i const*>(bgr + x * 3 + 16)); // NOLINT(*reinterpret-cast, *pointer-arithmetic)
+        __m128i const in2 = _mm_loadu_si128(reinterpret_cast<__m128i const*>(bgr + x * 3 + 32)); // NOLINT(*reinterpret-cast, *pointer-arithmetic)
+
+        __m128i const out0 = _mm_or_si128(swapped(in0, 0, 0), swapped(in1, 0, 1));
+        __m128i const out1 = _mm_or_si128(_mm_or_si128(swapped(in0, 1, 0), swapped(in1, 1, 1)), swapped(in2, 1, 2));
+        __m128i const out2 = _mm_or_si128(swapped(in1, 2, 1), swapped(in2, 2, 2));
+
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(rgb + x * 3), out0);      // NOLINT(*reinterpret-cast, *pointer-arithmetic)
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(rgb + x * 3 + 16), out1); // NOLINT(*reinterpret-cast, *pointer-arithmetic)
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(rgb + x * 3 + 32), out2); // NOLINT(*reinterpret-cast, *pointer-arithmetic)
+    }
+    scalar::swap_red_and_blue(bgr + x * 3, rgb + x * 3, width - x); // NOLINT(*pointer-arithmetic)
+}
+
+template<bool swap_red_and_blue>
+WCAM_TARGET("sse4.1")
+static void add_alpha_impl(uint8_t const* rgb, uint8_t* rgba, uint32_t width)
+{
+    __m128i const alpha = _mm_set1_epi32(static_cast<int>(0xFF000000));
+    __m128i const mask0 = add_alpha_mask(swap_red_and_blue, 0);
+    __m128i const mask4 = add_alpha_mask(swap_red_and_blue, 4);
+
+    uint32_t x = 0;
+    for (; x + 16 <= width; x += 16)
+    {
+        // Each group of 4 pixels uses 12 of the 16 bytes we load. The last one is loaded 4 bytes earlier, so that we don't read past the 48 bytes of the 16 pixels.
+        for (uint32_t group = 0; group < 3; ++group)
+        {
+            __m128i const in = _mm_loadu_si128(reinterpret_cast<__m128i const*>(rgb + (x + group * 4) * 3));                        // NOLINT(*reinterpret-cast, *pointer-arithmetic)
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(rgba + (x + group * 4) * 4), _mm_or_si128(_mm_shuffle_epi8(in, mask0), alpha)); // NOLINT(*reinterpret-cast, *pointer-arithmetic)
+        }
+        __m128i const in = _mm_loadu_si128(reinterpret_cast<__m128i const*>(rgb + x * 3 + 32));                     // NOLINT(*reinterpret-cast, *pointer-arithmetic)
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(rgba + (x + 12) * 4), _mm_or_si128(_mm_shuffle_epi8(in, mask4), alpha)); // NOLINT(*reinterpret-cast, *pointer-arithmetic)
+    }
+    if constexpr (swap_red_and_blue)
+        scalar::add_alpha_and_swap_red_and_blue(rgb + x * 3, rgba + x * 4, width - x); // NOLINT(*pointer-arithmetic)
+    else
+        scalar::add_alpha(rgb + x * 3, rgba + x * 4, width - x); // NOLINT(*pointer-arithmetic)
+}
+
+WCAM_TARGET("sse4.1")
+void add_alpha(uint8_t const* rgb, uint8_t* rgba, uint32_t width)
+{
+    add_alpha_impl<false>(rgb, rgba, width);
+}
+
+WCAM_TARGET("sse4.1")
+void add_alpha_and_swap_red_and_blue(uint8_t const* bgr, uint8_t* rgba, uint32_t width)
+{
+    add_alpha_impl<true>(bgr, rgba, width);
+}
+
+WCAM_TARGET("sse4.1")
+void YUYV_to_GREY8(uint8_t const* yuyv, uint8_t* grey, uint32_t width)
+{
+    __m128i const low_bytes = _mm_set1_epi16(0x00FF);
+
+    uint32_t x = 0;
+    for (; x + 16 <= width; x += 16)
+    {
+        __m128i const in0 = _mm_loadu_si128(reinterpret_cast<__m128i const*>(yuyv + x * 2));      // NOLINT(*reinterpret-cast, *pointer-arithmetic)
+        __m128i const in1 = _mm_loadu_si128(reinterpret_cast<__m128i const*>(yuyv + x * 2 + 16)); // NOLINT(*reinterpret-cast, *pointer-arithmetic)
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(grey + x), _mm_packus_epi16(_mm_and_si128(in0, low_bytes), _mm_and_si128(in1, low_bytes))); // NOLINT(*reinterpret-cast, *pointer-arithmetic)
+    }
+    scalar::YUYV_to_GREY8(yuyv + x * 2, grey + x, width - x); // NOLINT(*pointer-arithmetic)
+}
+
+/// The 16 Y samples, and the 8 (u, v) pairs, of 16 pixels of YUYV
+struct YUYV16 {
+    __m128i y;
+    __m128i uv;
+};
+
+WCAM_TARGET("sse4.1")
+static inline auto load_YUYV16(uint8_t const* yuyv) -> YUYV16
+{
+    __m128i const low_bytes = _mm_set1_epi16(0x00FF);
+    __m128i const in0       = _mm_loadu_si128(reinterpret_cast<__m128i const*>(yuyv));      // NOLINT(*reinterpret-cast)
+    __m128i const in1       = _mm_loadu_si128(reinterpret_cast<__m128i const*>(yuyv + 16)); // NOLINT(*reinterpret-cast, *pointer-arithmetic)
+    return {
+        _mm_packus_epi16(_mm_and_si128(in0, low_bytes), _mm_and_si128(in1, low_bytes)),
+        _mm_packus_epi16(_mm_srli_epi16(in0, 8), _mm_srli_epi16(in1, 8)),
+    };
+}
+
+WCAM_TARGET("sse4.1")
+void YUYV_to_NV12(uint8_t const* yuyv_row0, uint8_t const* yuyv_row1, uint8_t* y_row0, uint8_t* y_row1, uint8_t* uv_row, uint32_t width)
+{
+    uint32_t x = 0;
+    for (; x + 16 <= width; x += 16)
+    {
+        auto const row0 = load_YUYV16(yuyv_row0 + x * 2);                                         // NOLINT(*pointer-arithmetic)
+        auto const row1 = load_YUYV16(yuyv_row1 + x * 2);                                         // NOLINT(*pointer-arithmetic)
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(y_row0 + x), row0.y);                         // NOLINT(*reinterpret-cast, *pointer-arithmetic)
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(y_row1 + x), row1.y);                         // NOLINT(*reinterpret-cast, *pointer-arithmetic)
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(uv_row + x), _mm_avg_epu8(row0.uv, row1.uv)); // NOLINT(*reinterpret-cast, *pointer-arithmetic)
+    }
+    scalar::YUYV_to_NV12(yuyv_row0 + x * 2, yuyv_row1 + x * 2, y_row0 + x, y_row1 + x, uv_row + x, width - x); // NOLINT(*pointer-arithmetic)
+}
+
+WCAM_TARGET("sse4.1")
+void YUYV_to_I420(uint8_t const* yuyv_row0, uint8_t const* yuyv_row1, uint8_t* y_row0, uint8_t* y_row1, uint8_t* u_row, uint8_t* v_row, uint32_t width)
+{
+    __m128i const low_bytes = _mm_set1_epi16(0x00FF);
+
+    uint32_t x = 0;
+    for (; x + 16 <= width; x += 16)
+    {
+        auto const    row0 = load_YUYV16(yuyv_row0 + x * 2); // NOLINT(*pointer-arithmetic)
+        auto const    row1 = load_YUYV16(yuyv_row1 + x * 2); // NOLINT(*pointer-arithmetic)
+        __m128i const uv   = _mm_avg_epu8(row0.uv, row1.uv);
+        __m128i const u_v  = _mm_packus_epi16(_mm_and_si128(uv, low_bytes), _mm_srli_epi16(uv, 8)); // 8 u, then 8 v
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(y_row0 + x), row0.y);                           // NOLINT(*reinterpret-cast, *pointer-arithmetic)
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(y_row1 + x), row1.y);                           // NOLINT(*reinterpret-cast, *pointer-arithmetic)
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(u_row + x / 2), u_v);                           // NOLINT(*reinterpret-cast, *pointer-arithmetic)
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(v_row + x / 2), _mm_srli_si128(u_v, 8));        // NOLINT(*reinterpret-cast, *pointer-arithmetic)
+    }
+    scalar::YUYV_to_I420(yuyv_row0 + x * 2, yuyv_row1 + x * 2, y_row0 + x, y_row1 + x, u_row + x / 2, v_row + x / 2, width - x); // NOLINT(*pointer-arithmetic)
+}
+
+WCAM_TARGET("sse4.1")
+void split_chroma(uint8_t const* uv, uint8_t* u, uint8_t* v, uint32_t count)
+{
+    __m128i const low_bytes = _mm_set1_epi16(0x00FF);
+
+    uint32_t i = 0;
+    for (; i + 16 <= count; i += 16)
+    {
+        __m128i const in0 = _mm_loadu_si128(reinterpret_cast<__m128i const*>(uv + i * 2));                                                   // NOLINT(*reinterpret-cast, *pointer-arithmetic)
+        __m128i const in1 = _mm_loadu_si128(reinterpret_cast<__m128i const*>(uv + i * 2 + 16));                                              // NOLINT(*reinterpret-cast, *pointer-arithmetic)
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(u + i), _mm_packus_epi16(_mm_and_si128(in0, low_bytes), _mm_and_si128(in1, low_bytes))); // NOLINT(*reinterpret-cast, *pointer-arithmetic)
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(v + i), _mm_packus_epi16(_mm_srli_epi16(in0, 8), _mm_srli_epi16(in1, 8)));               // NOLINT(*reinterpret-cast, *pointer-arithmetic)
+    }
+    scalar::split_chroma(uv + i * 2, u + i, v + i, count - i); // NOLINT(*pointer-arithmetic)
+}
+
+WCAM_TARGET("sse4.1")
+void merge_chroma(uint8_t const* u, uint8_t const* v, uint8_t* uv, uint32_t count)
+{
+    uint32_t i = 0;
+    for (; i + 16 <= count; i += 16)
+    {
+        __m128i const u16 = _mm_loadu_si128(reinterpret_cast<__m128i const*>(u + i));               // NOLINT(*reinterpret-cast, *pointer-arithmetic)
+        __m128i const v16 = _mm_loadu_si128(reinterpret_cast<__m128i const*>(v + i));               // NOLINT(*reinterpret-cast, *pointer-arithmetic)
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(uv + i * 2), _mm_unpacklo_epi8(u16, v16));      // NOLINT(*reinterpret-cast, *pointer-arithmetic)
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(uv + i * 2 + 16), _mm_unpackhi_epi8(u16, v16)); // NOLINT(*reinterpret-cast, *pointer-arithmetic)
+    }
+    scalar::merge_chroma(u + i, v + i, uv + i * 2, count - i); // NOLINT(*pointer-arithmetic)
+}
+
+WCAM_TARGET("sse4.1")
+void merge_to_YUYV(uint8_t const* y, uint8_t const* u, uint8_t const* v, uint8_t* yuyv, uint32_t width)
+{
+    uint32_t x = 0;
+    for (; x + 32 <= width; x += 32)
+    {
+        __m128i const y0  = _mm_loadu_si128(reinterpret_cast<__m128i const*>(y + x));                // NOLINT(*reinterpret-cast, *pointer-arithmetic)
+        __m128i const y1  = _mm_loadu_si128(reinterpret_cast<__m128i const*>(y + x + 16));           // NOLINT(*reinterpret-cast, *pointer-arithmetic)
+        __m128i const u16 = _mm_loadu_si128(reinterpret_cast<__m128i const*>(u + x / 2));            // NOLINT(*reinterpret-cast, *pointer-arithmetic)
+        __m128i const v16 = _mm_loadu_si128(reinterpret_cast<__m128i const*>(v + x / 2));            // NOLINT(*reinterpret-cast, *pointer-arithmetic)
+        __m128i const uv0 = _mm_unpacklo_epi8(u16, v16);                                             // The (u, v) pairs of the first 16 pixels
+        __m128i const uv1 = _mm_unpackhi_epi8(u16, v16);                                             // The (u, v) pairs of the last 16 pixels
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(yuyv + x * 2), _mm_unpacklo_epi8(y0, uv0));      // NOLINT(*reinterpret-cast, *pointer-arithmetic)
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(yuyv + x * 2 + 16), _mm_unpackhi_epi8(y0, uv0)); // NOLINT(*reinterpret-cast, *pointer-arithmetic)
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(yuyv + x * 2 + 32), _mm_unpacklo_epi8(y1, uv1)); // NOLINT(*reinterpret-cast, *pointer-arithmetic)
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(yuyv + x * 2 + 48), _mm_unpackhi_epi8(y1, uv1)); // NOLINT(*reinterpret-cast, *pointer-arithmetic)
+    }
+    scalar::merge_to_YUYV(y + x, u + x / 2, v + x / 2, yuyv + x * 2, width - x); // NOLINT(*pointer-arithmetic)
+}
+
+WCAM_TARGET("sse4.1")
+void GREY8_to_RGB24(uint8_t const* grey, uint8_t* rgb, uint32_t width)
+{
+    uint32_t x = 0;
+    for (; x + 16 <= width; x += 16)
+    {
+        __m128i const g = _mm_loadu_si128(reinterpret_cast<__m128i const*>(grey + x)); // NOLINT(*reinterpret-cast, *pointer-arithmetic)
+        store_RGB24(rgb + x * 3, g, g, g);                                             // NOLINT(*pointer-arithmetic)
+    }
+    scalar::GREY8_to_RGB24(grey + x, rgb + x * 3, width - x); // NOLINT(*pointer-arithmetic)
+}
+
+WCAM_TARGET("sse4.1")
+void GREY8_to_RGBA32(uint8_t const* grey, uint8_t* rgba, uint32_t width)
+{
+    uint32_t x = 0;
+    for (; x + 16 <= width; x += 16)
+    {
+        __m128i const g = _mm_loadu_si128(reinterpret_cast<__m128i const*>(grey + x)); // NOLINT(*reinterpret-cast, *pointer-arithmetic)
+        store_RGBA32(rgba + x * 4, g, g, g);                                            // NOLINT(*pointer-arithmetic)
+    }
+    scalar::GREY8_to_RGBA32(grey + x, rgba + x * 4, width - x); // NOLINT(*pointer-arithmetic)
+}
+
+/// (a * weight0 + b * weight1 + 128) / 256, on 16-bits values. The products wrap around, but their sum is always smaller than 65536.
+WCAM_TARGET("sse4.1")
+static inline auto blend(__m128i a, __m128i b, __m128i weight0, __m128i weight1) -> __m128i
+{
+    return _mm_srli_epi16(_mm_add_epi16(_mm_add_epi16(_mm_mullo_epi16(a, weight0), _mm_mullo_epi16(b, weight1)), _mm_set1_epi16(128)), 8);
+}
+
+WCAM_TARGET("sse4.1")
+void blend_rows(uint8_t const* row0, uint8_t const* row1, uint8_t* out, size_t length, uint32_t weight)
+{
+    __m128i const zero    = _mm_setzero_si128();
+    __m128i const weight0 = _mm_set1_epi16(static_cast<int16_t>(256 - weight));
+    __m128i const weight1 = _mm_set1_epi16(static_cast<int16_t>(weight));
+
+    size_t i = 0;
+    for (; i + 16 <= length; i += 16)
+    {
+        __m128i const a = _mm_loadu_si128(reinterpret_cast<__m128i const*>(row0 + i)); // NOLINT(*reinterpret-cast, *pointer-arithmetic)
+        __m128i const b = _mm_loadu_si128(reinterpret_cast<__m128i const*>(row1 + i)); // NOLINT(*reinterpret-cast, *pointer-arithmetic)
+        __m128i const lo = blend(_mm_unpacklo_epi8(a, zero), _mm_unpacklo_epi8(b, zero), weight0, weight1);
+        __m128i const hi = blend(_mm_unpackhi_epi8(a, zero), _mm_unpackhi_epi8(b, zero), weight0, weight1);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), _mm_packus_epi16(lo, hi)); // NOLINT(*reinterpret-cast, *pointer-arithmetic)
+    }
+    scalar::blend_rows(row0 + i, row1 + i, out + i, length - i, weight); // NOLINT(*pointer-arithmetic)
+}
+
+WCAM_TARGET("sse4.1")
+void add_row(uint8_t const* row, uint16_t* sums, size_t length)
+{
+    __m128i const zero = _mm_setzero_si128();
+
+    size_t i = 0;
+    for (; i + 16 <= length; i += 16)
+    {
+        __m128i const in   = _mm_loadu_si128(reinterpret_cast<__m128i const*>(row + i));   // NOLINT(*reinterpret-cast, *pointer-arithmetic)
+        auto* const   lo   = reinterpret_cast<__m128i*>(sums + i);                          // NOLINT(*reinterpret-cast, *pointer-arithmetic)
+        auto* const   hi   = reinterpret_cast<__m128i*>(sums + i + 8);                      // NOLINT(*reinterpret-cast, *pointer-arithmetic)
+        _mm_storeu_si128(lo, _mm_add_epi16(_mm_loadu_si128(lo), _mm_unpacklo_epi8(in, zero)));
+        _mm_storeu_si128(hi, _mm_add_epi16(_mm_loadu_si128(hi), _mm_unpackhi_epi8(in, zero)));
+    }
+    scalar::add_row(row + i, sums + i, length - i); // NOLINT(*pointer-arithmetic)
+}
+
+/// (sums * multiplier + 32768) / 65536, for 8 sums
+WCAM_TARGET("sse4.1")
+static inline auto average(__m128i sums, __m128i multiplier) -> __m128i
+{
+    __m128i const zero = _mm_setzero_si128();
+    __m128i const half = _mm_set1_epi32(32768);
+    __m128i const lo   = _mm_srli_epi32(_mm_add_epi32(_mm_mullo_epi32(_mm_unpacklo_epi16(sums, zero), multiplier), half), 16);
+    __m128i const hi   = _mm_srli_epi32(_mm_add_epi32(_mm_mullo_epi32(_mm_unpackhi_epi16(sums, zero), multiplier), half), 16);
+    return _mm_packus_epi32(lo, hi);
+}
+
+WCAM_TARGET("sse4.1")
+void average_row(uint16_t const* sums, uint8_t* out, size_t length, uint32_t reciprocal)
+{
+    __m128i const multiplier = _mm_set1_epi32(static_cast<int32_t>(reciprocal));
+
+    size_t i = 0;
+    for (; i + 16 <= length; i += 16)
+    {
+        __m128i const lo = average(_mm_loadu_si128(reinterpret_cast<__m128i const*>(sums + i)), multiplier);     // NOLINT(*reinterpret-cast, *pointer-arithmetic)
+        __m128i const hi = average(_mm_loadu_si128(reinterpret_cast<__m128i const*>(sums + i + 8)), multiplier); // NOLINT(*reinterpret-cast, *pointer-arithmetic)
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), _mm_packus_epi16(lo, hi));             // NOLINT(*reinterpret-cast, *pointer-arithmetic)
+    }
+    scalar::average_row(sums + i, out + i, length - i, reciprocal); // NOLINT(*pointer-arithmetic)
+}
+
+WCAM_TARGET("sse4.1")
+void YUYV_to_RGB24(uint8_t const* yuyv, uint8_t* rgb, uint32_t width, YUVCoefficients const& coefs)
+{
+    YUYV_to_pixels<ChannelOrder::RGB>(yuyv, rgb, width, coefs);
+}
+
+WCAM_TARGET("sse4.1")
+void YUYV_to_BGR24(uint8_t const* yuyv, uint8_t* bgr, uint32_t width, YUVCoefficients const& coefs)
+{
+    YUYV_to_pixels<ChannelOrder::BGR>(yuyv, bgr, width, coefs);
+}
+
+WCAM_TARGET("sse4.1")
+void YUYV_to_RGBA32(uint8_t const* yuyv, uint8_t* rgba, uint32_t width, YUVCoefficients const& coefs)
+{
+    YUYV_to_pixels<ChannelOrder::RGBA>(yuyv, rgba, width, coefs);
+}
+
+WCAM_TARGET("sse4.1")
+void YUYV_to_BGRA32(uint8_t const* yuyv, uint8_t* bgra, uint32_t width, YUVCoefficients const& coefs)
+{
+    YUYV_to_pixels<ChannelOrder::BGRA>(yuyv, bgra, width, coefs);
+}
+
+WCAM_TARGET("sse4.1")
+void NV12_to_RGB24(uint8_t const* y_row0, uint8_t const* y_row1, uint8_t const* uv_row, uint8_t* rgb_row0, uint8_t* rgb_row1, uint32_t width, YUVCoefficients const& coefs)
+{
+    NV12_to_pixels<ChannelOrder::RGB>(y_row0, y_row1, uv_row, rgb_row0, rgb_row1, width, coefs);
+}
+
+WCAM_TARGET("sse4.1")
+void NV12_to_BGR24(uint8_t const* y_row0, uint8_t const* y_row1, uint8_t const* uv_row, uint8_t* bgr_row0, uint8_t* bgr_row1, uint32_t width, YUVCoefficients const& coefs)
+{
+    NV12_to_pixels<ChannelOrder::BGR>(y_row0, y_row1, uv_row, bgr_row0, bgr_row1, width, coefs);
+}
+
+WCAM_TARGET("sse4.1")
+void NV12_to_RGBA32(uint8_t const* y_row0, uint8_t const* y_row1, uint8_t const* uv_row, uint8_t* rgba_row0, uint8_t* rgba_row1, uint32_t width, YUVCoefficients const& coefs)
+{
+    NV12_to_pixels<ChannelOrder::RGBA>(y_row0, y_row1, uv_row, rgba_row0, rgba_row1, width, coefs);
+}
+
+WCAM_TARGET("sse4.1")
+void NV12_to_BGRA32(uint8_t const* y_row0, uint8_t const* y_row1, uint8_t const* uv_row, uint8_t* bgra_row0, uint8_t* bgra_row1, uint32_t width, YUVCoefficients const& coefs)
+{
+    NV12_to_pixels<ChannelOrder::BGRA>(y_row0, y_row1, uv_row, bgra_row0, bgra_row1, width, coefs);
+}
+
+} // namespace sse4_1
+
+/// 32 values on 32 bits. AVX2's two independent 128-bit lanes give us the pixels in the order [0-3 | 16-19], [4-7 | 20-23], [8-11 | 24-27], [12-15 | 28-31], for both the luma and the chroma terms.
+struct Terms256 {
+    __m256i values[4]; // NOLINT(*c-arrays)
+};
+
+struct Coefficients256 {
+    __m256i y_offset;
+    __m256i luma;
+    __m256i r;
+    __m256i g;
+    __m256i b;
+};
+
+WCAM_TARGET("avx2")
+static inline auto load_coefficients_256(YUVCoefficients const& coefs) -> Coefficients256
+{
+    return {
+        .y_offset = _mm256_set1_epi16(coefs.y_offset),
+        .luma     = uv_coefficients_256(coefs.y, 128),
+        .r        = uv_coefficients_256(0, coefs.r_v),
+        .g        = uv_coefficients_256(coefs.g_u, coefs.g_v),
+        .b        = uv_coefficients_256(coefs.b_u, 0),
+    };
+}
+
+/// `y_lo` and `y_hi` contain the Y of pixels [0-7 | 16-23] and [8-15 | 24-31], on 16 bits
+WCAM_TARGET("avx2")
+static inline auto luma_terms(__m256i y_lo, __m256i y_hi, Coefficients256 const& coefs) -> Terms256
+{
+    __m256i const one = _mm256_set1_epi16(1);
+    y_lo              = _mm256_sub_epi16(y_lo, coefs.y_offset);
+    y_hi              = _mm256_sub_epi16(y_hi, coefs.y_offset);
+    return {{
+        _mm256_madd_epi16(_mm256_unpacklo_epi16(y_lo, one), coefs.luma),
+        _mm256_madd_epi16(_mm256_unpackhi_epi16(y_lo, one), coefs.luma),
+        _mm256_madd_epi16(_mm256_unpacklo_epi16(y_hi, one), coefs.luma),
+        _mm256_madd_epi16(_mm256_unpackhi_epi16(y_hi, one), coefs.luma),
+    }};
+}
+
+/// (luma + chroma) >> 8, saturated to [0, 255], and with the pixels back in order
+WCAM_TARGET("avx2")
+static inline auto channel(Terms256 const& luma, Terms256 const& chroma) -> __m256i
+{
+    return _mm256_packus_epi16(
+        _mm256_packs_epi32(_mm256_srai_epi32(_mm256_add_epi32(luma.values[0], chroma.values[0]), 8), _mm256_srai_epi32(_mm256_add_epi32(luma.values[1], chroma.values[1]), 8)),
+        _mm256_packs_epi32(_mm256_srai_epi32(_mm256_add_epi32(luma.values[2], chroma.values[2]), 8), _mm256_srai_epi32(_mm256_add_epi32(luma.values[3], chroma.values[3]), 8))
+    );
+}
+
+struct ChromaTerms256 {
+    Terms256 r;
+    Terms256 g;
+    Terms256 b;
+};
+
+WCAM_TARGET("avx2")
+static inline auto duplicated_chroma_term(__m256i uv_lo, __m256i uv_hi, __m256i coefs) -> Terms256
+{
+    __m256i const lo = _mm256_madd_epi16(uv_lo, coefs);
+    __m256i const hi = _mm256_madd_epi16(uv_hi, coefs);
+    return {{_mm256_unpacklo_epi32(lo, lo), _mm256_unpackhi_epi32(lo, lo), _mm256_unpacklo_epi32(hi, hi), _mm256_unpackhi_epi32(hi, hi)}};
+}
+
+/// `uv_lo` and `uv_hi` contain the (u - 128, v - 128) pairs [0-3 | 8-11] and [4-7 | 12-15], on 16 bits
+WCAM_TARGET("avx2")
+static inline auto chroma_terms(__m256i uv_lo, __m256i uv_hi, Coefficients256 const& coefs) -> ChromaTerms256
+{
+    return {
+        .r = duplicated_chroma_term(uv_lo, uv_hi, coefs.r),
+        .g = duplicated_chroma_term(uv_lo, uv_hi, coefs.g),
+        .b = duplicated_chroma_term(uv_lo, uv_hi, coefs.b),
+    };
+}
+
+/// Converts 32 pixels
+template<ChannelOrder order>
+WCAM_TARGET("avx2")
+static inline void store_32_pixels(uint8_t* rgb, Terms256 const& luma, ChromaTerms256 const& chroma)
+{
+    __m256i const r = channel(luma, chroma.r);
+    __m256i const g = channel(luma, chroma.g);
+    __m256i const b = channel(luma, chroma.b);
+    store_pixels<order>(rgb, _mm256_castsi256_si128(r), _mm256_castsi256_si128(g), _mm256_castsi256_si128(b));
+    store_pixels<order>(rgb + 16 * pixel_size<order>, _mm256_extracti128_si256(r, 1), _mm256_extracti128_si256(g, 1), _mm256_extracti128_si256(b, 1)); // NOLINT(*pointer-arithmetic)
+}
+
+namespace avx2 {
+
+template<ChannelOrder order>
+WCAM_TARGET("avx2")
+static void YUYV_to_pixels(uint8_t const* yuyv, uint8_t* rgb, uint32_t width, YUVCoefficients const& coefficients)
+{
+    __m256i const low_bytes = _mm256_set1_epi16(0x00FF);
+    __m256i const offset    = _mm256_set1_epi16(128);
+    auto const    coefs     = load_coefficients_256(coefficients);
+
+    uint32_t x = 0;
+    for (; x + 32 <= width; x += 32)
+    {
+        __m256i const pixels_0_15  = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(yuyv + x * 2));      // NOLINT(*reinterpret-cast, *pointer-arithmetic)
+        __m256i const pixels_16_31 = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(yuyv + x * 2 + 32)); // NOLINT(*reinterpret-cast, *pointer-arithmetic)
+        // Reorder the lanes so that the pixels end up in the same order as the ones of NV12
+        __m256i const in0 = _mm256_permute2x128_si256(pixels_0_15, pixels_16_31, 0x20); // Pixels [0-7 | 16-23]
+        __m256i const in1 = _mm256_permute2x128_si256(pixels_0_15, pixels_16_31, 0x31); // Pixels [8-15 | 24-31]
+
+        __m256i const y0  = _mm256_and_si256(in0, low_bytes);
+        __m256i const y1  = _mm256_and_si256(in1, low_bytes);
+        __m256i const uv0 = _mm256_sub_epi16(_mm256_srli_epi16(in0, 8), offset); // Pairs [0-3 | 8-11]
+        __m256i const uv1 = _mm256_sub_epi16(_mm256_srli_epi16(in1, 8), offset); // Pairs [4-7 | 12-15]
+
+        store_32_pixels<order>(rgb + x * pixel_size<order>, luma_terms(y0, y1, coefs), chroma_terms(uv0, uv1, coefs)); // NOLINT(*pointer-arithmetic)
+    }
+    sse4_1::YUYV_to<order>(yuyv + x * 2, rgb + x * pixel_size<order>, width - x, coefficients); // NOLINT(*pointer-arithmetic)
+}
+
+/// Converts 32 pixels of a row
+template<ChannelOrder order>
+WCAM_TARGET("avx2")
+static inline void NV12_32_pixels(uint8_t const* y_row, uint8_t* rgb_row, ChromaTerms256 const& chroma, Coefficients256 const& coefs)
+{
+    __m256i const zero = _mm256_setzero_si256();
+    __m256i const y    = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(y_row)); // NOLINT(*reinterpret-cast)
+    store_32_pixels<order>(rgb_row, luma_terms(_mm256_unpacklo_epi8(y, zero), _mm256_unpackhi_epi8(y, zero), coefs), chroma);
+}
+
+template<ChannelOrder order>
+WCAM_TARGET("avx2")
+static void NV12_to_pixels(uint8_t const* y_row0, uint8_t const* y_row1, uint8_t const* uv_row, uint8_t* rgb_row0, uint8_t* rgb_row1, uint32_t width, YUVCoefficients const& coefficients)
+{
+    __m256i const zero   = _mm256_setzero_si256();
+    __m256i const offset = _mm256_set1_epi16(128);
+    auto const    coefs  = load_coefficients_256(coefficients);
+
+    uint32_t x = 0;
+    for (; x + 32 <= width; x += 32)
+    {
+        __m256i const uv    = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(uv_row + x)); // NOLINT(*reinterpret-cast, *pointer-arithmetic) 16 (u, v) pairs
+        __m256i const uv_lo = _mm256_sub_epi16(_mm256_unpacklo_epi8(uv, zero), offset);          // Pairs [0-3 | 8-11]
+        __m256i const uv_hi = _mm256_sub_epi16(_mm256_unpackhi_epi8(uv, zero), offset);          // Pairs [4-7 | 12-15]
+
+        auto const chroma = chroma_terms(uv_lo, uv_hi, coefs);
+        NV12_32_pixels<order>(y_row0 + x, rgb_row0 + x * pixel_size<order>, chroma, coefs); // NOLINT(*pointer-arithmetic)
+        NV12_32_pixels<order>(y_row1 + x, rgb_row1 + x * pixel_size<order>, chroma, coefs); // NOLINT(*pointer-arithmetic)
+    }
+    sse4_1::NV12_to<order>(y_row0 + x, y_row1 + x, uv_row + x, rgb_row0 + x * pixel_size<order>, rgb_row1 + x * pixel_size<order>, width - x, coefficients); // NOLINT(*pointer-arithmetic)
+}
+
+WCAM_TARGET("avx2")
+void YUYV_to_GREY8(uint8_t const* yuyv, uint8_t* grey, uint32_t width)
+{
+    __m256i const low_bytes = _mm256_set1_epi16(0x00FF);
+
+    uint32_t x = 0;
+    for (; x + 32 <= width; x += 32)
+    {
+        __m256i const in0    = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(yuyv + x * 2));      // NOLINT(*reinterpret-cast, *pointer-arithmetic)
+        __m256i const in1    = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(yuyv + x * 2 + 32)); // NOLINT(*reinterpret-cast, *pointer-arithmetic)
+        __m256i const packed = _mm256_packus_epi16(_mm256_and_si256(in0, low_bytes), _mm256_and_si256(in1, low_bytes)); // Pixels [0-7, 16-23 | 8-15, 24-31]
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(grey + x), _mm256_permute4x64_epi64(packed, 0xD8));             // NOLINT(*reinterpret-cast, *pointer-arithmetic)
+    }
+    sse4_1::YUYV_to_GREY8(yuyv + x * 2, grey + x, width - x); // NOLINT(*pointer-arithmetic)
+}
+
+/// The 32 Y samples, and the 16 (u, v) pairs, of 32 pixels of YUYV
+struct YUYV32 {
+    __m256i y;
+    __m256i uv;
+};
+
+WCAM_TARGET("avx2")
+static inline auto load_YUYV32(uint8_t const* yuyv) -> YUYV32
+{
+    __m256i const low_bytes = _mm256_set1_epi16(0x00FF);
+    __m256i const in0       = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(yuyv));      // NOLINT(*reinterpret-cast)
+    __m256i const in1       = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(yuyv + 32)); // NOLINT(*reinterpret-cast, *pointer-arithmetic)
+    // The packs work within each 128-bits lane, so they give pixels [0-7, 16-23 | 8-15, 24-31], that we put back in order
+    return {
+        _mm256_permute4x64_epi64(_mm256_packus_epi16(_mm256_and_si256(in0, low_bytes), _mm256_and_si256(in1, low_bytes)), 0xD8),
+        _mm256_permute4x64_epi64(_mm256_packus_epi16(_mm256_srli_epi16(in0, 8), _mm256_srli_epi16(in1, 8)), 0xD8),
+    };
+}
+
+WCAM_TARGET("avx2")
+void YUYV_to_NV12(uint8_t const* yuyv_row0, uint8_t const* yuyv_row1, uint8_t* y_row0, uint8_t* y_row1, uint8_t* uv_row, uint32_t width)
+{
+    uint32_t x = 0;
+    for (; x + 32 <= width; x += 32)
+    {
+        auto const row0 = load_YUYV32(yuyv_row0 + x * 2);                                               // NOLINT(*pointer-arithmetic)
+        auto const row1 = load_YUYV32(yuyv_row1 + x * 2);                                               // NOLINT(*pointer-arithmetic)
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(y_row0 + x), row0.y);                            // NOLINT(*reinterpret-cast, *pointer-arithmetic)
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(y_row1 + x), row1.y);                            // NOLINT(*reinterpret-cast, *pointer-arithmetic)
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(uv_row + x), _mm256_avg_epu8(row0.uv, row1.uv)); // NOLINT(*reinterpret-cast, *pointer-arithmetic)
+    }
+    sse4_1::YUYV_to_NV12(yuyv_row0 + x * 2, yuyv_row1 + x * 2, y_row0 + x, y_row1 + x, uv_row + x, width - x); // NOLINT(*pointer-arithmetic)
+}
+
+WCAM_TARGET("avx2")
+void YUYV_to_I420(uint8_t const* yuyv_row0, uint8_t const* yuyv_row1, uint8_t* y_row0, uint8_t* y_row1, uint8_t* u_row, uint8_t* v_row, uint32_t width)
+{
+    __m256i const low_bytes = _mm256_set1_epi16(0x00FF);
+
+    uint32_t x = 0;
+    for (; x + 32 <= width; x += 32)
+    {
+        auto const    row0 = load_YUYV32(yuyv_row0 + x * 2); // NOLINT(*pointer-arithmetic)
+        auto const    row1 = load_YUYV32(yuyv_row1 + x * 2); // NOLINT(*pointer-arithmetic)
+        __m256i const uv   = _mm256_avg_epu8(row0.uv, row1.uv);
+        __m256i const u_v  = _mm256_permute4x64_epi64(_mm256_packus_epi16(_mm256_and_si256(uv, low_bytes), _mm256_srli_epi16(uv, 8)), 0xD8); // 16 u, then 16 v
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(y_row0 + x), row0.y);                                                                 // NOLINT(*reinterpret-cast, *pointer-arithmetic)
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(y_row1 + x), row1.y);                                                                 // NOLINT(*reinterpret-cast, *pointer-arithmetic)
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(u_row + x / 2), _mm256_castsi256_si128(u_v));                                            // NOLINT(*reinterpret-cast, *pointer-arithmetic)
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(v_row + x / 2), _mm256_extracti128_si256(u_v, 1));                                       // NOLINT(*reinterpret-cast, *pointer-arithmetic)
+    }
+    sse4_1::YUYV_to_I420(yuyv_row0 + x * 2, yuyv_row1 + x * 2, y_row0 + x, y_row1 + x, u_row + x / 2, v_row + x / 2, width - x); // NOLINT(*pointer-arithmetic)
+}
+
+WCAM_TARGET("avx2")
+static inline auto blend(__m256i a, __m256i b, __m256i weight0, __m256i weight1) -> __m256i
+{
+    return _mm256_srli_epi16(_mm256_add_epi16(_mm256_add_epi16(_mm256_mullo_epi16(a, weight0), _mm256_mullo_epi16(b, weight1)), _mm256_set1_epi16(128)), 8);
+}
+
+WCAM_TARGET("avx2")
+void blend_rows(uint8_t const* row0, uint8_t const* row1, uint8_t* out, size_t length, uint32_t weight)
+{
+    __m256i const zero    = _mm256_setzero_si256();
+    __m256i const weight0 = _mm256_set1_epi16(static_cast<int16_t>(256 - weight));
+    __m256i const weight1 = _mm256_set1_epi16(static_cast<int16_t>(weight));
+
+    size_t i = 0;
+    for (; i + 32 <= length; i += 32)
+    {
+        __m256i const a = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(row0 + i)); // NOLINT(*reinterpret-cast, *pointer-arithmetic)
+        __m256i const b = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(row1 + i)); // NOLINT(*reinterpret-cast, *pointer-arithmetic)
+        // The unpacks and the pack all work within each 128-bits lane, so the bytes end up in their original order
+        __m256i const lo = blend(_mm256_unpacklo_epi8(a, zero), _mm256_unpacklo_epi8(b, zero), weight0, weight1);
+        __m256i const hi = blend(_mm256_unpackhi_epi8(a, zero), _mm256_unpackhi_epi8(b, zero), weight0, weight1);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), _mm256_packus_epi16(lo, hi)); // NOLINT(*reinterpret-cast, *pointer-arithmetic)
+    }
+    sse4_1::blend_rows(row0 + i, row1 + i, out + i, length - i, weight); // NOLINT(*pointer-arithmetic)
+}
+
+WCAM_TARGET("avx2")
+void add_row(uint8_t const* row, uint16_t* sums, size_t length)
+{
+    size_t i = 0;
+    for (; i + 32 <= length; i += 32)
+    {
+        __m256i const in = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(row + i)); // NOLINT(*reinterpret-cast, *pointer-arithmetic)
+        auto* const   lo = reinterpret_cast<__m256i*>(sums + i);                           // NOLINT(*reinterpret-cast, *pointer-arithmetic)
+        auto* const   hi = reinterpret_cast<__m256i*>(sums + i + 16);                      // NOLINT(*reinterpret-cast, *pointer-arithmetic)
+        _mm256_storeu_si256(lo, _mm256_add_epi16(_mm256_loadu_si256(lo), _mm256_cvtepu8_epi16(_mm256_castsi256_si128(in))));
+        _mm256_storeu_si256(hi, _mm256_add_epi16(_mm256_loadu_si256(hi), _mm256_cvtepu8_epi16(_mm256_extracti128_si256(in, 1))));
+    }
+    sse4_1::add_row(row + i, sums + i, length - i); // NOLINT(*pointer-arithmetic)
+}
+
+WCAM_TARGET("avx2")
+void YUYV_to_RGB24(uint8_t const* yuyv, uint8_t* rgb, uint32_t width, YUVCoefficients const& coefs)
+{
+    YUYV_to_pixels<ChannelOrder::RGB>(yuyv, rgb, width, coefs);
+}
+
+WCAM_TARGET("avx2")
+void YUYV_to_BGR24(uint8_t const* yuyv, uint8_t* bgr, uint32_t width, YUVCoefficients const& coefs)
+{
+    YUYV_to_pixels<ChannelOrder::BGR>(yuyv, bgr, width, coefs);
+}
+
+WCAM_TARGET("avx2")
+void YUYV_to_RGBA32(uint8_t const* yuyv, uint8_t* rgba, uint32_t width, YUVCoefficients const& coefs)
+{
+    YUYV_to_pixels<ChannelOrder::RGBA>(yuyv, rgba, width, coefs);
+}
+
+WCAM_TARGET("avx2")
+void YUYV_to_BGRA32(uint8_t const* yuyv, uint8_t* bgra, uint32_t width, YUVCoefficients const& coefs)
+{
+    YUYV_to_pixels<ChannelOrder::BGRA>(yuyv, bgra, width, coefs);
+}
+
+WCAM_TARGET("avx2")
+void NV12_to_RGB24(uint8_t const* y_row0, uint8_t const* y_row1, uint8_t const* uv_row, uint8_t* rgb_row0, uint8_t* rgb_row1, uint32_t width, YUVCoefficients const& coefs)
+{
+    NV12_to_pixels<ChannelOrder::RGB>(y_row0, y_row1, uv_row, rgb_row0, rgb_row1, width, coefs);
+}
+
+WCAM_TARGET("avx2")
+void NV12_to_BGR24(uint8_t const* y_row0, uint8_t const* y_row1, uint8_t const* uv_row, uint8_t* bgr_row0, uint8_t* bgr_row1, uint32_t width, YUVCoefficients const& coefs)
+{
+    NV12_to_pixels<ChannelOrder::BGR>(y_row0, y_row1, uv_row, bgr_row0, bgr_row1, width, coefs);
+}
+
+WCAM_TARGET("avx2")
+void NV12_to_RGBA32(uint8_t const* y_row0, uint8_t const* y_row1, uint8_t const* uv_row, uint8_t* rgba_row0, uint8_t* rgba_row1, uint32_t width, YUVCoefficients const& coefs)
+{
+    NV12_to_pixels<ChannelOrder::RGBA>(y_row0, y_row1, uv_row, rgba_row0, rgba_row1, width, coefs);
+}
+
+WCAM_TARGET("avx2")
+void NV12_to_BGRA32(uint8_t const* y_row0, uint8_t const* y_row1, uint8_t const* uv_row, uint8_t* bgra_row0, uint8_t* bgra_row1, uint32_t width, YUVCoefficients const& coefs)
+{
+    NV12_to_pixels<ChannelOrder::BGRA>(y_row0, y_row1, uv_row, bgra_row0, bgra_row1, width, coefs);
+}
+
+} // namespace avx2
+
+} // namespace wcam::internal
+
+#endif
\ No newline at end of file
@@ -0,0 +1,367 @@
+#include "tensors.hpp"
+#include <algorithm>
+#include <bit>
+#include <cassert>
+#include <cstddef>
+#include <memory>
+#include <type_traits>
+#include "BufferPool.hpp"
+#include "ConversionPool.hpp"
+#include "ImageFactory.hpp"
+#include "OutputBuffer.hpp"
+#include "conversions.hpp"
+#include "row_conversions.hpp"
+
+namespace wcam::internal {
+
+TensorDestination::TensorDestination(uint8_t* data, std::array<Plane, 3> const& planes, size_t bytes_per_value, Resolution source_resolution, FirstRowIs source_row_order, Orientation const& orientation, TensorFormat const& format)
+    : _data{data}
+    , _planes{planes}
+    , _bytes_per_value{bytes_per_value}
+    , _source_width{source_resolution.width()}
+    , _resolution{format.resolution.value_or(source_resolution)}
+{
+    assert(!rotates_by_90(orientation));
+    bool const normalizes_order = orientation.normalize_row_order || orientation.rotation != Rotation::None;
+    bool const flips            = normalizes_order && source_row_order == FirstRowIs::Bottom;
+    bool const rotates_by_180   = orientation.rotation == Rotation::Clockwise180;
+
+    _row_order = flips ? FirstRowIs::Top : source_row_order;
+    _flips_x   = orientation.mirror != rotates_by_180;
+    _flips_y   = flips != rotates_by_180;
+
+    _columns = bilinear_samples(source_resolution.width(), _resolution.width());
+    _rows    = bilinear_samples(source_resolution.height(), _resolution.height());
+
+    for (size_t c = 0; c < 3; ++c)
+    {
+        _scale[c] = 1.f / (255.f * format.standard_deviation[c]);  // NOLINT(*constant-array-index)
+        _bias[c]  = -format.mean[c] / format.standard_deviation[c]; // NOLINT(*constant-array-index)
+    }
+}
+
+/// Converts to the nearest half-precision float (ties to even)
+static auto to_half(float value) -> uint16_t
+{
+    auto const     bits = std::bit_cast<uint32_t>(value);
+    auto const     sign = static_cast<uint16_t>((bits >> 16) & 0x8000);
+    uint32_t const abs  = bits & 0x7FFFFFFF;
+    if (abs >= 0x47800000) // Too big for a half, or already infinite or NaN
+        return static_cast<uint16_t>(sign | (abs > 0x7F800000 ? 0x7E00 : 0x7C00));
+    if (abs < 0x38800000) // A subnormal half: adding 0.5 makes the float hardware round it, because the last bit of 0.5 is worth the same as the last bit of a subnormal half
+        return static_cast<uint16_t>(sign | (std::bit_cast<uint32_t>(std::bit_cast<float>(abs) + 0.5f) - 0x3F000000));
+    // Rebias the exponent from 127 to 15, and round the 13 bits we drop to nearest, ties to even
+    return static_cast<uint16_t>(sign | ((abs + 0xC8000FFF + ((abs >> 13) & 1)) >> 13));
+}
+
+template<typename Value>
+static auto to_value(float value) -> Value
+{
+    if constexpr (std::is_same_v<Value, float>)
+        return value;
+    else
+        return to_half(value);
+}
+
+template<typename Value>
+void TensorDestination::write_row_impl(uint32_t t, uint8_t const* first_rgb_row, uint8_t const* second_rgb_row) const
+{
+    auto const  width = _resolution.width();
+    auto const& row   = _rows[t]; // NOLINT(*constant-array-index)
+    auto const  y     = _flips_y ? _resolution.height() - 1 - t : t;
+    auto const  step  = _flips_x ? std::ptrdiff_t{-1} : std::ptrdiff_t{1};
+
+    for (size_t c = 0; c < 3; ++c)
+    {
+        uint8_t* const       row_start = _data + _planes[c].offset + static_cast<size_t>(y) * _planes[c].stride; // NOLINT(*pointer-arithmetic, *constant-array-index)
+        Value* const         values    = reinterpret_cast<Value*>(row_start) + (_flips_x ? width - 1 : 0);       // NOLINT(*reinterpret-cast, *pointer-arithmetic)
+        uint8_t const* const top       = first_rgb_row + c;                                                      // NOLINT(*pointer-arithmetic)
+        uint8_t const* const bottom    = second_rgb_row + c;                                                     // NOLINT(*pointer-arithmetic)
+        float const          scale     = _scale[c];                                                              // NOLINT(*constant-array-index)
+        float const          bias      = _bias[c];                                                               // NOLINT(*constant-array-index)
+        float const          weight    = row.weight;
+        auto const           store     = [&](uint32_t i, float value) {
+            values[static_cast<std::ptrdiff_t>(i) * step] = to_value<Value>(value * scale + bias); // NOLINT(*pointer-arithmetic)
+        };
+
+        // Fast paths for when the tensor has the same width as the source, and for the rows that fall exactly on a source row
+        if (_resolution.width() == _source_width && weight == 0.f)
+        {
+            for (uint32_t i = 0; i < width; ++i)
+                store(i, static_cast<float>(top[i * 3])); // NOLINT(*pointer-arithmetic)
+        }
+        else if (_resolution.width() == _source_width)
+        {
+            for (uint32_t i = 0; i < width; ++i)
+            {
+                auto const top_value    = static_cast<float>(top[i * 3]);    // NOLINT(*pointer-arithmetic)
+                auto const bottom_value = static_cast<float>(bottom[i * 3]); // NOLINT(*pointer-arithmetic)
+                store(i, top_value + (bottom_value - top_value) * weight);
+            }
+        }
+        else
+        {
+            for (uint32_t i = 0; i < width; ++i)
+            {
+                auto const& column = _columns[i]; // NOLINT(*constant-array-index)
+                auto const  lerp   = [&](uint8_t const* channel) {
+                    auto const first  = static_cast<float>(channel[column.first * 3]);  // NOLINT(*pointer-arithmetic)
+                    auto const second = static_cast<float>(channel[column.second * 3]); // NOLINT(*pointer-arithmetic)
+                    return first + (second - first) * column.weight;
+                };
+                float const top_value    = lerp(top);
+                float const bottom_value = lerp(bottom);
+                store(i, top_value + (bottom_value - top_value) * weight);
+            }
+        }
+    }
+}
+
+void TensorDestination::write_row(uint32_t t, uint8_t const* first_rgb_row, uint8_t const* second_rgb_row) const
+{
+    if (_bytes_per_value == sizeof(float))
+        write_row_impl<float>(t, first_rgb_row, second_rgb_row);
+    else
+        write_row_impl<uint16_t>(t, first_rgb_row, second_rgb_row);
+}
+
+/// The last source rows that a stripe has converted to RGB24, by groups of `rows_per_group` (e.g. 2 for NV12, whose rows share their chroma by pairs).
+/// The rows of a tensor are computed in the order of the source rows, so each group is only converted once, even when several rows of the tensor use it (e.g. when upscaling).
+class ConvertedRows {
+public:
+    ConvertedRows(size_t row_length, uint32_t rows_per_group)
+        : _row_length{row_length}
+        , _rows_per_group{rows_per_group}
+    {
+        for (auto& group : _groups)
+            group.resize(row_length * rows_per_group);
+    }
+
+    /// `convert_group(first_row, rgb_rows)` must write the `rows_per_group` rows starting at `first_row`, one after the other
+    template<typename ConvertGroup>
+    auto row(uint32_t y, ConvertGroup const& convert_group) -> uint8_t const*
+    {
+        auto const group = static_cast<int64_t>(y / _rows_per_group);
+        size_t     slot  = _indices[0] == group ? 0 : 1;
+        if (_indices[slot] != group)
+        {
+            slot = _indices[0] < _indices[1] ? 0 : 1; // The rows are requested in increasing order, so the oldest group won't be used anymore
+            convert_group(y - y % _rows_per_group, _groups[slot].data()); // NOLINT(*constant-array-index)
+            _indices[slot] = group;                                       // NOLINT(*constant-array-index)
+        }
+        return _groups[slot].data() + (y % _rows_per_group) * _row_length; // NOLINT(*pointer-arithmetic, *constant-array-index)
+    }
+
+private:
+    size_t                              _row_length;
+    uint32_t                            _rows_per_group;
+    std::array<std::vector<uint8_t>, 2> _groups{};
+    std::array<int64_t, 2>              _indices{-1, -1};
+};
+
+/// Computes all the rows of the tensor, possibly in parallel, from source rows that `convert_group` converts to RGB24 (see ConvertedRows)
+template<typename ConvertGroup>
+static void fill_tensor_rows(TensorDestination const& destination, uint32_t rows_per_group, ConvertGroup const& convert_group)
+{
+    conversion_pool().convert(destination.resolution().height(), destination.bytes_per_row(), 1, [&](uint32_t begin, uint32_t end) {
+        auto rows = ConvertedRows{static_cast<size_t>(destination.source_width()) * 3, rows_per_group};
+        for (uint32_t t = begin; t < end; ++t)
+        {
+            uint8_t const* const first_row  = rows.row(destination.first_source_row(t), convert_group);
+            uint8_t const* const second_row = rows.row(destination.second_source_row(t), convert_group);
+            destination.write_row(t, first_row, second_row);
+        }
+    });
+}
+
+static void fill_tensor(ImageDataView<RGB24> const& data, TensorDestination const& destination)
+{
+    uint8_t const* source = data.plane(0);
+    auto const     stride = data.stride(0);
+    conversion_pool().convert(destination.resolution().height(), destination.bytes_per_row(), 1, [&](uint32_t begin, uint32_t end) {
+        for (uint32_t t = begin; t < end; ++t)
+            destination.write_row(t, source + destination.first_source_row(t) * stride, source + destination.second_source_row(t) * stride); // NOLINT(*pointer-arithmetic)
+    });
+}
+
+template<typename PixelFormatT>
+static void fill_tensor(ImageDataView<PixelFormatT> const& data, RGB_RowConversion conversion, TensorDestination const& destination)
+{
+    auto const     width  = data.resolution().width();
+    uint8_t const* source = data.plane(0);
+    auto const     stride = data.stride(0);
+    fill_tensor_rows(destination, 1, [&](uint32_t y, uint8_t* rgb_row) {
+        conversion(source + y * stride, rgb_row, width); // NOLINT(*pointer-arithmetic)
+    });
+}
+
+static void fill_tensor(ImageDataView<BGR24> const& data, TensorDestination const& destination)
+{
+    fill_tensor(data, row_conversions().swap_red_and_blue, destination);
+}
+
+static void fill_tensor(ImageDataView<RGBA32> const& data, TensorDestination const& destination)
+{
+    fill_tensor(data, row_conversions().remove_alpha, destination);
+}
+
+static void fill_tensor(ImageDataView<BGRA32> const& data, TensorDestination const& destination)
+{
+    fill_tensor(data, row_conversions().remove_alpha_and_swap_red_and_blue, destination);
+}
+
+static void fill_tensor(ImageDataView<GREY8> const& data, TensorDestination const& destination)
+{
+    fill_tensor(data, row_conversions().GREY8_to_RGB24, destination);
+}
+
+static void fill_tensor(ImageDataView<YUYV> const& data, TensorDestination const& destination)
+{
+    auto const     width        = data.resolution().width();
+    uint8_t const* yuyv         = data.plane(0);
+    auto const     stride       = data.stride(0);
+    auto const&    coefficients = yuv_coefficients(data.yuv_encoding());
+    auto const     conversion   = row_conversions().YUYV_to_RGB24;
+    fill_tensor_rows(destination, 1, [&](uint32_t y, uint8_t* rgb_row) {
+        conversion(yuyv + y * stride, rgb_row, width, coefficients); // NOLINT(*pointer-arithmetic)
+    });
+}
+
+static void fill_tensor(ImageDataView<NV12> const& data, TensorDestination const& destination)
+{
+    auto const           width        = data.resolution().width();
+    auto const           height       = data.resolution().height();
+    uint8_t const* const y_plane      = data.plane(0);
+    uint8_t const* const uv_plane     = data.plane(1);
+    auto const           y_stride     = data.stride(0);
+    auto const           uv_stride    = data.stride(1);
+    auto const&          coefficients = yuv_coefficients(data.yuv_encoding());
+    auto const           conversion   = row_conversions().NV12_to_RGB24;
+    fill_tensor_rows(destination, 2, [&](uint32_t y, uint8_t* rgb_rows) {
+        auto const y1 = std::min(y + 1, height - 1); // If the height is odd, the last row is converted twice
+        conversion(
+            y_plane + y * y_stride, y_plane + y1 * y_stride,     // NOLINT(*pointer-arithmetic)
+            uv_plane + (y / 2) * uv_stride,                      // NOLINT(*pointer-arithmetic)
+            rgb_rows, rgb_rows + static_cast<size_t>(width) * 3, // NOLINT(*pointer-arithmetic)
+            width,
+            coefficients
+        );
+    });
+}
+
+static void fill_tensor(ImageDataView<I420> const& data, TensorDestination const& destination)
+{
+    auto const           width        = data.resolution().width();
+    auto const           height       = data.resolution().height();
+    auto const           chroma_width = (width + 1) / 2;
+    uint8_t const* const y_plane      = data.plane(0);
+    uint8_t const* const u_plane      = data.plane(1);
+    uint8_t const* const v_plane      = data.plane(2);
+    auto const           y_stride     = data.stride(0);
+    auto const           u_stride     = data.stride(1);
+    auto const           v_stride     = data.stride(2);
+    auto const&          coefficients = yuv_coefficients(data.yuv_encoding());
+    auto const           conversion   = row_conversions().NV12_to_RGB24;
+    fill_tensor_rows(destination, 2, [&](uint32_t y, uint8_t* rgb_rows) {
+        // Interleaves the u and v samples, to use the conversion of NV12
+        thread_local auto uv_row = std::vector<uint8_t>{};
+        uv_row.resize(static_cast<size_t>(chroma_width) * 2);
+        row_conversions().merge_chroma(u_plane + (y / 2) * u_stride, v_plane + (y / 2) * v_stride, uv_row.data(), chroma_width); // NOLINT(*pointer-arithmetic)
+
+        auto const y1 = std::min(y + 1, height - 1); // If the height is odd, the last row is converted twice
+        conversion(
+            y_plane + y * y_stride, y_plane + y1 * y_stride,     // NOLINT(*pointer-arithmetic)
+            uv_row.data(),
+            rgb_rows, rgb_rows + static_cast<size_t>(width) * 3, // NOLINT(*pointer-arithmetic)
+            width,
+            coefficients
+        );
+    });
+}
+
+template<typename PixelFormatT>
+static void make_tensor_and_set_data(Image& image, Resolution source_resolution, FirstRowIs source_row_order, Orientation const& orientation, TensorFormat const& format, std::function<void(TensorDestination const&)> const& fill)
+{
+    auto       output      = OutputBuffer<PixelFormatT>{image, format.resolution.value_or(source_resolution)};
+    auto const destination = TensorDestination{output.data(), output.planes(), PixelFormatT::bytes_per_value, source_resolution, source_row_order, orientation, format};
+    fill(destination);
+    output.set_data(image, destination.row_order());
+}
+
+void make_tensor_and_set_data(Image& image, Resolution source_resolution, FirstRowIs source_row_order, Orientation const& orientation, TensorFormat const& format, std::function<void(TensorDestination const&)> const& fill)
+{
+    if (image_factory().implemented_formats().contains<PlanarRGBF32>())
+        make_tensor_and_set_data<PlanarRGBF32>(image, source_resolution, source_row_order, orientation, format, fill);
+    else
+        make_tensor_and_set_data<PlanarRGBF16>(image, source_resolution, source_row_order, orientation, format, fill);
+}
+
+template<typename PixelFormatT>
+static void set_tensor_data_impl(Image& image, ImageDataView<PixelFormatT> const& data, Orientation const& orientation, TensorFormat const& format)
+{
+    if (rotates_by_90(orientation))
+    {
+        // The rows of the tensor would be columns of the source, which we can't read efficiently, so we rotate the image first
+        auto       rgb_data    = buffer_pool().get(RGB24::data_length(data.resolution()));
+        auto const destination = Destination{rgb_data.get(), RGB24::bytes_per_pixel, data.resolution(), data.row_order(), orientation};
+        convert(data, RGB24{}, destination);
+        set_tensor_data(image, ImageDataView<RGB24>{std::move(rgb_data), RGB24::data_length(destination.resolution()), destination.resolution(), destination.row_order()}, Orientation{}, format);
+        return;
+    }
+    make_tensor_and_set_data(image, data.resolution(), data.row_order(), orientation, format, [&](TensorDestination const& destination) {
+        fill_tensor(data, destination);
+    });
+}
+
+void set_tensor_data(Image& image, ImageDataView<RGB24> const& data, Orientation const& orientation, TensorFormat const& format)
+{
+    set_tensor_data_impl(image, data, orientation, format);
+}
+
+void set_tensor_data(Image& image, ImageDataView<BGR24> const& data, Orientation const& orientation, TensorFormat const& format)
+{
+    set_tensor_data_impl(image, data, orientation, format);
+}
+
+void set_tensor_data(Image& image, ImageDataView<RGBA32> const& data, Orientation const& orientation, TensorFormat const& format)
+{
+    set_tensor_data_impl(image, data, orientation, format);
+}
+
+void set_tensor_data(Image& image, ImageDataView<BGRA32> const& data, Orientation const& orientation, TensorFormat const& format)
+{
+    set_tensor_data_impl(image, data, orientation, format);
+}
+
+void set_tensor_data(Image& image, ImageDataView<NV12> const& data, Orientation const& orientation, TensorFormat const& format)
+{
+    set_tensor_data_impl(image, data, orientation, format);
+}
+
+void set_tensor_data(Image& image, ImageDataView<I420> const& data, Orientation const& orientation, TensorFormat const& format)
+{
+    set_tensor_data_impl(image, data, orientation, format);
+}
+
+void set_tensor_data(Image& image, ImageDataView<YUYV> const& data, Orientation const& orientation, TensorFormat const& format)
+{
+    set_tensor_data_impl(image, data, orientation, format);
+}
+
+void set_tensor_data(Image& image, ImageDataView<GREY8> const& data, Orientation const& orientation, TensorFormat const& format)
+{
+    set_tensor_data_impl(image, data, orientation, format);
+}
+
+auto wants_tensors() -> bool
+{
+    auto const& formats = image_factory().implemented_formats();
+    return formats.contains<PlanarRGBF32>() || formats.contains<PlanarRGBF16>();
+}
+
+auto rotates_by_90(Orientation const& orientation) -> bool
+{
+    return orientation.rotation == Rotation::Clockwise90 || orientation.rotation == Rotation::Clockwise270;
+}
+
+} // namespace wcam::internal
\ No newline at end of file
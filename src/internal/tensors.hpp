@@ -0,0 +1,76 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+#include "../FirstRowIs.hpp"
+#include "../Image.hpp"
+#include "../Orientation.hpp"
+#include "../Resolution.hpp"
+#include "../TensorFormat.hpp"
+#include "resize.hpp"
+
+namespace wcam::internal {
+
+/// Where the rows of a tensor (PlanarRGBF32 or PlanarRGBF16) are written.
+/// Each row of the tensor is computed from two RGB24 rows of the source image, by resizing them, converting them to floats and normalizing them, all at once.
+/// The rows of the tensor are numbered in the order of the source rows they use, so that a source that can only be read from top to bottom (e.g. a JPEG decoder) can compute them in order.
+/// It applies an Orientation on the fly, except for the 90° and 270° rotations, that must have been applied to the source already.
+class TensorDestination {
+public:
+    /// `source_resolution` and `source_row_order` are the ones of the image that is being converted. `planes` are the ones of the R, G and B planes of the tensor.
+    TensorDestination(uint8_t* data, std::array<Plane, 3> const& planes, size_t bytes_per_value, Resolution source_resolution, FirstRowIs source_row_order, Orientation const& orientation, TensorFormat const& format);
+
+    [[nodiscard]] auto resolution() const -> Resolution { return _resolution; }
+    [[nodiscard]] auto row_order() const -> FirstRowIs { return _row_order; }
+    /// Width of the rows of the source image
+    [[nodiscard]] auto source_width() const -> uint32_t { return _source_width; }
+    [[nodiscard]] auto bytes_per_row() const -> size_t { return static_cast<size_t>(_resolution.width()) * 3 * _bytes_per_value; }
+
+    /// The two rows of the source image that the row `t` of the tensor is interpolated from. They never decrease when `t` increases.
+    [[nodiscard]] auto first_source_row(uint32_t t) const -> uint32_t { return _rows[t].first; }   // NOLINT(*constant-array-index)
+    [[nodiscard]] auto second_source_row(uint32_t t) const -> uint32_t { return _rows[t].second; } // NOLINT(*constant-array-index)
+    /// Computes the row `t` of the tensor, from the RGB24 rows first_source_row(t) and second_source_row(t) of the source image
+    void write_row(uint32_t t, uint8_t const* first_rgb_row, uint8_t const* second_rgb_row) const;
+
+private:
+    template<typename Value>
+    void write_row_impl(uint32_t t, uint8_t const* first_rgb_row, uint8_t const* second_rgb_row) const;
+
+private:
+    uint8_t*                    _data{};
+    std::array<Plane, 3>        _planes{};
+    size_t                      _bytes_per_value{};
+    uint32_t                    _source_width{};
+    Resolution                  _resolution{};
+    FirstRowIs                  _row_order{};
+    bool                        _flips_x{};
+    bool                        _flips_y{};
+    std::vector<BilinearSample> _columns{};
+    std::vector<BilinearSample> _rows{};
+    std::array<float, 3>        _scale{}; // 1 / (255 * standard_deviation)
+    std::array<float, 3>        _bias{};  // -mean / standard_deviation
+};
+
+/// Allocates a tensor in the format that the Image implements, calls `fill` to compute it, and gives it to the Image.
+/// `orientation` must not rotate by 90° or 270° (see TensorDestination).
+void make_tensor_and_set_data(Image&, Resolution source_resolution, FirstRowIs source_row_order, Orientation const&, TensorFormat const&, std::function<void(TensorDestination const&)> const& fill);
+
+/// Gives the image data to the Image as a tensor. Only valid if the Image implements PlanarRGBF32 or PlanarRGBF16.
+void set_tensor_data(Image&, ImageDataView<RGB24> const&, Orientation const&, TensorFormat const&);
+void set_tensor_data(Image&, ImageDataView<BGR24> const&, Orientation const&, TensorFormat const&);
+void set_tensor_data(Image&, ImageDataView<RGBA32> const&, Orientation const&, TensorFormat const&);
+void set_tensor_data(Image&, ImageDataView<BGRA32> const&, Orientation const&, TensorFormat const&);
+void set_tensor_data(Image&, ImageDataView<NV12> const&, Orientation const&, TensorFormat const&);
+void set_tensor_data(Image&, ImageDataView<I420> const&, Orientation const&, TensorFormat const&);
+void set_tensor_data(Image&, ImageDataView<YUYV> const&, Orientation const&, TensorFormat const&);
+void set_tensor_data(Image&, ImageDataView<GREY8> const&, Orientation const&, TensorFormat const&);
+
+/// Returns true iff the Image wants tensors instead of images
+auto wants_tensors() -> bool;
+
+/// Returns true iff that orientation can't be applied by a TensorDestination
+auto rotates_by_90(Orientation const&) -> bool;
+
+} // namespace wcam::internal
\ No newline at end of file
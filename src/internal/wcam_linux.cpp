@@ -6,14 +6,28 @@
 #include <linux/videodev2.h>
 #include <sys/ioctl.h>
 #include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/sysmacros.h>
+#include <cstring>
+#include <exception>
 #include <filesystem>
+#include <fstream>
 #include <functional>
+#include <optional>
+#include <span>
 // #include <source_location>
 #include "../Info.hpp"
+#include "BufferPool.hpp"
+#include "CapabilitiesCache.hpp"
+#include "ConversionPool.hpp"
 #include "Cool/get_system_error.hpp"
 #include "ImageFactory.hpp"
+#include "JpegSlices.hpp"
+#include "OutputBuffer.hpp"
+#include "conversions.hpp"
 #include "fallback_webcam_name.hpp"
 #include "make_device_id.hpp"
+#include "row_conversions.hpp"
 
 namespace wcam::internal {
 
@@ -72,9 +86,10 @@ static auto find_webcam_name(int webcam_handle) -> std::string
     return reinterpret_cast<const char*>(cap.card); // NOLINT(*-pro-type-reinterpret-cast)
 }
 
-static auto find_resolutions(int webcam_handle) -> std::vector<Resolution>
+/// Only lists the sizes that have a discrete frame interval, in the order the device reports them
+static auto find_formats(int webcam_handle) -> std::vector<PixelFormatAndResolution>
 {
-    auto resolutions = std::vector<Resolution>{};
+    auto formats = std::vector<PixelFormatAndResolution>{};
 
     auto format_description = v4l2_fmtdesc{};
     format_description.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
@@ -95,12 +110,68 @@ static auto find_resolutions(int webcam_handle) -> std::vector<Resolution>
             {
                 if (frame_interval.type != V4L2_FRMIVAL_TYPE_DISCRETE)
                     continue;
-                resolutions.emplace_back(static_cast<Resolution::DataType>(frame_interval.width), static_cast<Resolution::DataType>(frame_interval.height));
+                formats.push_back({format_description.pixelformat, Resolution{static_cast<Resolution::DataType>(frame_interval.width), static_cast<Resolution::DataType>(frame_interval.height)}});
             }
         }
     }
 
-    return resolutions;
+    return formats;
+}
+
+static auto read_first_line(std::filesystem::path const& file_path) -> std::string
+{
+    auto file = std::ifstream{file_path};
+    auto line = std::string{};
+    std::getline(file, line);
+    return line;
+}
+
+/// Returns nullopt if the device is not plugged in
+static auto device_identity(std::filesystem::path const& webcam_path) -> std::optional<DeviceIdentity>
+{
+    struct stat device_stat; // NOLINT(*member-init)
+    if (stat(webcam_path.string().c_str(), &device_stat) == -1) // Follows the /dev/v4l/by-id link to the actual /dev/videoN node, which gets recreated every time the device is plugged in
+        return std::nullopt;
+
+    return DeviceIdentity{
+        .inode         = device_stat.st_ino,
+        .change_time   = static_cast<int64_t>(device_stat.st_ctim.tv_sec) * 1'000'000'000 + static_cast<int64_t>(device_stat.st_ctim.tv_nsec),
+        .serial_number = read_first_line(fmt::format("/sys/dev/char/{}:{}/device/../serial", major(device_stat.st_rdev), minor(device_stat.st_rdev))), // The video node is attached to one of the interfaces of the USB device. Empty if the device doesn't have a serial number
+    };
+}
+
+/// Answers from the cache whenever possible, because querying the capabilities of some cameras is really slow
+static auto device_capabilities(std::filesystem::path const& webcam_path) -> std::optional<DeviceCapabilities>
+{
+    auto const identity = device_identity(webcam_path);
+    if (!identity.has_value())
+        return std::nullopt;
+    if (auto capabilities = capabilities_cache().get(webcam_path.string(), *identity))
+        return capabilities;
+
+    int const webcam_handle = open(webcam_path.string().c_str(), O_RDONLY);
+    if (webcam_handle == -1)
+        return std::nullopt;
+    auto const scope_guard = FileRAII{webcam_handle};
+
+    auto capabilities = DeviceCapabilities{find_webcam_name(webcam_handle), find_formats(webcam_handle)};
+    capabilities_cache().set(webcam_path.string(), *identity, capabilities); // Even when there are no formats (e.g. for the metadata nodes of UVC cameras), so that we don't query them again
+    return capabilities;
+}
+
+static auto grab_info(std::filesystem::path const& webcam_path) -> std::optional<Info>
+{
+    auto capabilities = device_capabilities(webcam_path);
+    if (!capabilities.has_value())
+        return std::nullopt;
+
+    auto resolutions = std::vector<Resolution>{};
+    for (auto const& format : capabilities->formats)
+        resolutions.push_back(format.resolution);
+    if (resolutions.empty())
+        return std::nullopt;
+
+    return Info{std::move(capabilities->name), webcam_id(webcam_path), std::move(resolutions)};
 }
 
 auto grab_all_infos_impl() -> std::vector<Info>
@@ -108,30 +179,39 @@ auto grab_all_infos_impl() -> std::vector<Info>
     auto infos = std::vector<Info>{};
 
     for_each_webcam_path([&](std::filesystem::path const& webcam_path) {
-        int const webcam_handle = open(webcam_path.string().c_str(), O_RDONLY);
-        if (webcam_handle == -1)
-            return;
-        auto const scope_guard = FileRAII{webcam_handle};
-
-        auto const resolutions = find_resolutions(webcam_handle);
-        if (resolutions.empty())
-            return;
-
-        infos.push_back({find_webcam_name(webcam_handle), webcam_id(webcam_path), resolutions});
+        auto webcam_info = grab_info(webcam_path);
+        if (webcam_info.has_value())
+            infos.push_back(std::move(*webcam_info));
     });
 
     return infos;
 }
 
+auto grab_info_impl(DeviceId const& id) -> std::optional<Info>
+{
+    return grab_info(webcam_path(id));
+}
+
 /// The list of formats we support for now. We will add more when the need arises.
 static auto is_supported_pixel_format(uint32_t format) -> bool
 {
     return format == V4L2_PIX_FMT_MJPEG
-           || format == V4L2_PIX_FMT_YUYV;
+           || format == V4L2_PIX_FMT_YUYV
+           || format == V4L2_PIX_FMT_GREY;
 }
 
-static auto select_pixel_format(int webcam_handle, Resolution resolution) -> uint32_t
+static auto select_pixel_format(DeviceId const& id, int webcam_handle, Resolution resolution) -> uint32_t
 {
+    if (auto const capabilities = device_capabilities(webcam_path(id)))
+    {
+        for (auto const& format : capabilities->formats)
+        {
+            if (format.resolution == resolution && is_supported_pixel_format(format.pixel_format))
+                return format.pixel_format;
+        }
+    }
+
+    // The cache only knows about the sizes that have a discrete frame interval, so we still ask the device in case it supports other sizes
     auto format_desc = v4l2_fmtdesc{};
     format_desc.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
 
@@ -154,6 +234,21 @@ static auto select_pixel_format(int webcam_handle, Resolution resolution) -> uin
     throw CaptureException{Error_Unknown{"Unsupported pixel format"}};
 }
 
+/// Reads the colorimetry that the driver has negotiated, resolving the "default" values the same way the kernel does
+static auto yuv_encoding(v4l2_pix_format const& format) -> YUVEncoding
+{
+    uint32_t const ycbcr_encoding = format.ycbcr_enc == V4L2_YCBCR_ENC_DEFAULT
+                                        ? static_cast<uint32_t>(V4L2_MAP_YCBCR_ENC_DEFAULT(format.colorspace))
+                                        : format.ycbcr_enc;
+    uint32_t const quantization = format.quantization == V4L2_QUANTIZATION_DEFAULT
+                                      ? static_cast<uint32_t>(V4L2_MAP_QUANTIZATION_DEFAULT(false, format.colorspace, ycbcr_encoding))
+                                      : format.quantization;
+    return YUVEncoding{
+        .matrix = ycbcr_encoding == V4L2_YCBCR_ENC_709 || ycbcr_encoding == V4L2_YCBCR_ENC_XV709 ? YUVMatrix::BT709 : YUVMatrix::BT601,
+        .range  = quantization == V4L2_QUANTIZATION_FULL_RANGE ? YUVRange::Full : YUVRange::Limited,
+    };
+}
+
 Buffer::~Buffer()
 {
     if (ptr != nullptr && ptr != MAP_FAILED)
@@ -166,13 +261,119 @@ Buffer::~Buffer()
     }
 }
 
-CaptureImpl::CaptureImpl(DeviceId const& id, Resolution const& resolution)
-    : _webcam_handle{open(webcam_path(id).c_str(), O_RDWR)}
+static constexpr uint32_t min_queued_buffers{3};        // Below that, the driver might have to drop images because it has nowhere to write them
+static constexpr uint32_t max_buffers{VIDEO_MAX_FRAME}; // The most that V4L2 accepts
+
+DriverBuffers::DriverBuffers(int webcam_handle, uint32_t count)
+    : _webcam_handle{webcam_handle}
+{
+    auto req   = v4l2_requestbuffers{};
+    req.count  = count;
+    req.type   = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    req.memory = V4L2_MEMORY_MMAP;
+    THROW_IF_ERR(ioctl(_webcam_handle, VIDIOC_REQBUFS, &req));
+
+    for (uint32_t i = 0; i < req.count; ++i) // The driver can give us a different number of buffers than the one we asked for
+        map_and_queue(i);
+}
+
+void DriverBuffers::map_and_queue(uint32_t index)
+{
+    auto buf   = v4l2_buffer{};
+    buf.type   = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    buf.memory = V4L2_MEMORY_MMAP;
+    buf.index  = index;
+
+    THROW_IF_ERR(ioctl(_webcam_handle, VIDIOC_QUERYBUF, &buf));
+
+    auto& buffer = *_buffers.emplace_back(std::make_unique<Buffer>());
+    buffer.size  = buf.length;
+    buffer.ptr   = mmap(nullptr, buf.length, PROT_READ | PROT_WRITE, MAP_SHARED, _webcam_handle, buf.m.offset);
+    THROW_IF(buffer.ptr == MAP_FAILED);
+    THROW_IF_ERR(ioctl(_webcam_handle, VIDIOC_QBUF, &buf));
+    _queued_count++;
+}
+
+auto DriverBuffers::add_buffer() -> bool
+{
+    if (!_can_add_buffers || _buffers.size() >= max_buffers)
+        return false;
+
+    auto create        = v4l2_create_buffers{};
+    create.count       = 1;
+    create.memory      = V4L2_MEMORY_MMAP;
+    create.format.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+
+    bool const has_format = ioctl(_webcam_handle, VIDIOC_G_FMT, &create.format) != -1;
+    bool const has_buffer = has_format && ioctl(_webcam_handle, VIDIOC_CREATE_BUFS, &create) != -1 && create.count == 1;
+    if (!has_buffer || create.index != _buffers.size())
+    {
+        _can_add_buffers = false; // Not all drivers can create buffers while streaming, and they won't start to
+        return false;
+    }
+    try
+    {
+        map_and_queue(create.index);
+    }
+    catch (CaptureException const&)
+    {
+        _can_add_buffers = false;
+        return false;
+    }
+    return true;
+}
+
+void DriverBuffers::on_dequeued()
+{
+    auto const lock = std::scoped_lock{_mutex};
+    _queued_count--;
+}
+
+auto DriverBuffers::lease(uint32_t index) -> std::shared_ptr<uint8_t const>
+{
+    {
+        auto const lock = std::scoped_lock{_mutex};
+        if (_queued_count < min_queued_buffers && !add_buffer())
+            return nullptr;
+    }
+    return std::shared_ptr<uint8_t const>{
+        static_cast<uint8_t const*>(buffer(index).ptr),
+        [buffers = shared_from_this(), index](uint8_t const*) {
+            buffers->give_back(index); // If it fails, the webcam has probably been unplugged, and the capture thread will report it
+        }
+    };
+}
+
+auto DriverBuffers::give_back(uint32_t index) -> bool
+{
+    auto const lock = std::scoped_lock{_mutex};
+    if (!_is_streaming)
+        return true;
+
+    auto buf   = v4l2_buffer{};
+    buf.type   = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    buf.memory = V4L2_MEMORY_MMAP;
+    buf.index  = index;
+    if (ioctl(_webcam_handle, VIDIOC_QBUF, &buf) == -1)
+        return false;
+    _queued_count++;
+    return true;
+}
+
+void DriverBuffers::stop()
+{
+    auto const lock = std::scoped_lock{_mutex};
+    _is_streaming   = false;
+}
+
+CaptureImpl::CaptureImpl(DeviceId const& id, Resolution const& resolution, std::shared_ptr<CaptureSettings const> settings)
+    : ICaptureImpl{std::move(settings)}
+    , _webcam_handle{open(webcam_path(id).c_str(), O_RDWR)}
     , _resolution{resolution}
 {
     if (_webcam_handle == -1)
         throw CaptureException{Error_WebcamUnplugged{}};
-    _pixel_format = select_pixel_format(_webcam_handle, resolution);
+    _pixel_format = select_pixel_format(id, _webcam_handle, resolution);
 
     {
         auto format                = v4l2_format{};
@@ -182,45 +383,32 @@ CaptureImpl::CaptureImpl(DeviceId const& id, Resolution const& resolution)
         format.fmt.pix.pixelformat = _pixel_format;
         format.fmt.pix.field       = V4L2_FIELD_NONE;
         THROW_IF_ERR(ioctl(_webcam_handle, VIDIOC_S_FMT, &format));
+        _bytes_per_line = format.fmt.pix.bytesperline; // The driver tells us how it has laid out the rows
+        _yuv_encoding   = yuv_encoding(format.fmt.pix);
     }
 
-    {
-        auto req   = v4l2_requestbuffers{};
-        req.count  = static_cast<unsigned int>(_buffers.size());
-        req.type   = V4L2_BUF_TYPE_VIDEO_CAPTURE;
-        req.memory = V4L2_MEMORY_MMAP;
-        THROW_IF_ERR(ioctl(_webcam_handle, VIDIOC_REQBUFS, &req));
-    }
-
-    for (size_t i = 0; i < _buffers.size(); ++i)
-    {
-        auto buf   = v4l2_buffer{};
-        buf.type   = V4L2_BUF_TYPE_VIDEO_CAPTURE;
-        buf.memory = V4L2_MEMORY_MMAP;
-        buf.index  = static_cast<unsigned int>(i);
-
-        THROW_IF_ERR(ioctl(_webcam_handle, VIDIOC_QUERYBUF, &buf));
-
-        _buffers[i].size = buf.length;                                                                                  // NOLINT(*constant-array-index)
-        _buffers[i].ptr  = mmap(nullptr, buf.length, PROT_READ | PROT_WRITE, MAP_SHARED, _webcam_handle, buf.m.offset); // NOLINT(*constant-array-index)
-        THROW_IF(_buffers[i].ptr == MAP_FAILED);                                                                        // NOLINT(*constant-array-index)
-        THROW_IF_ERR(ioctl(_webcam_handle, VIDIOC_QBUF, &buf));
-    }
+    if (_pixel_format == V4L2_PIX_FMT_MJPEG)
+        _jpeg_decoder = std::make_unique<JpegDecoder>();
+    _buffers = std::make_shared<DriverBuffers>(_webcam_handle, 6); // 6 is nice number that gives us good performance. More are added if the images hold on to them (see DriverBuffers::lease())
 
     {
         v4l2_buf_type type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
         THROW_IF_ERR(ioctl(_webcam_handle, VIDIOC_STREAMON, &type));
     }
 
-    // Start the thread once all the buffers are ready
-    _thread = std::thread{&CaptureImpl::thread_job, std::ref(*this)};
+    // Start the threads once all the buffers are ready
+    _decode_thread  = std::thread{&CaptureImpl::decode_thread_job, std::ref(*this)};
+    _dequeue_thread = std::thread{&CaptureImpl::dequeue_thread_job, std::ref(*this)};
 }
 
 CaptureImpl::~CaptureImpl()
 {
-    _wants_to_stop_thread.store(true);
-    _thread.join();
+    _wants_to_stop_threads.store(true);
+    _dequeue_thread.join();
+    _frames.close(); // Only once the dequeue thread has stopped, so that it can't push frames anymore
+    _decode_thread.join();
 
+    _buffers->stop(); // The images might still lease some buffers, and they must not give them back to a webcam that we have closed
     v4l2_buf_type type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
     if (ioctl(_webcam_handle, VIDIOC_STREAMOFF, &type) == -1)
     {
@@ -229,35 +417,535 @@ CaptureImpl::~CaptureImpl()
     }
 }
 
-void CaptureImpl::thread_job(CaptureImpl& This)
+void CaptureImpl::dequeue_thread_job(CaptureImpl& This)
 {
-    while (!This._wants_to_stop_thread.load())
-        This.process_next_image();
+    while (!This._wants_to_stop_threads.load())
+        This.dequeue_next_image();
 }
 
-static void mjpeg_to_rgb(Buffer const& buffer, unsigned char* rgb_data)
+void CaptureImpl::decode_thread_job(CaptureImpl& This)
 {
-    struct jpeg_decompress_struct info; // NOLINT(*member-init)
-    struct jpeg_error_mgr         err;  // NOLINT(*member-init)
+    while (auto const frame = This._frames.pop())
+        This.process_image(*frame);
+}
 
-    info.err = jpeg_std_error(&err);
-    jpeg_create_decompress(&info);
+/// Decodes the rows of a rectangle of a JPEG (see RegionOfInterest), from top to bottom.
+/// The rows above the rectangle are skipped, and the ones below it are not decoded at all. The columns outside of it are not decoded either, except the ones that share a block with it.
+class JpegRegionDecoder {
+public:
+    /// `region` must be inside the image (see clamp_region())
+    JpegRegionDecoder(JpegDecoder& decoder, J_COLOR_SPACE color_space, RegionOfInterest const& region)
+        : _decoder{decoder}
+        , _info{decoder.start(color_space)}
+        , _first_row{region.y}
+        , _width{region.size.width()}
+    {
+        if (region.size.width() != _info.output_width)
+        {
+            // We also decode the columns next to the region, so that the upsampling of the chroma at its edges is the same as in the full image
+            JDIMENSION x     = region.x > 0 ? region.x - 1 : 0;
+            JDIMENSION width = std::min(region.x + region.size.width() + 1, _info.output_width) - x;
+            _decoder.crop_rows(x, width); // Moves x to the start of a block, and widens the rows accordingly
+            _skipped_columns = region.x - x;
+        }
+        if (_first_row > 0)
+            _decoder.skip_rows(_first_row);
+    }
+    ~JpegRegionDecoder() { _decoder.stop(); }
+    JpegRegionDecoder(JpegRegionDecoder const&)                        = delete;
+    auto operator=(JpegRegionDecoder const&) -> JpegRegionDecoder&     = delete;
+    JpegRegionDecoder(JpegRegionDecoder&&) noexcept                    = delete;
+    auto operator=(JpegRegionDecoder&&) noexcept -> JpegRegionDecoder& = delete;
+
+    /// The number of bytes that read_row() writes
+    [[nodiscard]] auto decoded_row_length() const -> size_t { return static_cast<size_t>(_info.output_width) * static_cast<size_t>(_info.output_components); }
+    /// True iff read_row() writes exactly the row of the region, so that it can decode directly to the destination
+    [[nodiscard]] auto decodes_exact_rows() const -> bool { return _skipped_columns == 0 && _info.output_width == _width; }
+    /// The index (in the region) of the row that the next call to read_row() will decode
+    [[nodiscard]] auto next_row() const -> uint32_t { return _info.output_scanline - _first_row; }
+
+    /// Decodes the next row in `row` (which must be decoded_row_length() long), and returns where the row of the region starts in it
+    auto read_row(uint8_t* row) -> uint8_t*
+    {
+        _decoder.read_rows(&row, 1);
+        return region_start(row);
+    }
+    /// Decodes the next rows in `rows` (which must all be decoded_row_length() long), and returns how many it has decoded, which can be less than rows.size().
+    /// It is cheaper than read_row() when it can decode several rows at once (e.g. the two rows that share their chroma in a 4:2:0 image, with MjpegDecoding::Speed)
+    auto read_rows(std::span<uint8_t*> rows) -> uint32_t
+    {
+        return _decoder.read_rows(rows.data(), static_cast<JDIMENSION>(rows.size()));
+    }
+    /// Where the row of the region starts in a row that has been decoded by read_rows()
+    [[nodiscard]] auto region_start(uint8_t* row) const -> uint8_t*
+    {
+        return row + static_cast<size_t>(_skipped_columns) * static_cast<size_t>(_info.output_components); // NOLINT(*pointer-arithmetic)
+    }
+    void skip_rows(uint32_t count) { _decoder.skip_rows(count); }
 
-    jpeg_mem_src(&info, static_cast<unsigned char*>(buffer.ptr), buffer.size);
-    jpeg_read_header(&info, TRUE);
-    jpeg_start_decompress(&info);
+private:
+    JpegDecoder&            _decoder;
+    jpeg_decompress_struct& _info;
+    uint32_t                _first_row{};
+    uint32_t                _width{};
+    uint32_t                _skipped_columns{};
+};
 
-    while (info.output_scanline < info.output_height)
+static constexpr uint32_t rows_per_read{16}; // Enough for the tallest row groups that libjpeg-turbo outputs at once
+
+/// Decodes directly to the (possibly rotated / flipped) destination, several rows at a time.
+/// The first row of the region is written to the row `first_row` of the destination (e.g. when the JPEG is a slice of a bigger image, see JpegSlices).
+static void decode_mjpeg(JpegDecoder& jpeg, J_COLOR_SPACE color_space, RegionOfInterest const& region, Destination const& destination, uint32_t first_row = 0)
+{
+    auto       decoder      = JpegRegionDecoder{jpeg, color_space, region};
+    bool const is_direct    = decoder.decodes_exact_rows() && destination.direct_row(0) != nullptr;
+    auto       scratch_rows = std::vector<unsigned char>(is_direct ? 0 : decoder.decoded_row_length() * rows_per_read);
+    auto       rows         = std::array<unsigned char*, rows_per_read>{};
+    for (uint32_t y = 0; y < region.size.height();)
     {
-        unsigned char* buffer_array = rgb_data + static_cast<uint64_t>(info.output_scanline) * static_cast<uint64_t>(info.output_width) * static_cast<uint64_t>(info.output_components); // NOLINT(*pointer-arithmetic)
-        jpeg_read_scanlines(&info, &buffer_array, 1);
+        uint32_t const count = std::min(rows_per_read, region.size.height() - y);
+        for (uint32_t i = 0; i < count; ++i)
+            rows[i] = is_direct ? destination.direct_row(first_row + y + i) : scratch_rows.data() + static_cast<size_t>(i) * decoder.decoded_row_length(); // NOLINT(*constant-array-index, *pointer-arithmetic)
+        uint32_t const read = decoder.read_rows(std::span{rows.data(), count});
+        if (read == 0)
+            break; // libjpeg-turbo always gives us rows from a memory buffer, even when the JPEG is truncated, but we never want to loop forever
+        if (!is_direct)
+        {
+            for (uint32_t i = 0; i < read; ++i)
+                destination.write_row(first_row + y + i, decoder.region_start(rows[i])); // NOLINT(*constant-array-index)
+        }
+        y += read;
     }
+}
 
-    jpeg_finish_decompress(&info);
-    jpeg_destroy_decompress(&info);
+static constexpr uint32_t min_rows_per_slice{64}; // So that restarting the decoder for each slice stays negligible
+
+/// Splits the JPEG at its restart markers (see JpegSlices), and decodes the slices in parallel on the threads of the conversion pool, each to its own rows of the destination.
+/// The slices give exactly the same pixels as decoding the whole image.
+/// Returns false, without decoding anything, if the JPEG can't be split.
+static auto decode_mjpeg_in_slices(JpegDecoder& jpeg, J_COLOR_SPACE color_space, Destination const& destination) -> bool
+{
+    // With MjpegDecoding::Quality, libjpeg upsamples the chroma of each row from the chroma rows above and below it when the chroma has half as many rows,
+    // so the rows around each edge between slices would miss the chroma of the other slice, and show a seam on vertical changes of color
+    if (jpeg.decoding() == MjpegDecoding::Quality && jpeg.chroma_subsampling().vertical == 2)
+        return false;
+    auto const slices = JpegSlices{jpeg.data(), jpeg.size(), min_rows_per_slice};
+    if (slices.count() == 0)
+        return false;
+    auto const scale           = jpeg.scale_eighths(); // The slices start on rows of MCUs, whose height (8 or 16) stays a whole number of rows once scaled
+    auto const bytes_per_slice = static_cast<size_t>(destination.source_width()) * destination.bytes_per_pixel() * (slices.first_row(1) * scale / 8);
+    auto error       = std::exception_ptr{};
+    auto error_mutex = std::mutex{};
+    conversion_pool().convert(slices.count(), bytes_per_slice, 1, [&](uint32_t begin, uint32_t end) {
+        try
+        {
+            if (begin == 0 && end == slices.count())
+            {
+                // The pool gives us the whole image when it isn't worth splitting (or when its threads are busy), and it is then cheaper to decode it in one go
+                decode_mjpeg(jpeg, color_space, RegionOfInterest{0, 0, jpeg.output_resolution()}, destination);
+                return;
+            }
+            thread_local auto slice_jpeg    = std::vector<uint8_t>{};
+            thread_local auto slice_decoder = JpegDecoder{};
+            slices.make_jpeg(begin, end, slice_jpeg);
+            slice_decoder.set_image(slice_jpeg.data(), slice_jpeg.size(), jpeg.decoding(), scale);
+            decode_mjpeg(slice_decoder, color_space, RegionOfInterest{0, 0, slice_decoder.output_resolution()}, destination, slices.first_row(begin) * scale / 8);
+        }
+        catch (JpegError const&) // It must not reach the threads of the pool. We rethrow it on the thread that decodes the image, once all the slices are done
+        {
+            auto const lock = std::scoped_lock{error_mutex};
+            if (!error)
+                error = std::current_exception();
+        }
+    });
+    if (error)
+        std::rethrow_exception(error);
+    return true;
 }
 
-void CaptureImpl::process_next_image()
+/// Decodes the rows from top to bottom, and computes each row of the tensor as soon as the two source rows it uses have been decoded.
+/// The rows that no row of the tensor uses (e.g. when downscaling) are skipped, which avoids their color conversion and upsampling.
+static void decode_mjpeg(JpegDecoder& jpeg, RegionOfInterest const& region, TensorDestination const& destination)
+{
+    auto decoder = JpegRegionDecoder{jpeg, JCS_EXT_RGB, region};
+
+    // The two source rows used by a row of the tensor are consecutive, so we store each row in the slot given by its parity
+    auto rows   = std::array<std::vector<unsigned char>, 2>{};
+    auto starts = std::array<uint8_t const*, 2>{};
+    for (auto& row : rows)
+        row.resize(decoder.decoded_row_length());
+
+    for (uint32_t t = 0; t < destination.resolution().height(); ++t)
+    {
+        uint32_t const first  = destination.first_source_row(t);
+        uint32_t const second = destination.second_source_row(t);
+        if (decoder.next_row() < first)
+            decoder.skip_rows(first - decoder.next_row());
+        while (decoder.next_row() <= second)
+        {
+            auto const slot = decoder.next_row() % 2;
+            starts[slot]    = decoder.read_row(rows[slot].data()); // NOLINT(*constant-array-index)
+        }
+        destination.write_row(t, starts[first % 2], starts[second % 2]); // NOLINT(*constant-array-index)
+    }
+}
+
+/// Decodes the rows from top to bottom, and computes each row of the resized image as soon as the source rows it uses have been decoded.
+/// The rows that no row of the resized image uses (e.g. when downscaling with ResizeFilter::Bilinear) are skipped, which avoids their color conversion and upsampling.
+static void decode_mjpeg(JpegDecoder& jpeg, J_COLOR_SPACE color_space, RegionOfInterest const& region, ResizeDestination const& destination)
+{
+    auto decoder = JpegRegionDecoder{jpeg, color_space, region};
+
+    // The source rows that a row of the resized image uses are requested in increasing order, and only the last two need to be kept, so we store each row in the slot given by its parity
+    auto rows   = std::array<std::vector<unsigned char>, 2>{};
+    auto starts = std::array<uint8_t const*, 2>{};
+    for (auto& row : rows)
+        row.resize(decoder.decoded_row_length());
+    auto const row_length   = static_cast<size_t>(region.size.width()) * destination.bytes_per_pixel();
+    auto       filtered_row = std::vector<uint8_t>(row_length);
+    auto       sums         = std::vector<uint16_t>{};
+    auto       read_row     = [&](uint32_t y) -> uint8_t const* {
+        while (decoder.next_row() <= y)
+        {
+            auto const slot = decoder.next_row() % 2;
+            starts[slot]    = decoder.read_row(rows[slot].data()); // NOLINT(*constant-array-index)
+        }
+        return starts[y % 2]; // NOLINT(*constant-array-index)
+    };
+
+    for (uint32_t t = 0; t < destination.rows_count(); ++t)
+    {
+        uint32_t const first = destination.first_source_row(t);
+        if (decoder.next_row() < first)
+            decoder.skip_rows(first - decoder.next_row());
+        destination.filter_rows(t, row_length, read_row, filtered_row.data(), sums);
+        destination.write_row(t, filtered_row.data());
+    }
+}
+
+/// The rounded average of the chroma samples of a block of 2x2 pixels
+static auto average(uint8_t a, uint8_t b, uint8_t c, uint8_t d) -> uint8_t
+{
+    return static_cast<uint8_t>((a + b + c + d + 2) >> 2);
+}
+
+/// Decodes to NV12 or I420 without going through RGB: libjpeg-turbo gives us the Y, Cb and Cr of each pixel, and we average the chroma of each block of 2x2 pixels.
+/// decode_mjpeg_raw() is cheaper, but this one can decode a region of interest alone, and any JPEG.
+static void decode_mjpeg(JpegDecoder& jpeg, RegionOfInterest const& region, YUV420Destination const& destination)
+{
+    auto decoder = JpegRegionDecoder{jpeg, JCS_YCbCr, region};
+
+    auto const width        = region.size.width();
+    auto const height       = region.size.height();
+    auto const chroma_width = (width + 1) / 2;
+    auto const step         = destination.has_interleaved_chroma() ? size_t{2} : size_t{1}; // Distance between two u (or v) samples in the chroma rows
+    auto       ycbcr_rows   = std::array<std::vector<unsigned char>, 2>{};
+    auto       luma_rows    = std::array<std::vector<uint8_t>, 2>{};
+    auto       chroma_rows  = std::array<std::vector<uint8_t>, 2>{};
+    for (auto& row : ycbcr_rows)
+        row.resize(decoder.decoded_row_length());
+    for (auto& row : luma_rows)
+        row.resize(width);
+    for (auto& row : chroma_rows)
+        row.resize(chroma_width * step);
+    uint8_t* const u = chroma_rows[0].data();
+    uint8_t* const v = destination.has_interleaved_chroma() ? u + 1 : chroma_rows[1].data(); // NOLINT(*pointer-arithmetic)
+
+    for (uint32_t y = 0; y < height; y += 2)
+    {
+        auto const           y1   = std::min(y + 1, height - 1); // If the height is odd, the last row is used twice
+        uint8_t const* const row0 = decoder.read_row(ycbcr_rows[0].data());
+        uint8_t const* const row1 = y1 != y ? decoder.read_row(ycbcr_rows[1].data()) : row0;
+        for (uint32_t x = 0; x < width; ++x)
+        {
+            luma_rows[0][x] = row0[x * 3]; // NOLINT(*pointer-arithmetic)
+            luma_rows[1][x] = row1[x * 3]; // NOLINT(*pointer-arithmetic)
+        }
+        for (uint32_t cx = 0; cx < chroma_width; ++cx)
+        {
+            auto const x0 = cx * 2;
+            auto const x1 = std::min(x0 + 1, width - 1);
+            u[cx * step]  = average(row0[x0 * 3 + 1], row0[x1 * 3 + 1], row1[x0 * 3 + 1], row1[x1 * 3 + 1]); // NOLINT(*pointer-arithmetic)
+            v[cx * step]  = average(row0[x0 * 3 + 2], row0[x1 * 3 + 2], row1[x0 * 3 + 2], row1[x1 * 3 + 2]); // NOLINT(*pointer-arithmetic)
+        }
+        destination.luma().write_row(y, luma_rows[0].data());
+        destination.luma().write_row(y1, luma_rows[1].data());
+        destination.chroma(0).write_row(y / 2, chroma_rows[0].data());
+        if (!destination.has_interleaved_chroma())
+            destination.chroma(1).write_row(y / 2, chroma_rows[1].data());
+    }
+}
+
+/// Writes the row `y` of a plane, directly to its place if the Orientation allows it
+static void write_plane_row(Destination const& destination, uint32_t y, uint8_t const* row)
+{
+    if (uint8_t* const destination_row = destination.direct_row(y))
+        std::memcpy(destination_row, row, static_cast<size_t>(destination.source_width()) * destination.bytes_per_pixel());
+    else
+        destination.write_row(y, row);
+}
+
+/// Resamples the chroma of the JPEG to one sample for each pair of pixels (of a row), from the rows `row0` and `row1` of the JPEG's chroma (that can be the same row).
+/// Returns `row0` itself when it already is what we want, and otherwise writes the result in `resampled`.
+static auto resample_chroma(uint8_t const* row0, uint8_t const* row1, bool has_half_width_chroma, uint32_t width, uint8_t* resampled) -> uint8_t const*
+{
+    auto const chroma_width = (width + 1) / 2;
+    if (has_half_width_chroma)
+    {
+        if (row0 == row1)
+            return row0;
+        for (uint32_t x = 0; x < chroma_width; ++x)
+            resampled[x] = static_cast<uint8_t>((row0[x] + row1[x] + 1) >> 1); // NOLINT(*pointer-arithmetic)
+        return resampled;
+    }
+    for (uint32_t cx = 0; cx < chroma_width; ++cx)
+    {
+        auto const x0 = cx * 2;
+        auto const x1 = std::min(x0 + 1, width - 1);
+        resampled[cx] = average(row0[x0], row0[x1], row1[x0], row1[x1]); // NOLINT(*pointer-arithmetic)
+    }
+    return resampled;
+}
+
+/// Decodes the Y, Cb and Cr planes of the JPEG as they are stored, without upsampling nor converting them (see JpegDecoder::start_raw()).
+/// The Y plane is written to `luma`, and the chroma is given to `write_chroma(chroma_y, u_row, v_row)` with one sample for each pair of pixels of `chroma_rows_step` rows (2 for NV12 and I420, 1 for I422).
+/// The chroma is copied when the JPEG has the same number of samples, averaged when it has more (e.g. 4:2:2 to I420), and duplicated when it has less (4:2:0 to I422).
+/// Returns false, without decoding anything, if the JPEG doesn't have planes that we know how to read.
+template<typename WriteChroma>
+static auto decode_mjpeg_raw(JpegDecoder& jpeg, Destination const& luma, uint32_t chroma_rows_step, WriteChroma const& write_chroma) -> bool
+{
+    auto const                    subsampling = jpeg.chroma_subsampling(); // Can't be computed once decoding has started. Not given by the sampling factors: when the DCT scales the image, the chroma can be decoded with bigger blocks than the luma
+    jpeg_decompress_struct* const info        = jpeg.start_raw();
+    if (!info)
+        return false;
+
+    auto const  width                 = info->output_width;
+    auto const  height                = info->output_height;
+    auto const& y_component           = info->comp_info[0]; // NOLINT(*pointer-arithmetic)
+    bool const  has_half_width_chroma = subsampling.horizontal == 2;
+    auto const  rows_per_chroma_row   = subsampling.vertical;                                                       // The rows of Y that share a row of the decoded chroma
+    auto const  read_height           = static_cast<uint32_t>(y_component.v_samp_factor) * block_size(y_component); // The rows of Y that jpeg_read_raw_data() decodes at once
+    // When the DCT scales the image, read_height can be odd: we then read two of them in each band, so that the pairs of rows of NV12 and I420 never straddle two bands
+    auto const reads_per_band = read_height % chroma_rows_step == 0 ? 1 : chroma_rows_step;
+    auto const band_height    = read_height * reads_per_band;
+
+    // jpeg_read_raw_data() writes whole blocks, so the rows of each band are padded, and the last band can go below the image
+    auto bands = std::array<std::vector<uint8_t>, 3>{};
+    auto rows  = std::array<std::vector<JSAMPROW>, 3>{};
+    for (size_t c = 0; c < 3; ++c)
+    {
+        auto const& component  = info->comp_info[c]; // NOLINT(*pointer-arithmetic)
+        auto const  row_length = static_cast<size_t>(component.width_in_blocks) * block_size(component);
+        auto const  rows_count = static_cast<size_t>(component.v_samp_factor) * block_size(component) * reads_per_band;
+        bands[c].resize(row_length * rows_count); // NOLINT(*constant-array-index)
+        rows[c].resize(rows_count);               // NOLINT(*constant-array-index)
+        for (size_t i = 0; i < rows_count; ++i)
+            rows[c][i] = bands[c].data() + i * row_length; // NOLINT(*constant-array-index, *pointer-arithmetic)
+    }
+    auto resampled_rows = std::array<std::vector<uint8_t>, 2>{};
+    for (auto& row : resampled_rows)
+        row.resize((width + 1) / 2);
+
+    for (uint32_t band_y = 0; band_y < height; band_y += band_height)
+    {
+        for (uint32_t read = 0; read < reads_per_band && info->output_scanline < height; ++read)
+        {
+            auto planes = std::array<JSAMPARRAY, 3>{};
+            for (size_t c = 0; c < 3; ++c)
+                planes[c] = rows[c].data() + read * rows[c].size() / reads_per_band; // NOLINT(*constant-array-index, *pointer-arithmetic)
+            jpeg.read_raw_rows(planes.data(), read_height);
+        }
+        uint32_t const band_end = std::min(band_y + band_height, height);
+        for (uint32_t y = band_y; y < band_end; ++y)
+            write_plane_row(luma, y, rows[0][y - band_y]);
+        for (uint32_t y = band_y; y < band_end; y += chroma_rows_step) // band_height is a multiple of chroma_rows_step, so the pairs of rows never straddle two bands
+        {
+            auto const           y1 = std::min(y + chroma_rows_step - 1, height - 1);
+            auto const           r0 = (y - band_y) / rows_per_chroma_row;
+            auto const           r1 = (y1 - band_y) / rows_per_chroma_row;
+            uint8_t const* const u  = resample_chroma(rows[1][r0], rows[1][r1], has_half_width_chroma, width, resampled_rows[0].data());
+            uint8_t const* const v  = resample_chroma(rows[2][r0], rows[2][r1], has_half_width_chroma, width, resampled_rows[1].data());
+            write_chroma(y / chroma_rows_step, u, v);
+        }
+    }
+    jpeg.stop();
+    return true;
+}
+
+/// Decodes to NV12 or I420 with decode_mjpeg_raw(). Returns false if it can't.
+static auto decode_mjpeg_raw(JpegDecoder& jpeg, YUV420Destination const& destination) -> bool
+{
+    auto uv_row = std::vector<uint8_t>{};
+    return decode_mjpeg_raw(jpeg, destination.luma(), 2, [&](uint32_t chroma_y, uint8_t const* u, uint8_t const* v) {
+        if (destination.has_interleaved_chroma())
+        {
+            auto const chroma_width = (destination.luma().source_width() + 1) / 2;
+            uv_row.resize(size_t{chroma_width} * 2);
+            row_conversions().merge_chroma(u, v, uv_row.data(), chroma_width);
+            write_plane_row(destination.chroma(0), chroma_y, uv_row.data());
+        }
+        else
+        {
+            write_plane_row(destination.chroma(0), chroma_y, u);
+            write_plane_row(destination.chroma(1), chroma_y, v);
+        }
+    });
+}
+
+/// True iff the region of interest is the whole JPEG, which decode_mjpeg_raw() requires
+static auto is_whole_image(RegionOfInterest const& region, JpegDecoder& jpeg) -> bool
+{
+    return region == RegionOfInterest{0, 0, jpeg.output_resolution()};
+}
+
+/// The pixel formats that libjpeg-turbo can decode to directly
+template<typename PixelFormatT>
+static constexpr J_COLOR_SPACE jpeg_color_space = JCS_UNKNOWN;
+template<>
+constexpr J_COLOR_SPACE jpeg_color_space<RGB24> = JCS_EXT_RGB;
+template<>
+constexpr J_COLOR_SPACE jpeg_color_space<BGR24> = JCS_EXT_BGR;
+template<>
+constexpr J_COLOR_SPACE jpeg_color_space<RGBA32> = JCS_EXT_RGBA;
+template<>
+constexpr J_COLOR_SPACE jpeg_color_space<BGRA32> = JCS_EXT_BGRA;
+template<>
+constexpr J_COLOR_SPACE jpeg_color_space<GREY8> = JCS_GRAYSCALE; // Only decodes the luma component, and skips the color conversion
+
+template<typename PixelFormatT>
+static void decode_mjpeg_and_set_data(Image& image, JpegDecoder& jpeg, RegionOfInterest const& region, Orientation const& orientation, std::optional<Resolution> output_resolution, ResizeFilter filter)
+{
+    auto const resolution = region.size;
+    if (output_resolution && *output_resolution != oriented_resolution(resolution, orientation))
+    {
+        make_resized_image_and_set_data<PixelFormatT>(image, resolution, wcam::FirstRowIs::Top, orientation, *output_resolution, filter, [&](ResizeDestination const& destination) {
+            decode_mjpeg(jpeg, jpeg_color_space<PixelFormatT>, region, destination);
+        });
+        return;
+    }
+    auto       output      = OutputBuffer<PixelFormatT>{image, oriented_resolution(resolution, orientation)};
+    auto const destination = Destination{output.plane(0), PixelFormatT::bytes_per_pixel, resolution, wcam::FirstRowIs::Top, orientation, output.stride(0)};
+    if (!is_whole_image(region, jpeg) || !decode_mjpeg_in_slices(jpeg, jpeg_color_space<PixelFormatT>, destination))
+        decode_mjpeg(jpeg, jpeg_color_space<PixelFormatT>, region, destination);
+    output.set_data(image, destination.row_order());
+}
+
+/// JPEG uses the YCbCr of JFIF, which is BT.601 with the full range
+template<typename PixelFormatT>
+static void decode_mjpeg_to_yuv420_and_set_data(Image& image, JpegDecoder& jpeg, RegionOfInterest const& region, Orientation const& orientation)
+{
+    auto       output      = OutputBuffer<PixelFormatT>{image, oriented_resolution(region.size, orientation)};
+    auto const destination = YUV420Destination{output.data(), output.planes(), region.size, wcam::FirstRowIs::Top, orientation};
+    if (!is_whole_image(region, jpeg) || !decode_mjpeg_raw(jpeg, destination))
+        decode_mjpeg(jpeg, region, destination);
+    output.set_data(image, destination.row_order(), YUVEncoding{YUVMatrix::BT601, YUVRange::Full});
+}
+
+/// Returns false, without decoding anything, if decode_mjpeg_raw() can't be used, or if the chroma planes of I422 can't be rotated by 90° (their samples would cover pairs of pixels of a column)
+static auto decode_mjpeg_to_i422_and_set_data(Image& image, JpegDecoder& jpeg, RegionOfInterest const& region, Orientation const& orientation) -> bool
+{
+    if (rotates_by_90(orientation) || !is_whole_image(region, jpeg) || !jpeg.has_raw_planes())
+        return false;
+
+    auto const resolution        = region.size;
+    auto const chroma_resolution = Resolution{(resolution.width() + 1) / 2, resolution.height()};
+    auto       output            = OutputBuffer<I422>{image, resolution};
+    auto const luma              = Destination{output.plane(0), 1, resolution, wcam::FirstRowIs::Top, orientation, output.stride(0)};
+    auto const u                 = Destination{output.plane(1), 1, chroma_resolution, wcam::FirstRowIs::Top, orientation, output.stride(1)};
+    auto const v                 = Destination{output.plane(2), 1, chroma_resolution, wcam::FirstRowIs::Top, orientation, output.stride(2)};
+    decode_mjpeg_raw(jpeg, luma, 1, [&](uint32_t chroma_y, uint8_t const* u_row, uint8_t const* v_row) {
+        write_plane_row(u, chroma_y, u_row);
+        write_plane_row(v, chroma_y, v_row);
+    });
+    output.set_data(image, luma.row_order(), YUVEncoding{YUVMatrix::BT601, YUVRange::Full});
+    return true;
+}
+
+static void decode_mjpeg_and_set_tensor_data(Image& image, JpegDecoder& jpeg, RegionOfInterest const& region, Orientation const& orientation, TensorFormat const& format)
+{
+    auto const resolution = region.size;
+    if (rotates_by_90(orientation))
+    {
+        // The rows of the tensor would be columns of the JPEG, so we decode it rotated first
+        auto       data        = buffer_pool().get(RGB24::data_length(resolution));
+        auto const destination = Destination{data.get(), RGB24::bytes_per_pixel, resolution, wcam::FirstRowIs::Top, orientation};
+        decode_mjpeg(jpeg, JCS_EXT_RGB, region, destination);
+        set_tensor_data(image, ImageDataView<RGB24>{std::move(data), RGB24::data_length(destination.resolution()), destination.resolution(), destination.row_order()}, Orientation{}, format);
+        return;
+    }
+    make_tensor_and_set_data(image, resolution, wcam::FirstRowIs::Top, orientation, format, [&](TensorDestination const& destination) {
+        decode_mjpeg(jpeg, region, destination);
+    });
+}
+
+/// libjpeg can decode a JPEG scaled down by n/8 almost for free, by dropping DCT coefficients, so we decode it at the smallest of those scales that is still at least as big as the images (or tensors) that we must give, which are then resized if needed.
+/// A region of interest is given in pixels of the full image, so we never scale when there is one.
+static auto dct_scale(Resolution resolution, CaptureSettings const& settings) -> uint32_t
+{
+    if (settings.region_of_interest())
+        return 8;
+    auto const oriented = oriented_resolution(resolution, settings.orientation());
+    auto const target   = wants_tensors() ? settings.tensor_format().resolution : resized_resolution(settings, oriented);
+    return target ? smallest_scale_that_covers(oriented, *target) : 8;
+}
+
+/// libjpeg-turbo decodes to all its color output formats at the same cost, so we decode directly to the one that the Image has chosen to implement, if any.
+/// GREY8 is cheaper than all of them, so it comes first. Then I422, NV12 and I420 skip the color conversion (and even the upsampling of the chroma, for the whole images), but we only produce them at the resolution of the webcam.
+static void decode_mjpeg_and_set_data(Image& image, JpegDecoder& jpeg, CapturedFrame const& frame, Resolution resolution, CaptureSettings const& settings)
+{
+    auto const orientation = settings.orientation();
+    auto const scale       = dct_scale(resolution, settings);
+    jpeg.set_image(frame.data.get(), frame.size, settings.mjpeg_decoding(), scale);
+    auto const region = scale == 8
+                            ? clamp_region(settings.region_of_interest().value_or(RegionOfInterest{0, 0, resolution}), resolution)
+                            : RegionOfInterest{0, 0, scaled_resolution(resolution, scale)}; // There is no region of interest when the JPEG is scaled (see dct_scale())
+    if (wants_tensors())
+    {
+        decode_mjpeg_and_set_tensor_data(image, jpeg, region, orientation, settings.tensor_format());
+        return;
+    }
+
+    auto const  output_resolution = resized_resolution(settings, oriented_resolution(scale == 8 ? region.size : resolution, orientation));
+    auto const  filter            = settings.resize_filter();
+    auto const& formats           = image_factory().implemented_formats();
+    if (formats.contains<GREY8>())
+    {
+        decode_mjpeg_and_set_data<GREY8>(image, jpeg, region, orientation, output_resolution, filter);
+        return;
+    }
+    if (!output_resolution || *output_resolution == oriented_resolution(region.size, orientation))
+    {
+        // NV12 and I420 would average the chroma of the JPEGs that have a row of chroma for each row of pixels (e.g. 4:2:2), so we prefer I422 for them
+        bool const prefers_i422 = formats.contains<I422>() && (jpeg.chroma_subsampling().vertical == 1 || (!formats.contains<NV12>() && !formats.contains<I420>()));
+        if (prefers_i422 && decode_mjpeg_to_i422_and_set_data(image, jpeg, region, orientation))
+            return;
+        if (formats.contains<NV12>())
+        {
+            decode_mjpeg_to_yuv420_and_set_data<NV12>(image, jpeg, region, orientation);
+            return;
+        }
+        if (formats.contains<I420>())
+        {
+            decode_mjpeg_to_yuv420_and_set_data<I420>(image, jpeg, region, orientation);
+            return;
+        }
+    }
+    bool done = false;
+    for_each_pixel_format([&]<typename PixelFormatT>() {
+        if constexpr (jpeg_color_space<PixelFormatT> != JCS_UNKNOWN && !std::is_same_v<PixelFormatT, RGB24>)
+        {
+            if (!done && formats.contains<PixelFormatT>())
+            {
+                decode_mjpeg_and_set_data<PixelFormatT>(image, jpeg, region, orientation, output_resolution, filter);
+                done = true;
+            }
+        }
+    });
+    if (!done)
+        decode_mjpeg_and_set_data<RGB24>(image, jpeg, region, orientation, output_resolution, filter);
+}
+
+void CaptureImpl::dequeue_next_image()
 {
     try
     {
@@ -266,29 +954,67 @@ void CaptureImpl::process_next_image()
         buf.memory = V4L2_MEMORY_MMAP;
 
         THROW_IF_ERR(ioctl(_webcam_handle, VIDIOC_DQBUF, &buf)); // Blocks until a new frame is available
-        auto image = image_factory().make_image();
+        _buffers->on_dequeued();
+        if (_next_sequence && buf.sequence > *_next_sequence) // The drivers that don't number the images always give 0
+            count_dropped_by_driver(buf.sequence - *_next_sequence);
+        _next_sequence = buf.sequence + 1;
+
+        auto const& buffer = _buffers->buffer(buf.index);
+        auto        frame  = CapturedFrame{};
+        // YUYV and GREY8 are given as is to the Images that implement them, which can then keep the buffer without copying it
+        // MJPEG is decoded anyway, so we copy it instead: it is small, and that gives the buffer back to the driver right away
+        if (_pixel_format != V4L2_PIX_FMT_MJPEG)
+            frame = CapturedFrame{_buffers->lease(buf.index), buffer.size};
+        if (!frame.data)
+        {
+            frame.size = _pixel_format == V4L2_PIX_FMT_MJPEG && buf.bytesused != 0 ? buf.bytesused : buffer.size;
+            auto copy  = buffer_pool().get(buffer.size); // The size of the driver's buffers never changes, unlike the one of the JPEGs, so the copies always reuse the same size class of the pool
+            std::memcpy(copy.get(), buffer.ptr, frame.size);
+            frame.data = std::move(copy);
+            THROW_IF(!_buffers->give_back(buf.index));
+        }
+        if (_frames.push(std::move(frame)))
+            count_dropped_before_decoding();
+    }
+    catch (CaptureException const& e)
+    {
+        set_image(e.capture_error);
+    }
+}
 
+void CaptureImpl::process_image(CapturedFrame const& frame)
+{
+    try
+    {
+        auto image = make_image();
         if (_pixel_format == V4L2_PIX_FMT_YUYV)
         {
-            image->set_data(ImageDataView<YUYV>{static_cast<unsigned char*>(_buffers[buf.index].ptr), _buffers[buf.index].size, _resolution, wcam::FirstRowIs::Top}); // NOLINT(*constant-array-index)
+            auto const planes = _bytes_per_line != 0 ? YUYV::Planes{Plane{0, _bytes_per_line}} : YUYV::packed_planes(_resolution);
+            internal::set_data(*image, ImageDataView<YUYV>{frame.data, frame.size, _resolution, wcam::FirstRowIs::Top, planes, _yuv_encoding}, settings());
+        }
+        else if (_pixel_format == V4L2_PIX_FMT_GREY)
+        {
+            auto const planes = _bytes_per_line != 0 ? GREY8::Planes{Plane{0, _bytes_per_line}} : GREY8::packed_planes(_resolution);
+            internal::set_data(*image, ImageDataView<GREY8>{frame.data, frame.size, _resolution, wcam::FirstRowIs::Top, planes}, settings());
         }
         else if (_pixel_format == V4L2_PIX_FMT_MJPEG)
         {
-            auto rgb_data = std::shared_ptr<uint8_t>{new uint8_t[_resolution.pixels_count() * 3], std::default_delete<uint8_t[]>()}; // NOLINT(*c-arrays)
-            mjpeg_to_rgb(_buffers[buf.index], rgb_data.get());                                                                       // NOLINT(*constant-array-index)
-            image->set_data(ImageDataView<RGB24>{std::move(rgb_data), _resolution.pixels_count() * 3, _resolution, wcam::FirstRowIs::Top});
+            decode_mjpeg_and_set_data(*image, *_jpeg_decoder, frame, _resolution, settings());
         }
         else
         {
             assert(false && "Unsupported pixel format");
         };
         set_image(std::move(image));
-        THROW_IF_ERR(ioctl(_webcam_handle, VIDIOC_QBUF, &buf));
     }
     catch (CaptureException const& e)
     {
         set_image(e.capture_error);
     }
+    catch (JpegError const&)
+    {
+        // A corrupt image (e.g. a USB transfer that was cut short): we skip it, and the decoder is ready for the next ones
+    }
 }
 
 } // namespace wcam::internal
@@ -1,10 +1,15 @@
 #pragma once
 #if defined(__linux__)
-#include <array>
 #include <atomic>
+#include <memory>
+#include <mutex>
+#include <optional>
 #include <thread>
+#include <vector>
 #include "../DeviceId.hpp"
 #include "ICaptureImpl.hpp"
+#include "JpegDecoder.hpp"
+#include "LatestFramesQueue.hpp"
 
 namespace wcam::internal {
 
@@ -20,6 +25,42 @@ struct Buffer {
     Buffer& operator=(Buffer&&) noexcept = delete;
 };
 
+/// The buffers that the driver fills with the images, mapped in our memory.
+/// Instead of being copied, an image can lease the buffer it is in (see lease()): that buffer is only given back to the driver once the image has been released.
+/// The leases share the ownership of the buffers, so that they stay mapped even if the capture stops before the leases are released.
+class DriverBuffers : public std::enable_shared_from_this<DriverBuffers> {
+public:
+    /// Maps and queues (at least) `count` buffers. The webcam must outlive the DriverBuffers, or stop() must be called before closing it.
+    DriverBuffers(int webcam_handle, uint32_t count);
+
+    /// Only valid on the thread that dequeues the buffers, because new buffers can be added by lease()
+    [[nodiscard]] auto buffer(uint32_t index) const -> Buffer const& { return *_buffers[index]; } // NOLINT(*constant-array-index)
+
+    /// Must be called after each VIDIOC_DQBUF
+    void on_dequeued();
+    /// Returns the data of that dequeued buffer, which gives the buffer back to the driver when its last copy is released.
+    /// If the leases held by the images would leave too few buffers to the driver, a new buffer is added. If we can't add one, returns nullptr: the buffer must then be given back as soon as the image has been set (with give_back()).
+    auto lease(uint32_t index) -> std::shared_ptr<uint8_t const>;
+    /// Queues the buffer again, so that the driver can write a new image in it. Returns false if that failed.
+    auto give_back(uint32_t index) -> bool;
+    /// Stops giving the buffers back to the driver, e.g. when leases are released after the capture has stopped
+    void stop();
+
+private:
+    /// Requires _mutex to be locked (or the constructor to be running)
+    void map_and_queue(uint32_t index);
+    /// Requires _mutex to be locked. Returns false if the driver can't create buffers while streaming, or if we already have too many.
+    auto add_buffer() -> bool;
+
+private:
+    int                                  _webcam_handle;
+    std::vector<std::unique_ptr<Buffer>> _buffers{};
+    std::mutex                           _mutex{};
+    uint32_t                             _queued_count{}; // The buffers that the driver can write to
+    bool                                 _is_streaming{true};
+    bool                                 _can_add_buffers{true};
+};
+
 class FileRAII {
 public:
     FileRAII(FileRAII const&)                = delete;
@@ -42,9 +83,18 @@ private:
     int _file_handle{};
 };
 
+/// An image that has been taken from the driver, and is waiting to be decoded / converted
+struct CapturedFrame {
+    std::shared_ptr<uint8_t const> data{}; // Either leased from the driver (see DriverBuffers::lease()), or a copy
+    size_t                         size{};
+};
+
+/// The images are captured in two stages, each on its own thread, so that a slow decoding never holds a buffer of the driver (which would then have to drop images):
+/// - the dequeue thread takes each image from the driver, leases or copies it, and hands it to the decode thread right away;
+/// - the decode thread decodes / converts it, and gives it to an Image.
 class CaptureImpl : public ICaptureImpl {
 public:
-    CaptureImpl(DeviceId const& id, Resolution const& resolution);
+    CaptureImpl(DeviceId const& id, Resolution const& resolution, std::shared_ptr<CaptureSettings const> settings);
     ~CaptureImpl() override;
     CaptureImpl(CaptureImpl const&)                        = delete;
     auto operator=(CaptureImpl const&) -> CaptureImpl&     = delete;
@@ -52,17 +102,25 @@ public:
     auto operator=(CaptureImpl&&) noexcept -> CaptureImpl& = delete;
 
 private:
-    static void thread_job(CaptureImpl&);
-    void        process_next_image();
+    static void dequeue_thread_job(CaptureImpl&);
+    static void decode_thread_job(CaptureImpl&);
+    void        dequeue_next_image();
+    void        process_image(CapturedFrame const&);
 
 private:
-    FileRAII              _webcam_handle;
-    std::array<Buffer, 6> _buffers; // 6 is nice number that gives us good performance
-    uint32_t              _pixel_format;
-    Resolution            _resolution;
+    FileRAII                       _webcam_handle;
+    std::shared_ptr<DriverBuffers> _buffers{};
+    uint32_t                       _pixel_format;
+    Resolution                     _resolution;
+    size_t                         _bytes_per_line{}; // Can be bigger than the size of a row, if the driver pads the rows
+    YUVEncoding                    _yuv_encoding{};
+    std::unique_ptr<JpegDecoder>   _jpeg_decoder{};  // Only for MJPEG
+    std::optional<uint32_t>        _next_sequence{}; // The number that the driver should give to the next image, if it numbers them
 
-    std::atomic<bool> _wants_to_stop_thread{false};
-    std::thread       _thread{};
+    LatestFramesQueue<CapturedFrame, 2> _frames{}; // One frame of slack, so that a single slow decoding doesn't drop an image
+    std::atomic<bool>                   _wants_to_stop_threads{false};
+    std::thread                         _dequeue_thread{};
+    std::thread                         _decode_thread{};
 };
 
 } // namespace wcam::internal
@@ -5,7 +5,8 @@ namespace wcam::internal {
 
 void open_webcam();
 
-CaptureImpl::CaptureImpl(DeviceId const& id, Resolution const& resolution)
+CaptureImpl::CaptureImpl(DeviceId const& id, Resolution const& resolution, std::shared_ptr<CaptureSettings const> settings)
+    : ICaptureImpl{std::move(settings)}
 {
     open_webcam();
 }
@@ -7,7 +7,7 @@ namespace wcam::internal {
 
 class CaptureImpl : public ICaptureImpl {
 public:
-    CaptureImpl(DeviceId const& id, Resolution const& resolution);
+    CaptureImpl(DeviceId const& id, Resolution const& resolution, std::shared_ptr<CaptureSettings const> settings);
     ~CaptureImpl() override;
     CaptureImpl(CaptureImpl const&)                        = delete;
     auto operator=(CaptureImpl const&) -> CaptureImpl&     = delete;
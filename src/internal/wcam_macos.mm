@@ -1,5 +1,7 @@
 #include <AVFoundation/AVFoundation.h>
 #include <CoreMedia/CMFormatDescription.h>
+#include <algorithm>
+#include <optional>
 #include <string>
 #include <vector>
 #include <iostream>
@@ -44,6 +46,14 @@ auto grab_all_infos_impl() -> std::vector<Info> {
     return list_webcams_infos;
 }
 
+auto grab_info_impl(DeviceId const& id) -> std::optional<Info> {
+    auto infos = grab_all_infos_impl();
+    auto it = std::find_if(infos.begin(), infos.end(), [&](Info const& info) { return info.id == id; });
+    if (it == infos.end())
+        return std::nullopt;
+    return std::move(*it);
+}
+
 }
 
 @interface FrameCaptureDelegate : NSObject<AVCaptureVideoDataOutputSampleBufferDelegate>
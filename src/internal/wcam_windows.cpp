@@ -1,7 +1,9 @@
 #if defined(_WIN32)
 #include "wcam_windows.hpp"
 #include <fmt/format.h>
+#include <algorithm>
 #include <cstdlib>
+#include <optional>
 #include <source_location>
 #include <string>
 #include <string_view>
@@ -9,6 +11,7 @@
 #include "../Info.hpp"
 #include "Cool/get_system_error_hresult.hpp"
 #include "ImageFactory.hpp"
+#include "conversions.hpp"
 #include "fallback_webcam_name.hpp"
 #include "make_device_id.hpp"
 
@@ -323,8 +326,9 @@ static auto get_actual_resolution(ISampleGrabber* sample_grabber, GUID video_for
     return resolution;
 }
 
-CaptureImpl::CaptureImpl(DeviceId const& device_id, Resolution const& requested_resolution)
-    : _video_format{select_video_format(device_id)}
+CaptureImpl::CaptureImpl(DeviceId const& device_id, Resolution const& requested_resolution, std::shared_ptr<CaptureSettings const> settings)
+    : ICaptureImpl{std::move(settings)}
+    , _video_format{select_video_format(device_id)}
 {
     CoInitializeIFN();
 
@@ -364,16 +368,18 @@ CaptureImpl::CaptureImpl(DeviceId const& device_id, Resolution const& requested_
     _resolution = get_actual_resolution(sample_grabber, _video_format);
 }
 
+// The Sample Grabber gives us its own copy of the sample, so we are allowed to modify it in place
 STDMETHODIMP CaptureImpl::BufferCB(double /* time */, BYTE* buffer, long buffer_length) // NOLINT(*runtime-int)
 {
-    auto image = image_factory().make_image();
+    auto image = make_image();
     if (_video_format == MEDIASUBTYPE_RGB24)
     {
-        image->set_data(ImageDataView<BGR24>{buffer, static_cast<size_t>(buffer_length), _resolution, wcam::FirstRowIs::Bottom});
+        auto const stride = (_resolution.width() * size_t{3} + 3) & ~size_t{3}; // The rows of RGB bitmaps are padded to a multiple of 4 bytes
+        internal::set_data(*image, ImageDataView<BGR24>{WritableBuffer{buffer}, static_cast<size_t>(buffer_length), _resolution, wcam::FirstRowIs::Bottom, {Plane{0, stride}}}, settings());
     }
     else if (_video_format == MEDIASUBTYPE_NV12)
     {
-        image->set_data(ImageDataView<NV12>{buffer, static_cast<size_t>(buffer_length), _resolution, wcam::FirstRowIs::Top});
+        internal::set_data(*image, ImageDataView<NV12>{buffer, static_cast<size_t>(buffer_length), _resolution, wcam::FirstRowIs::Top}, settings());
     }
     else
     {
@@ -470,6 +476,17 @@ auto grab_all_infos_impl() -> std::vector<Info>
     return infos;
 }
 
+auto grab_info_impl(DeviceId const& id) -> std::optional<Info>
+{
+    auto infos = grab_all_infos_impl(); // DirectShow doesn't let us query a single device, but grab_all_infos_impl() is cheap thanks to its cache
+    auto it    = std::find_if(infos.begin(), infos.end(), [&](Info const& info) {
+        return info.id == id;
+    });
+    if (it == infos.end())
+        return std::nullopt;
+    return std::move(*it);
+}
+
 } // namespace wcam::internal
 
 #if defined(GCC) || defined(__clang__)
@@ -33,7 +33,7 @@ EXTERN_C const IID IID_ISampleGrabberCB;
 class CaptureImpl : public ISampleGrabberCB
     , public ICaptureImpl {
 public:
-    CaptureImpl(DeviceId const& id, Resolution const& resolution);
+    CaptureImpl(DeviceId const& id, Resolution const& resolution, std::shared_ptr<CaptureSettings const> settings);
     ~CaptureImpl() override                                = default;
     CaptureImpl(CaptureImpl const&)                        = delete;
     auto operator=(CaptureImpl const&) -> CaptureImpl&     = delete;
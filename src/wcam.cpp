@@ -1,4 +1,6 @@
 #include "wcam/wcam.hpp"
+#include "internal/CapabilitiesCache.hpp"
+#include "internal/ConversionPool.hpp"
 #include "internal/Manager.hpp"
 
 namespace wcam {
@@ -33,6 +35,16 @@ auto get_resolutions_map() -> ResolutionsMap&
     return internal::manager().get_resolutions_map();
 }
 
+void set_capabilities_cache_file(std::filesystem::path const& file_path)
+{
+    internal::capabilities_cache().set_file(file_path);
+}
+
+void set_conversion_threads_count(size_t threads_count)
+{
+    internal::conversion_pool().set_threads_count(threads_count);
+}
+
 void update()
 {
     internal::manager().check_if_update_needs_to_continue();
@@ -9,6 +9,25 @@ struct Texture {
     wcam::Resolution resolution{};
 };
 
+/// Tells OpenGL how the rows of the 3-bytes-per-pixel image we are about to upload are padded
+static void set_unpack_stride(wcam::Resolution resolution, size_t stride)
+{
+    size_t const row_length = resolution.width() * size_t{3};
+    for (GLint alignment : {8, 4, 2, 1})
+    {
+        auto const aligned_row_length = (row_length + static_cast<size_t>(alignment) - 1) / static_cast<size_t>(alignment) * static_cast<size_t>(alignment);
+        if (aligned_row_length == stride)
+        {
+            glPixelStorei(GL_UNPACK_ALIGNMENT, alignment);
+            glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+            return;
+        }
+    }
+    assert(stride % 3 == 0);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, static_cast<GLint>(stride / 3));
+}
+
 class TexturePool { // NOLINT(*special-member-functions)
 public:
     ~TexturePool()
@@ -87,7 +106,8 @@ public:
             assert(_texture.id == 0);
             _texture = texture_pool().take(owned_rgb_data.resolution());
             glBindTexture(GL_TEXTURE_2D, _texture.id);
-            glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, static_cast<GLsizei>(owned_rgb_data.resolution().width()), static_cast<GLsizei>(owned_rgb_data.resolution().height()), 0, GL_RGB, GL_UNSIGNED_BYTE, owned_rgb_data.data());
+            set_unpack_stride(owned_rgb_data.resolution(), owned_rgb_data.stride(0));
+            glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, static_cast<GLsizei>(owned_rgb_data.resolution().width()), static_cast<GLsizei>(owned_rgb_data.resolution().height()), 0, GL_RGB, GL_UNSIGNED_BYTE, owned_rgb_data.plane(0));
         };
     }
 
@@ -99,7 +119,8 @@ public:
             assert(_texture.id == 0);
             _texture = texture_pool().take(owned_bgr_data.resolution());
             glBindTexture(GL_TEXTURE_2D, _texture.id);
-            glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, static_cast<GLsizei>(owned_bgr_data.resolution().width()), static_cast<GLsizei>(owned_bgr_data.resolution().height()), 0, GL_BGR, GL_UNSIGNED_BYTE, owned_bgr_data.data());
+            set_unpack_stride(owned_bgr_data.resolution(), owned_bgr_data.stride(0));
+            glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, static_cast<GLsizei>(owned_bgr_data.resolution().width()), static_cast<GLsizei>(owned_bgr_data.resolution().height()), 0, GL_BGR, GL_UNSIGNED_BYTE, owned_bgr_data.plane(0));
         };
     }
 